@@ -183,6 +183,13 @@ of the user data directory. Defaults to "Litha Engine".
     logFile - log file destination, considered relative to the exe directory.
                 If not set, will default to the appName + ".log"
 
+    logLevel - least important level logged, "note", "warn" or "fail".
+                Defaults to "note".
+
+    binaryLogFile - if set, log records are written to this file in binary
+                instead of as text, considered relative to the log file's
+                directory. Defaults to "", text logging.
+
     screenWidth - screen width. If not set, defaults to 800.
 
     screenHeight - screen height. If not set, defaults to 600.
@@ -24,8 +24,9 @@ public:
     virtual u16 GetPassCount() { return 1; }
 
     // Prepare for rendering a particular pass.
-    // This will be called even for passes this graphic doesn't have, in order
-    // for any Irrlicht scene nodes that shouldn't be rendered to be hidden.
+    // This will also be called for the first pass after this graphic's last,
+    // in order for any Irrlicht scene nodes that shouldn't be rendered to be
+    // hidden. (they should stay hidden until pass 0 comes round again)
     virtual void SetCurrentPass(u16 pass) {}
 
     // Render the graphic. Render is called GetPassCount() number of times per
@@ -58,6 +58,17 @@ public:
     // This is not yet taken into account for physics geometry either.
     virtual void Translate(const core::vector3df &translation) = 0;
 
+    // Draw together with all other instanced meshes using the same mesh file
+    // and materials, in one draw call per mesh buffer. For many copies of
+    // small static meshes such as blocks.
+    // Meshes with more than one pass, with Irrlicht child nodes, with non
+    // standard vertices or with transparent materials (which must be depth
+    // sorted) are still drawn separately. Animations are not shown.
+    // Vertices are copied when an instance moves, or when the mesh file's
+    // vertices change. Mark the Irrlicht mesh dirty (setDirty) after changing
+    // them, e.g. its vertex colours, or instances will keep the old ones.
+    virtual void SetInstanced(bool instanced) = 0;
+
     // THIS FUNCTION SHOULD BE REMOVED IN THE FUTURE!!?
     // This class wraps an Irrlicht Animated Mesh scene node.
     // Don't try to modify the node or strange things may happen!
@@ -38,6 +38,10 @@ public:
     // after creation, before the next logic update.
     virtual void EnableInitialEvents(bool initialEvents) = 0;
 
+    // Forget any motion so far and start detecting again, as if newly added.
+    // e.g. after being teleported, which would otherwise look like motion.
+    virtual void Reset() = 0;
+
     // Sets a time in seconds that must pass before a change in motion is
     // detected. Default is a 10th of a second (0.1). Hmm, this needs thinking
     // out. Perhaps there are better parameters.
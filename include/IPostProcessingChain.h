@@ -19,14 +19,14 @@ public:
     // on to the screen. Effect materials and shaders should be set accordingly,
     // for example you may want the last effect to render additively on to the
     // screen. TextureLayer[0] of an effect's material will be set to the input
-    // texture.
+    // texture. Effects with the same input size share textures where they can.
     virtual void AddEffect(video::SMaterial material, IShader *shader,
                            core::dimension2du size) = 0;
 
     // Same as above but size is given as a fraction of the screen dimensions.
     // last parameter is a divisor. e.g. 1 for full screen dimensions, 2 for
     // half size... If exact screen dimensions are not available will fallback
-    // as above
+    // as above. The input texture is recreated when the screen is resized.
     virtual void AddEffect(video::SMaterial material, IShader *shader,
                            u32 screenFraction = 1) = 0;
 
@@ -37,6 +37,28 @@ public:
         const c8 *vertexShaderFileName, const c8 *pixelShaderFileName,
         video::E_MATERIAL_TYPE baseMaterial = video::EMT_SOLID) = 0;
 
+    // Like CreateShader, but returns the same shader to everything asking for
+    // the same files and base material. Created the first time it is asked
+    // for. The returned shader is NOT grabbed, so do not drop it.
+    // Constants and the callback are shared too, so anything that differs per
+    // object should come from auto constants. (see IShader)
+    // If given, created is set to whether this call created the shader, so
+    // that its constants can be set up just the once.
+    // May return NULL if shaders are not available.
+    virtual IShader *GetSharedShader(
+        const c8 *vertexShaderFileName, const c8 *pixelShaderFileName,
+        video::E_MATERIAL_TYPE baseMaterial = video::EMT_SOLID,
+        bool *created = nullptr) = 0;
+
+    // Compile every shader listed in a manifest file now, rather than when it
+    // is first created. The files are read in parallel.
+    // Each line of the manifest is a vertex and pixel shader file name
+    // (relative to the manifest) and optionally an Irrlicht material type name
+    // for the base material. e.g. "Sky.vert Sky.frag trans_add"
+    // Lines starting with # are ignored.
+    // Returns the number of shaders preloaded.
+    virtual u32 PreloadShaders(const io::path &manifestFile) = 0;
+
     virtual bool ShadersAreAvailable() = 0;
     virtual bool PostProcessingEnabled() = 0;
 
@@ -76,9 +98,28 @@ public:
     // Set the background colour...
     virtual void SetBackgroundCol(const video::SColor &col) = 0;
 
+    // Render the 3D scene at a fraction of the screen resolution, chosen each
+    // frame to keep frames within targetFrameMs, and stretch it back up to the
+    // screen. The GUI is always drawn at full resolution.
+    // The scale is between minScale and maxScale (fractions of the screen
+    // width and height).
+    virtual void SetDynamicResolution(bool enabled,
+                                      f32 targetFrameMs = 1000.f / 60.f,
+                                      f32 minScale = 0.5f,
+                                      f32 maxScale = 1.f) = 0;
+
+    // The scale the scene was last rendered at. 1.0 if dynamic resolution is
+    // disabled.
+    virtual f32 GetResolutionScale() = 0;
+
     // Render everything, but don't show the user...
     // Useful for hackish purposes.
     virtual void RenderInvisible() = 0;
+
+    // Draw the profiler's timings for the last frame over the top of
+    // everything. Does nothing if the profiler is compiled out.
+    // (see utils/profile.h)
+    virtual void ShowProfilerOverlay(bool show) = 0;
 };
 
 #endif
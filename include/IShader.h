@@ -105,9 +105,22 @@ public:
 };
 */
 
-// Perhaps ought to have a predefined selection of constants that can be
-// "watched". e.g. world matrix etc So a callback is not needed for common
-// things. IShader->EnableAutoVertexConstant(EAVC_WORLD_MATRIX);
+// Constants the engine can set itself, so a callback is not needed for common
+// things. e.g. IShader->SetAutoVertexConstant("world", EASC_WORLD_MATRIX);
+enum E_AUTO_SHADER_CONSTANT
+{
+    // Per draw, read from the driver as each material is set.
+    EASC_WORLD_MATRIX = 0,
+    EASC_WORLD_MATRIX_TRANSPOSED,
+
+    // Per frame, shared by all shaders. (see ShaderManager::BeginFrame)
+    EASC_VIEW_MATRIX,
+    EASC_PROJECTION_MATRIX,
+    EASC_TIME_SECONDS, // render updater's virtual time
+
+    EASC_COUNT
+};
+
 class IShader : public virtual IReferenceCounted
 {
 public:
@@ -160,6 +173,15 @@ public:
         SetPixelConstants(name, mat.pointer(), 16);
     }
 
+    // Have a constant set automatically before each render.
+    // Cheaper than setting it from a callback, and means a single shader can
+    // be shared between many objects when the world matrix is all that
+    // differs between them.
+    virtual void SetAutoVertexConstant(const c8 *name,
+                                       E_AUTO_SHADER_CONSTANT type) = 0;
+    virtual void SetAutoPixelConstant(const c8 *name,
+                                      E_AUTO_SHADER_CONSTANT type) = 0;
+
     // Use this callback if you want to update any constants before each render.
     virtual void SetCallback(IShaderCallback *callback) = 0;
 
@@ -40,6 +40,12 @@ public:
     // Set the volume! 0 is silent, 1 is full.
     // Default is 1.0, full volume.
     virtual void SetVolume(f32 volume) = 0;
+
+    // Only so many sounds can be heard at once. When there are more, those
+    // with a higher priority are heard first, then the loudest. The others
+    // carry on playing silently, in case they can be heard again later.
+    // Default is 0.
+    virtual void SetPriority(s32 priority) = 0;
 };
 
 #endif
@@ -39,6 +39,9 @@ public:
     // expect.
     virtual void BreakLoop() = 0;
 
+    // Stop and remove every sound in the queue.
+    virtual void Clear() = 0;
+
     // A list of all sounds currently being played by sound queue.
     // This is used by SoundSource to set the position/velocity of 3D sounds.
     virtual const std::vector<ISound *> &GetAllSounds() = 0;
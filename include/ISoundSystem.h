@@ -25,6 +25,23 @@ public:
     // shouldn't be any delay.
     virtual void PreloadSound(const core::stringc &soundFile) = 0;
 
+    // Decode every sound listed in a manifest on worker threads. Returns
+    // straight away, with the number of sounds queued.
+    // Sounds played before they have loaded start once they have.
+    // Each line of the manifest is a sound file name relative to the
+    // manifest. Lines starting with # are ignored.
+    // If litha-soundpack has packed the manifest into an archive beside it
+    // (sounds.manifest -> sounds.pak), sounds in that are loaded from it
+    // straight away instead.
+    virtual u32 PreloadSoundBank(const io::path &manifestFile) = 0;
+
+    // Fraction of the sounds queued by PreloadSoundBank that have loaded.
+    // 1.0 once they all have.
+    virtual f32 GetPreloadProgress() = 0;
+
+    // Bytes of decoded sound held in memory.
+    virtual u32 GetSoundMemoryUsage() = 0;
+
     // Used internally to set the listener position.
     virtual void SetListenerPosition(core::vector3df pos) = 0;
 
@@ -24,6 +24,9 @@ class ITransformable : public virtual IReferenceCounted
 
     bool firstVelocityCalculation;
 
+    // Transform may have changed since it was last sent to the renderer.
+    bool moving;
+
 protected:
     core::vector3df relativePos;
     core::vector3df relativeRot;
@@ -34,6 +37,7 @@ public:
         world = nullptr;
         parent = nullptr;
         firstVelocityCalculation = true;
+        moving = true;
     }
 
     virtual ~ITransformable()
@@ -51,6 +55,13 @@ public:
 
         linearVel = core::vector3df(0, 0, 0);
 
+        // Could be outside of a world update (e.g. while loading a level),
+        // so make sure it gets rendered at its new location.
+        moving = true;
+
+        if (world)
+            world->OnTransformApplied(this);
+
         // Also immediately position all children.
         for (auto &elem : children)
             elem->ApplyTransformNow();
@@ -114,6 +125,8 @@ public:
 
     ITransformable *GetParent() { return parent; }
 
+    const std::vector<ITransformable *> &GetChildren() { return children; }
+
     // Get all children which are a specific class.
     template <class Type>
     std::vector<Type *> GetChildrenByType()
@@ -263,6 +276,29 @@ public:
 
     core::vector3df GetCachedRotation() { return cachedRot; }
 
+    // Has anything interpolated changed since CacheInterpolatableState?
+    // Override along with CacheInterpolatableState if extra state is cached.
+    virtual bool HasMoved()
+    {
+        return GetPosition() != cachedPos || GetRotation() != cachedRot;
+    }
+
+    // Used internally to skip interpolating graphics that aren't moving.
+    // Moving if this or any parent may have moved since the renderer was last
+    // sent their transforms.
+    void SetMoving(bool moving) { this->moving = moving; }
+
+    bool IsMoving()
+    {
+        for (ITransformable *t = this; t; t = t->parent)
+        {
+            if (t->moving)
+                return true;
+        }
+
+        return false;
+    }
+
     // Called internally, do not use.
     void CalculateVelocities(f32 dt)
     {
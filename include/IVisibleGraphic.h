@@ -16,6 +16,8 @@ public:
     virtual u32 GetMaterialCount() = 0;
 
     // Get the material of a specific rendering pass.
+    // Changes are picked up at the next render, so modify it straight away
+    // rather than keeping the reference around.
     // NOTE: If you are using Shaders, you should not modify the
     // MaterialTypeParam2 of a material. (it is used internally as an id for a
     // Shader object)
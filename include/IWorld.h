@@ -70,9 +70,26 @@ public:
     // with only ever one instance.
     virtual void RemoveAllTransformables() = 0;
 
+    // For holding on to things to reuse later. A kept transformable, and its
+    // children, are set aside: not updated, animated or rendered, and left
+    // alone by RemoveAllTransformables. Must be a root, not a child.
+    // Removing one with RemoveTransformable still removes it.
+    virtual void SetKept(ITransformable *transformable, bool kept) = 0;
+
+    // Called internally by ITransformable::ApplyTransformNow, as a
+    // transformable may be moved while the world is not updating.
+    virtual void OnTransformApplied(ITransformable *transformable) = 0;
+
     // Note: IMesh is not an Irrlicht irr::scene::IMesh
     virtual IMesh *AddMesh(const c8 *meshName) = 0;
 
+    // Animated meshes further than reducedRateDistance from the camera only
+    // have their joints updated every reducedRateInterval frames. The default
+    // interval of 1 updates them every frame.
+    // (meshes out of view are not updated at all, whatever the distance)
+    virtual void SetAnimationDetail(f32 reducedRateDistance,
+                                    u32 reducedRateInterval) = 0;
+
     // Provides smooth interpolated motion for an Irrlicht scene node.
     // (so position etc can be changed at fixed FPS of logic task)
     // removeOnDestruct - if true, will remove the Irrlicht scene node when it
@@ -11,6 +11,7 @@ using namespace irr;
 // Utility function libaries
 #include "utils/maths.h"
 #include "utils/log.h"
+#include "utils/profile.h"
 #include "utils/str.h"
 #include "utils/file.h"
 #include "utils/os.h"
@@ -19,6 +20,8 @@ using namespace irr;
 
 // Utility classes
 #include "utils/Set.h"
+#include "utils/IndexedSet.h"
+#include "utils/RingBuffer.h"
 #include "utils/VariantMap.h"
 #include "utils/Variant.h"
 
@@ -0,0 +1,223 @@
+#ifndef UTILS_INDEXED_SET_H
+#define UTILS_INDEXED_SET_H
+
+#include "litha_internal.h"
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+namespace utils
+{
+// A Set that also keeps an open addressing hash table mapping each element to
+// its index in the dense element array.
+// Contains, Insert and SwapRemove are O(1), iteration is still over a plain
+// contiguous vector. Remove keeps the element order so it still has to shift
+// (and re-index) the tail, prefer SwapRemove where order does not matter.
+// Designed for storing pointers and basic types.
+template <class Type>
+class IndexedSet
+{
+    std::vector<Type> elements;
+
+    // Hash table of (element index + 1), zero meaning an empty slot.
+    // Size is always a power of two and kept at most half full.
+    std::vector<u32> slots;
+    u32 slotBits;
+
+    inline u32 HomeSlot(const Type& element) const
+    {
+        // Fibonacci hashing, spreads pointers which otherwise share their low
+        // bits due to alignment.
+        unsigned long long hash = std::hash<Type>()(element);
+        return (u32)((hash * 11400714819323198485ull) >> (64 - slotBits));
+    }
+
+    // Returns the slot containing the element, or the empty slot where it
+    // would be inserted.
+    inline u32 FindSlot(const Type& element) const
+    {
+        u32 mask = slots.size() - 1;
+        u32 i = HomeSlot(element);
+
+        while (slots[i] && !(elements[slots[i] - 1] == element))
+            i = (i + 1) & mask;
+
+        return i;
+    }
+
+    // Empties a slot, shifting back any following entries of the probe
+    // sequence so no tombstones are needed.
+    inline void EraseSlot(u32 i)
+    {
+        u32 mask = slots.size() - 1;
+        u32 j = i;
+
+        while (true)
+        {
+            j = (j + 1) & mask;
+
+            if (!slots[j])
+                break;
+
+            u32 home = HomeSlot(elements[slots[j] - 1]);
+
+            // Entry can stay where it is if its home is cyclically in (i,j]
+            if (i <= j ? (i < home && home <= j) : (i < home || home <= j))
+                continue;
+
+            slots[i] = slots[j];
+            i = j;
+        }
+
+        slots[i] = 0;
+    }
+
+    inline void Rehash(u32 bits)
+    {
+        slotBits = bits;
+        slots.assign((size_t)1 << bits, 0);
+
+        for (u32 i = 0; i < elements.size(); i++)
+            slots[FindSlot(elements[i])] = i + 1;
+    }
+
+public:
+    IndexedSet() { Rehash(4); }
+
+    // returns true if the set did not already contain the element
+    inline bool Insert(Type element)
+    {
+        u32 slot = FindSlot(element);
+
+        if (slots[slot])
+            return false;
+
+        elements.push_back(element);
+
+        if (elements.size() * 2 > slots.size())
+            Rehash(slotBits + 1);
+        else
+            slots[slot] = elements.size();
+
+        return true;
+    }
+
+    // returns true if the set did contain the element
+    // Preserves the order of the remaining elements.
+    inline bool Remove(const Type& element)
+    {
+        u32 slot = FindSlot(element);
+
+        if (!slots[slot])
+            return false;
+
+        u32 index = slots[slot] - 1;
+        EraseSlot(slot);
+        elements.erase(elements.begin() + index);
+
+        // Everything after the removed element moved down one.
+        for (auto &elem : slots)
+        {
+            if (elem > index + 1)
+                elem--;
+        }
+
+        return true;
+    }
+
+    // Removes the element by swapping it with the last one
+    // and popping the back to avoid unnecessary moving of elements.
+    inline bool SwapRemove(const Type& element)
+    {
+        u32 slot = FindSlot(element);
+
+        if (!slots[slot])
+            return false;
+
+        u32 index = slots[slot] - 1;
+        u32 last = elements.size() - 1;
+        EraseSlot(slot);
+
+        if (index != last)
+        {
+            elements[index] = elements[last];
+            slots[FindSlot(elements[index])] = index + 1;
+        }
+
+        elements.pop_back();
+        return true;
+    }
+
+    inline bool Contains(const Type& element) const
+    {
+        return slots[FindSlot(element)] != 0;
+    }
+
+    // adds all elements from another set to this set, ensuring no duplicates.
+    // Returns true if this set changes as a result. (i.e. a new element
+    // has been added that wasn't already present)
+    template <class OtherSet>
+    inline bool Union(const OtherSet& other)
+    {
+        bool changed = false;
+
+        for (u32 i = 0; i < other.size(); i++)
+        {
+            if (Insert(other[i]))
+                changed = true;
+        }
+
+        return changed;
+    }
+
+    // Probably slow. Copies entire vector.
+    inline std::vector<Type> ToVector() const { return elements; }
+
+    inline u32 size() const { return elements.size(); }
+
+    // Keeps the memory and table size, so a set that is refilled each time
+    // (e.g. a scratch set) doesn't grow its table again.
+    inline void clear()
+    {
+        elements.clear();
+        std::fill(slots.begin(), slots.end(), 0);
+    }
+
+    inline const Type& operator[](u32 index) const
+    {
+        ASSERT(index < elements.size());
+        return elements[index];
+    }
+
+    // Useful when elements are removed one by one by some external code.
+    // Should ensure at least one element exists with size() before calling
+    // this.
+    // Returns the back so that a following SwapRemove need not move anything.
+    inline const Type& GetAnyForRemoval() const
+    {
+        ASSERT(elements.size());
+        return elements.back();
+    }
+
+    // For range-based for loops
+    inline auto begin() -> decltype(elements.begin())
+    {
+        return elements.begin();
+    }
+
+    inline auto end() -> decltype(elements.end()) { return elements.end(); }
+
+    inline auto begin() const -> decltype(elements.cbegin())
+    {
+        return elements.cbegin();
+    }
+
+    inline auto end() const -> decltype(elements.cend())
+    {
+        return elements.cend();
+    }
+};
+
+} // namespace utils
+
+#endif
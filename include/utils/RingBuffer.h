@@ -0,0 +1,108 @@
+#ifndef UTILS_RING_BUFFER_H
+#define UTILS_RING_BUFFER_H
+
+#include "litha_internal.h"
+#include <vector>
+
+namespace utils
+{
+// A FIFO queue in a circular array.
+// PushBack, PopFront and PopBack are O(1) and never move the other elements, unlike
+// erasing from the front of a vector. Grows (doubling) when full, so storage
+// is only reallocated while the queue is longer than it has ever been.
+// Elements are indexed from the front.
+template <class Type>
+class RingBuffer
+{
+    std::vector<Type> elements;
+
+    // Index of the front element, and how many there are.
+    u32 head;
+    u32 count;
+
+    inline u32 Wrap(u32 index) const
+    {
+        // Size is always a power of two.
+        return index & (elements.size() - 1);
+    }
+
+    inline void Grow()
+    {
+        std::vector<Type> grown(elements.size() * 2);
+
+        for (u32 i = 0; i < count; i++)
+            grown[i] = elements[Wrap(head + i)];
+
+        elements.swap(grown);
+        head = 0;
+    }
+
+public:
+    RingBuffer() : elements(8), head(0), count(0) {}
+
+    inline void PushBack(const Type &element)
+    {
+        if (count == elements.size())
+            Grow();
+
+        elements[Wrap(head + count)] = element;
+        count++;
+    }
+
+    inline void PopFront()
+    {
+        ASSERT(count);
+
+        // Don't hold on to anything it owned.
+        elements[head] = Type();
+        head = Wrap(head + 1);
+        count--;
+    }
+
+    inline void PopBack()
+    {
+        ASSERT(count);
+
+        count--;
+        elements[Wrap(head + count)] = Type();
+    }
+
+    inline Type &Front()
+    {
+        ASSERT(count);
+        return elements[head];
+    }
+
+    inline Type &Back()
+    {
+        ASSERT(count);
+        return elements[Wrap(head + count - 1)];
+    }
+
+    inline Type &operator[](u32 index)
+    {
+        ASSERT(index < count);
+        return elements[Wrap(head + index)];
+    }
+
+    inline const Type &operator[](u32 index) const
+    {
+        ASSERT(index < count);
+        return elements[Wrap(head + index)];
+    }
+
+    inline u32 size() const { return count; }
+    inline bool empty() const { return count == 0; }
+
+    inline void clear()
+    {
+        while (count)
+            PopFront();
+
+        head = 0;
+    }
+};
+
+} // namespace utils
+
+#endif
@@ -208,7 +208,7 @@ public:
     }
 
     // Mostly just useful for debugging.
-    E_VARIANT_TYPE GetType();
+    E_VARIANT_TYPE GetType() const;
 };
 
 } // namespace utils
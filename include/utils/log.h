@@ -3,6 +3,7 @@
 #define UTILS_LOG_H
 
 #include "litha_internal.h"
+#include <string>
 
 namespace utils
 {
@@ -18,6 +19,28 @@ enum E_LOG_LEVEL
     ELL_ASSERT
 };
 
+// Log levels below this are compiled out entirely, the arguments of a
+// suppressed NOTE or WARN are never even evaluated.
+// FAIL and ASSERT can never be suppressed.
+#ifndef LITHA_MIN_LOG_LEVEL
+#ifdef NDEBUG
+#define LITHA_MIN_LOG_LEVEL utils::log::ELL_WARN
+#else
+#define LITHA_MIN_LOG_LEVEL utils::log::ELL_NOTE
+#endif
+#endif
+
+// Runtime log level threshold, on top of LITHA_MIN_LOG_LEVEL.
+// Defaults to ELL_NOTE (log everything).
+void setlevel(E_LOG_LEVEL level);
+E_LOG_LEVEL getlevel();
+
+inline bool enabled(E_LOG_LEVEL level)
+{
+    return level >= LITHA_MIN_LOG_LEVEL &&
+           (level >= ELL_FAIL || level >= getlevel());
+}
+
 // Set logging to occur to the specified file. Clears any existing file
 // contents. If this is never called, logging will only occur to stdout.
 void setfile(const io::path &logFile);
@@ -30,8 +53,26 @@ void setfile2(const io::path &logFile);
 // You *should* include the dot in the extension. e.g. ".old"
 void backup(const io::path &ext);
 
+// Logging is written out asynchronously by a background thread.
+// This blocks until everything logged so far has been written.
+// (FAIL and ASSERT do this themselves before aborting)
+void flush();
+
+// Structured logging.
+// When a binary log file is set, log records are written to it as typed
+// fields (the values inserted with <<) rather than formatted into text, and
+// nothing is written to stdout or the text logs except FAIL and ASSERT.
+// An empty path returns to normal text logging.
+// Use decode, or the logdecode tool, to turn the file back into text.
+void setbinaryfile(const io::path &binFile);
+
+// Decode a binary log written by setbinaryfile into text, formatted the same
+// as the text logs. Returns false if the file can't be read or isn't a
+// binary log. (records after any corruption are lost)
+bool decode(const io::path &binFile, core::stringc &text);
+
 // Logger class, implementing the insertion << operator.
-// An instance of this should be created for each line, as the newline is
+// An instance of this should be created for each line, as the line is
 // printed on destruction. Allows you to log anything that a Variant can
 // construct from. (string, int, float) Don't use this directly, instead use the
 // macros at the bottom of this file.
@@ -43,6 +84,13 @@ class Logger
     // Just used for formatting, on the first insert we add a colon ':'.
     bool inserted;
 
+    // The line is built up here and logged as a whole on destruction.
+    core::stringc outStr;
+
+    // Typed record, for when a binary log file is set.
+    bool structured;
+    std::string record;
+
 public:
     Logger(E_LOG_LEVEL logLevel, const core::stringc &fileName, u32 line,
            const core::stringc &funcName);
@@ -51,6 +99,13 @@ public:
     Logger &operator<<(const Variant &output);
 };
 
+// Swallows a whole Logger expression, so it can be one side of the ?: in the
+// logging macros.
+struct Voidify
+{
+    void operator&(const Logger &) {}
+};
+
 } // namespace log
 } // namespace utils
 
@@ -60,8 +115,17 @@ public:
 
 // Macros for logging.
 // Why are we using ugly macros? Because we want line numbers etc.
-#define NOTE utils::log::Logger(utils::log::ELL_NOTE, "", 0, "")
-#define WARN \
+// The conditional means nothing after NOTE or WARN is evaluated when that
+// level is disabled, and the whole statement is removed by the compiler when
+// it is compiled out.
+#define LITHA_LOG_IF_ENABLED(level) \
+    !utils::log::enabled(level) ? (void)0 : utils::log::Voidify() &
+
+#define NOTE                                   \
+    LITHA_LOG_IF_ENABLED(utils::log::ELL_NOTE) \
+    utils::log::Logger(utils::log::ELL_NOTE, "", 0, "")
+#define WARN                                   \
+    LITHA_LOG_IF_ENABLED(utils::log::ELL_WARN) \
     utils::log::Logger(utils::log::ELL_WARN, __FILE__, __LINE__, __func__)
 #define FAIL \
     utils::log::Logger(utils::log::ELL_FAIL, __FILE__, __LINE__, __func__)
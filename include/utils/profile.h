@@ -0,0 +1,90 @@
+#ifndef UTILS_PROFILE_H
+#define UTILS_PROFILE_H
+
+#include "litha_internal.h"
+#include <vector>
+
+// A simple frame profiler.
+// Mark code with PROFILE_ZONE("name") to time it until the end of the scope.
+// Each thread records its zones in its own ring buffer, which are summed per
+// frame (see PROFILE_FRAME) and can be saved in the Chrome trace event format
+// (load in chrome://tracing or Perfetto).
+// The profiler is compiled out completely unless LITHA_PROFILER is 1, which is
+// the default for non release (NDEBUG) builds.
+
+#ifndef LITHA_PROFILER
+#ifdef NDEBUG
+#define LITHA_PROFILER 0
+#else
+#define LITHA_PROFILER 1
+#endif
+#endif
+
+#if LITHA_PROFILER
+
+namespace utils
+{
+namespace profile
+{
+// Total time spent in a zone during a frame.
+// (inclusive of any zones nested inside it)
+struct ZoneTotal
+{
+    const char *name;
+    f32 ms;
+    u32 calls;
+};
+
+// Times a zone from construction to destruction.
+// name must be a string literal or otherwise outlive the profiler.
+class ScopedZone
+{
+    const char *name;
+    unsigned long long startTime;
+
+public:
+    ScopedZone(const char *name);
+    ~ScopedZone();
+};
+
+// Name the calling thread in saved traces.
+void set_thread_name(const char *name);
+
+// Marks the end of a frame, summing all zones recorded since the last call.
+void frame();
+
+// Results for the last complete frame.
+f32 get_last_frame_ms();
+const std::vector<ZoneTotal> &get_last_frame_zones();
+
+// The last frame as text, one zone per line. Slowest first.
+core::stringc get_last_frame_summary();
+
+// Save everything still held in the ring buffers as a Chrome trace event JSON
+// file. Returns false on failure.
+bool save_trace(const io::path &traceFile);
+
+} // namespace profile
+} // namespace utils
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#define PROFILE_ZONE(name) \
+    utils::profile::ScopedZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FRAME() utils::profile::frame()
+
+#else
+
+#define PROFILE_ZONE(name) \
+    do                     \
+    {                      \
+    } while (false)
+#define PROFILE_FRAME() \
+    do                  \
+    {                   \
+    } while (false)
+
+#endif
+
+#endif
@@ -0,0 +1,35 @@
+#include "Litha.h"
+
+// Turns a binary log written with utils::log::setbinaryfile back into text.
+// Usage: litha-logdecode <binary log> [output text file]
+// The text is written to stdout if no output file is given.
+
+int main(int argc, const char **argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <binary log> [output text file]\n", argv[0]);
+        return 1;
+    }
+
+    core::stringc text;
+
+    if (!utils::log::decode(argv[1], text))
+    {
+        printf("Could not read binary log \"%s\"\n", argv[1]);
+        return 1;
+    }
+
+    if (argc > 2)
+    {
+        if (!utils::file::put(argv[2], text))
+        {
+            printf("Could not write \"%s\"\n", argv[2]);
+            return 1;
+        }
+    }
+    else
+        printf("%s", text.c_str());
+
+    return 0;
+}
@@ -1,6 +1,8 @@
 
 #include "Level.h"
 #include "Map.h"
+#include "LevelPreparer.h"
+#include "LevelObjectPool.h"
 #include "Events.h"
 //#include "MonsterCharacterController.h"
 #include "MainState.h"
@@ -183,28 +185,28 @@ LowLevelShaderRegisterMap get_pixel_shader_register_map()
     return rmap;
 }
 
-// Shader callback class, used in ApplyDefaultShaders below.
-class DefaultShaderCallback : public IShaderCallback
+// Shaders are shared by every material using the same files, the world matrix
+// and time being set automatically for each draw rather than by a callback.
+IShader *Level::GetHemisphereShader(const c8 *vertexShaderFileName,
+                                    const c8 *pixelShaderFileName,
+                                    video::E_MATERIAL_TYPE baseMaterial)
 {
-    IEngine *engine;
-    video::IVideoDriver *driver;
+    bool created;
+    IShader *shader = renderSystem->GetSharedShader(
+        vertexShaderFileName, pixelShaderFileName, baseMaterial, &created);
 
-public:
-    DefaultShaderCallback(IEngine *engine)
+    // Shared by every mesh using it, so only set up when first created.
+    if (created)
     {
-        this->engine = engine;
-        this->driver = engine->GetIrrlichtDevice()->getVideoDriver();
+        shader->SetVertexRegisterMap(get_vertex_shader_register_map());
+        shader->SetPixelRegisterMap(get_pixel_shader_register_map());
+        shader->SetAutoVertexConstant("TransWorldMatrix",
+                                      EASC_WORLD_MATRIX_TRANSPOSED);
+        shader->SetAutoVertexConstant("timeSeconds", EASC_TIME_SECONDS);
     }
 
-    void ShaderOnSetConstants(IShader *shader) override
-    {
-        core::matrix4 matWorld = driver->getTransform(video::ETS_WORLD);
-        matWorld = matWorld.getTransposed();
-        shader->SetVertexConstant("TransWorldMatrix", matWorld);
-        shader->SetVertexConstant("timeSeconds",
-                                  engine->GetRenderUpdater().GetVirtualTime());
-    }
-};
+    return shader;
+}
 
 void Level::ApplyDefaultShaders(IMesh *mesh,
                                 video::E_MATERIAL_TYPE baseMaterial)
@@ -219,11 +221,8 @@ void Level::ApplyDefaultShaders(IMesh *mesh,
 
         if (renderSystem->ShadersAreAvailable())
         {
-            IShader *shader =
-                renderSystem->CreateShader("Hemisphere.vert", "Hemisphere.frag",
-                                           baseMaterial);
-            shader->SetVertexRegisterMap(get_vertex_shader_register_map());
-            shader->SetPixelRegisterMap(get_pixel_shader_register_map());
+            IShader *shader = GetHemisphereShader(
+                "Hemisphere.vert", "Hemisphere.frag", baseMaterial);
 
             // Cloud shadow texture in second layer.
             material.setTexture(1, cloudShadowTexture);
@@ -233,13 +232,7 @@ void Level::ApplyDefaultShaders(IMesh *mesh,
             // shader->SetPixelConstant("diffuseTexture",		0);
             // shader->SetPixelConstant("cloudShadowTexture",	1);
 
-            // Callback to set the world matrix.
-            auto *callback = new DefaultShaderCallback(engine);
-            shader->SetCallback(callback);
-            callback->drop();
-
             mesh->SetShader(i, shader);
-            shader->drop();
         }
     }
 }
@@ -257,11 +250,8 @@ void Level::ApplyDefaultShadersIrr(scene::IMesh *mesh,
 
         if (renderSystem->ShadersAreAvailable())
         {
-            IShader *shader =
-                renderSystem->CreateShader("Hemisphere.vert", "Hemisphere.frag",
-                                           baseMaterial);
-            shader->SetVertexRegisterMap(get_vertex_shader_register_map());
-            shader->SetPixelRegisterMap(get_pixel_shader_register_map());
+            IShader *shader = GetHemisphereShader(
+                "Hemisphere.vert", "Hemisphere.frag", baseMaterial);
 
             // Cloud shadow texture in second layer.
             material.setTexture(1, cloudShadowTexture);
@@ -271,12 +261,8 @@ void Level::ApplyDefaultShadersIrr(scene::IMesh *mesh,
             // shader->SetPixelConstant("diffuseTexture",		0);
             // shader->SetPixelConstant("cloudShadowTexture",	1);
 
-            // Callback to set the world matrix.
-            auto *callback = new DefaultShaderCallback(engine);
-            shader->SetCallback(callback);
-            callback->drop();
-
             shader->ApplyToIrrMaterial(material);
+            shader->grab();
             combinedLevelMeshShaders.push_back(shader);
 
             // shader dropped in destructor
@@ -300,11 +286,8 @@ void Level::ApplyLandShaders(IMesh *mesh, video::E_MATERIAL_TYPE baseMaterial)
 
         if (renderSystem->ShadersAreAvailable())
         {
-            IShader *shader =
-                renderSystem->CreateShader("HemisphereLand.vert",
-                                           "Hemisphere.frag", baseMaterial);
-            shader->SetVertexRegisterMap(get_vertex_shader_register_map());
-            shader->SetPixelRegisterMap(get_pixel_shader_register_map());
+            IShader *shader = GetHemisphereShader(
+                "HemisphereLand.vert", "Hemisphere.frag", baseMaterial);
 
             // Cloud shadow texture in second layer.
             material.setTexture(1, cloudShadowTexture);
@@ -314,13 +297,7 @@ void Level::ApplyLandShaders(IMesh *mesh, video::E_MATERIAL_TYPE baseMaterial)
             // shader->SetPixelConstant("diffuseTexture",		0);
             // shader->SetPixelConstant("cloudShadowTexture",	1);
 
-            // Callback to set the world matrix.
-            auto *callback = new DefaultShaderCallback(engine);
-            shader->SetCallback(callback);
-            callback->drop();
-
             mesh->SetShader(i, shader);
-            shader->drop();
         }
     }
 }
@@ -340,10 +317,9 @@ vertex alphas... void Level::ApplyCliffGrassShaders(IMesh *mesh)
 
         if (renderSystem->ShadersAreAvailable())
         {
-            IShader *shader = renderSystem->CreateShader("HemisphereLand.vert",
-"HemisphereCliffGrass.frag", video::EMT_TRANSPARENT_VERTEX_ALPHA);
-            shader->SetVertexRegisterMap(get_vertex_shader_register_map());
-            shader->SetPixelRegisterMap(get_pixel_shader_register_map());
+            IShader *shader = GetHemisphereShader(
+                "HemisphereLand.vert", "HemisphereCliffGrass.frag",
+                video::EMT_TRANSPARENT_VERTEX_ALPHA);
 
             // Cloud shadow texture in second layer.
             material.setTexture(1, cloudShadowTexture);
@@ -353,13 +329,7 @@ material.TextureLayer[0].Texture ? 1 : 0);
             //shader->SetPixelConstant("diffuseTexture",		0);
             //shader->SetPixelConstant("cloudShadowTexture",	1);
 
-            // Callback to set the world matrix.
-            DefaultShaderCallback *callback = new DefaultShaderCallback(engine);
-            shader->SetCallback( callback );
-            callback->drop();
-
             mesh->SetShader(i, shader);
-            shader->drop();
         }
     }
 }
@@ -376,22 +346,14 @@ void Level::ApplyWoodShaders(IMesh *mesh)
 
         if (renderSystem->ShadersAreAvailable())
         {
-            IShader *shader = renderSystem->CreateShader("Hemisphere.vert",
-                                                         "HemisphereWood.frag");
-            shader->SetVertexRegisterMap(get_vertex_shader_register_map());
-            shader->SetPixelRegisterMap(get_pixel_shader_register_map());
+            IShader *shader = GetHemisphereShader(
+                "Hemisphere.vert", "HemisphereWood.frag", video::EMT_SOLID);
 
             // shader->SetPixelConstant("UseDiffuseTexture",
             // material.TextureLayer[0].Texture ? 1 : 0);
             // shader->SetPixelConstant("diffuseTexture", 0);
 
-            // Callback to set the world matrix.
-            auto *callback = new DefaultShaderCallback(engine);
-            shader->SetCallback(callback);
-            callback->drop();
-
             mesh->SetShader(i, shader);
-            shader->drop();
         }
     }
 }
@@ -408,22 +370,14 @@ void Level::ApplyIceShaders(IMesh *mesh)
 
         if (renderSystem->ShadersAreAvailable())
         {
-            IShader *shader = renderSystem->CreateShader("Hemisphere.vert",
-                                                         "HemisphereIce.frag");
-            shader->SetVertexRegisterMap(get_vertex_shader_register_map());
-            shader->SetPixelRegisterMap(get_pixel_shader_register_map());
+            IShader *shader = GetHemisphereShader(
+                "Hemisphere.vert", "HemisphereIce.frag", video::EMT_SOLID);
 
             // shader->SetPixelConstant("UseDiffuseTexture",
             // material.TextureLayer[0].Texture ? 1 : 0);
             // shader->SetPixelConstant("diffuseTexture", 0);
 
-            // Callback to set the world matrix.
-            auto *callback = new DefaultShaderCallback(engine);
-            shader->SetCallback(callback);
-            callback->drop();
-
             mesh->SetShader(i, shader);
-            shader->drop();
         }
     }
 }
@@ -440,20 +394,11 @@ void Level::ApplyBalloonShaders(IMesh *mesh)
 
         if (renderSystem->ShadersAreAvailable())
         {
-            IShader *shader =
-                renderSystem->CreateShader("HemisphereBalloon.vert",
-                                           "HemisphereBalloon.frag",
-                                           video::EMT_TRANSPARENT_VERTEX_ALPHA);
-            shader->SetVertexRegisterMap(get_vertex_shader_register_map());
-            shader->SetPixelRegisterMap(get_pixel_shader_register_map());
-
-            // Callback to set the world matrix.
-            auto *callback = new DefaultShaderCallback(engine);
-            shader->SetCallback(callback);
-            callback->drop();
+            IShader *shader = GetHemisphereShader(
+                "HemisphereBalloon.vert", "HemisphereBalloon.frag",
+                video::EMT_TRANSPARENT_VERTEX_ALPHA);
 
             mesh->SetShader(i, shader);
-            shader->drop();
         }
     }
 }
@@ -475,15 +420,18 @@ void Level::ApplyPlainAlphaShaders(IMesh *mesh, u8 alpha)
 
         if (renderSystem->ShadersAreAvailable())
         {
-            IShader *shader =
-                renderSystem->CreateShader("PlainWithAlpha.vert",
-                                           "PlainWithAlpha.frag",
-                                           video::EMT_TRANSPARENT_VERTEX_ALPHA);
-            shader->SetVertexRegisterMap(get_vertex_shader_register_map());
-            shader->SetPixelRegisterMap(get_pixel_shader_register_map());
+            bool created;
+            IShader *shader = renderSystem->GetSharedShader(
+                "PlainWithAlpha.vert", "PlainWithAlpha.frag",
+                video::EMT_TRANSPARENT_VERTEX_ALPHA, &created);
+
+            if (created)
+            {
+                shader->SetVertexRegisterMap(get_vertex_shader_register_map());
+                shader->SetPixelRegisterMap(get_pixel_shader_register_map());
+            }
 
             mesh->SetShader(i, shader);
-            shader->drop();
         }
 
         material.MaterialType = video::EMT_TRANSPARENT_VERTEX_ALPHA;
@@ -657,63 +605,13 @@ void Level::MaybeAddFlower(core::vector3df absPos)
     */
 }
 
-void Level::OptimiseLevel()
+void Level::OptimiseLevel(const PreparedLevel *prepared)
 {
-    // Adjacent 4 map coordinates (in cross shape)
-    // [ ][x][ ]
-    // [x][P][x]
-    // [ ][x][ ]
-    std::vector<core::vector3di> cross;
-    cross.push_back(core::vector3di(1, 0, 0));
-    cross.push_back(core::vector3di(-1, 0, 0));
-    cross.push_back(core::vector3di(0, 0, 1));
-    cross.push_back(core::vector3di(0, 0, -1));
-
-    // Make a list of all ground blocks which are surrounded completely by other
-    // ground blocks.
-
-    std::vector<core::vector3di> objectCoords = map->GetAllObjects();
-    std::vector<core::vector3di> surrounded_GroundBlocks;
-
-    for (auto &objectCoord : objectCoords)
-    {
-        // If a ground block, and surrounded completely by other ground
-        // blocks...
-
-        if (map->GetObjectType(objectCoord) == EOT_GROUND_BLOCK)
-        {
-            u8 j;
-
-            for (j = 0; j < cross.size(); j++)
-            {
-                core::vector3di coord = objectCoord + cross[j];
-
-                if (!map->GetObject(coord) ||
-                    map->GetObjectType(coord) != EOT_GROUND_BLOCK)
-                    break;
-            }
-
-            if (j == cross.size())
-                surrounded_GroundBlocks.push_back(objectCoord);
-        }
-    }
-
-    // Then replace these with a ground block mesh that has no sides.
-
-    for (auto &surrounded_GroundBlock : surrounded_GroundBlocks)
-    {
-        RemoveObject(surrounded_GroundBlock);
-
-        IMesh *mesh =
-            AddObject(surrounded_GroundBlock, "ground_single_sideless.b3d",
-                      false, EOT_GROUND_BLOCK);
-        GroundBlockUV_Adjust2(mesh, surrounded_GroundBlock);
-    }
-
     // NEW!!
     // Combine all ground blocks into a single mesh...
     // With only two mesh buffers, grass and mud.
     // (compare to before, when each individual tile has 6 mesh buffers!)
+    // Blocks surrounded by other ground blocks are combined without sides.
     if (combineMeshes)
     {
         // Clear old combined mesh.
@@ -734,10 +632,41 @@ void Level::OptimiseLevel()
 
         scene::ISceneManager *smgr =
             engine->GetIrrlichtDevice()->getSceneManager();
-        scene::IMeshManipulator *meshManipulator = smgr->getMeshManipulator();
         video::IVideoDriver *driver =
             engine->GetIrrlichtDevice()->getVideoDriver();
 
+        std::vector<core::vector3di> groundBlocks;
+
+        for (auto &objectCoord : map->GetAllObjects())
+        {
+            if (map->GetObjectType(objectCoord) == EOT_GROUND_BLOCK)
+                groundBlocks.push_back(objectCoord);
+        }
+
+        // Usually already built by LevelPreparer.
+        GroundMesh builtGroundMesh;
+        const GroundMesh *groundMesh = nullptr;
+
+        if (prepared)
+            groundMesh = &prepared->groundMesh;
+        else
+        {
+            GroundMeshSource single;
+            GroundMeshSource sideless;
+            single.Load(smgr, "ground_single.b3d");
+            sideless.Load(smgr, "ground_single_sideless.b3d");
+
+            builtGroundMesh.Build(groundBlocks, single, sideless);
+            groundMesh = &builtGroundMesh;
+        }
+
+        // All ground blocks are solid.
+        // Therefore, we just remove children of each block (its mesh), and not
+        // the block itself. (the block itself is the physical body, and needs
+        // to stay)
+        for (auto &groundBlock : groundBlocks)
+            map->GetObject(groundBlock)->RemoveAllChildren();
+
         auto *mesh = new scene::SMesh();
 
         // We put everything in just two mesh buffers!
@@ -752,191 +681,14 @@ void Level::OptimiseLevel()
         mbMud->getMaterial().TextureLayer[0].Texture =
             driver->getTexture("mud.jpg");
 
-        // First remove all existing ground blocks meshes.
-
-        for (auto &objectCoord : objectCoords)
-        {
-            if (map->GetObjectType(objectCoord) == EOT_GROUND_BLOCK)
-            {
-                core::vector3df pos = GetPosFromCoord(objectCoord);
-
-                // All ground blocks are solid.
-                // Therefore, we just remove children of this block, and not the
-                // block itself. (the block itself is the physical body, and
-                // needs to stay)
-
-                ITransformable *obj = map->GetObject(objectCoord);
-
-                // Find the ground block mesh.
-
-                auto *objMesh = obj->GetFirstChildOfType<IMesh>();
-
-                ASSERT(objMesh);
-
-                // Add that mesh's data to the combined mesh...
-                // Transform it etc.
-
-                scene::IMesh *otherMesh =
-                    objMesh->GetIrrlichtNode()->getMesh()->getMesh(0);
-
-                for (u32 j = 0; j < otherMesh->getMeshBufferCount(); j++)
-                {
-                    // We want a completely new, unique mesh buffer, so we can
-                    // modify it how we like.
-                    scene::IMeshBuffer *mbTemp = new scene::SMeshBuffer();
-                    scene::IMeshBuffer *otherMb = otherMesh->getMeshBuffer(j);
-
-                    // Fill the new mesh buffer
-                    mbTemp->append(otherMb->getVertices(),
-                                   otherMb->getVertexCount(),
-                                   otherMb->getIndices(),
-                                   otherMb->getIndexCount());
-
-                    // apply old Litha IMesh transform to this mesh buffer.
-                    // what about permanently applied position or rotation??
-                    // --> ignore, ground tiles shouldn't have it??
-
-                    core::matrix4 mat;
-                    mat.setTranslation(objMesh->GetAbsolutePosition());
-                    mat.setRotationDegrees(objMesh->GetAbsoluteRotation());
-                    meshManipulator->transform(mbTemp, mat);
-
-                    // Now adjust UVs (do what formerly had to be done via the
-                    // texture matrix)
-
-                    ASSERT(mbTemp->getVertexType() == video::EVT_STANDARD);
-
-                    auto *vertices = (video::S3DVertex *)mbTemp->getVertices();
-
-                    // Get texture name from otherMb since material has not been
-                    // set on temp meshbuffer
-                    io::path textureName =
-                        os::path::basename(otherMb->getMaterial()
-                                               .TextureLayer[0]
-                                               .Texture->getName());
-
-                    if (textureName == "mud_front.jpg") // front
-                    {
-                        // matrix.setTextureScale( 1.0/scale, 1.0/scale );
-                        // matrix.setTextureTranslate( pos.Y/scale, pos.X/scale
-                        // );
-
-                        for (u32 k = 0; k < mbTemp->getVertexCount(); k++)
-                        {
-                            const f32 scale = 3.f;
-
-                            vertices[k].TCoords *= 1.f / scale;
-                            vertices[k].TCoords.X += pos.Y / scale;
-                            vertices[k].TCoords.Y += pos.X / scale;
-                        }
-                    }
-                    else if (textureName == "mud_back.jpg") // back
-                    {
-                        // matrix.setTextureScale( 1.0/scale, 1.0/scale );
-                        // matrix.setTextureTranslate( -pos.Y/scale, pos.X/scale
-                        // );
-
-                        for (u32 k = 0; k < mbTemp->getVertexCount(); k++)
-                        {
-                            const f32 scale = 3.f;
-
-                            vertices[k].TCoords *= 1.f / scale;
-                            vertices[k].TCoords.X += -pos.Y / scale;
-                            vertices[k].TCoords.Y += pos.X / scale;
-                        }
-                    }
-                    else if (textureName == "grass1_lighter.jpg") // top
-                    {
-                        // matrix.setTextureScale( 1.0/scale, 1.0/scale );
-                        // matrix.setTextureTranslate( pos.X/scale, -pos.Z/scale
-                        // );
-
-                        for (u32 k = 0; k < mbTemp->getVertexCount(); k++)
-                        {
-                            const f32 scale = 3.f;
-
-                            vertices[k].TCoords *= 1.f / scale;
-                            vertices[k].TCoords.X += pos.X / scale;
-                            vertices[k].TCoords.Y += -pos.Z / scale;
-                        }
-                    }
-                    else if (textureName == "mud_bottom.jpg") // bottom
-                    {
-                        // matrix.setTextureScale( 1.0/scale, 1.0/scale );
-                        // matrix.setTextureTranslate( -pos.Z/scale, pos.X/scale
-                        // );
-
-                        for (u32 k = 0; k < mbTemp->getVertexCount(); k++)
-                        {
-                            const f32 scale = 3.f;
-
-                            vertices[k].TCoords *= 1.f / scale;
-                            vertices[k].TCoords.X += -pos.Z / scale;
-                            vertices[k].TCoords.Y += pos.X / scale;
-                        }
-                    }
-                    else if (textureName == "mud_right.jpg") // right
-                    {
-                        // matrix.setTextureScale( 1.0/scale, 1.0/scale );
-                        // matrix.setTextureTranslate( pos.Y/scale, pos.Z/scale
-                        // );
-
-                        for (u32 k = 0; k < mbTemp->getVertexCount(); k++)
-                        {
-                            const f32 scale = 3.f;
-
-                            vertices[k].TCoords *= 1.f / scale;
-                            vertices[k].TCoords.X += pos.Y / scale;
-                            vertices[k].TCoords.Y += pos.Z / scale;
-                        }
-                    }
-                    else if (textureName == "mud_left.jpg") // left
-                    {
-                        // matrix.setTextureScale( 1.0/scale, 1.0/scale );
-                        // matrix.setTextureTranslate( pos.Y/scale, -pos.Z/scale
-                        // );
-
-                        for (u32 k = 0; k < mbTemp->getVertexCount(); k++)
-                        {
-                            const f32 scale = 3.f;
-
-                            vertices[k].TCoords *= 1.f / scale;
-                            vertices[k].TCoords.X += pos.Y / scale;
-                            vertices[k].TCoords.Y += -pos.Z / scale;
-                        }
-                    }
-                    else
-                    {
-                        FAIL << "texture not handled...";
-                    }
-
-                    // NOW, we combine all separate mud textures into a single
-                    // buffer...
-
-                    if (textureName == "grass1_lighter.jpg")
-                    {
-                        mbGrass->append(mbTemp->getVertices(),
-                                        mbTemp->getVertexCount(),
-                                        mbTemp->getIndices(),
-                                        mbTemp->getIndexCount());
-                    }
-                    else // is mud
-                    {
-                        mbMud->append(mbTemp->getVertices(),
-                                      mbTemp->getVertexCount(),
-                                      mbTemp->getIndices(),
-                                      mbTemp->getIndexCount());
-                    }
-
-                    // Discard the temporary buffer now contents are in the
-                    // grass or mud buffers.
-                    mbTemp->drop();
-                }
-
-                // And remove the old IMesh...
-                obj->RemoveAllChildren();
-            }
-        }
+        mbGrass->append(groundMesh->grassVertices.data(),
+                        groundMesh->grassVertices.size(),
+                        groundMesh->grassIndices.data(),
+                        groundMesh->grassIndices.size());
+        mbMud->append(groundMesh->mudVertices.data(),
+                      groundMesh->mudVertices.size(),
+                      groundMesh->mudIndices.data(),
+                      groundMesh->mudIndices.size());
 
         // add new mesh buffers, then drop references
 
@@ -980,6 +732,59 @@ void Level::OptimiseLevel()
         */
         mesh->drop();
     }
+    else
+    {
+        // Adjacent 4 map coordinates (in cross shape)
+        // [ ][x][ ]
+        // [x][P][x]
+        // [ ][x][ ]
+        std::vector<core::vector3di> cross;
+        cross.push_back(core::vector3di(1, 0, 0));
+        cross.push_back(core::vector3di(-1, 0, 0));
+        cross.push_back(core::vector3di(0, 0, 1));
+        cross.push_back(core::vector3di(0, 0, -1));
+
+        // Not combining (e.g. in the editor), so make a list of all ground
+        // blocks which are surrounded completely by other ground blocks.
+
+        std::vector<core::vector3di> objectCoords = map->GetAllObjects();
+        std::vector<core::vector3di> surrounded_GroundBlocks;
+
+        for (auto &objectCoord : objectCoords)
+        {
+            // If a ground block, and surrounded completely by other ground
+            // blocks...
+
+            if (map->GetObjectType(objectCoord) == EOT_GROUND_BLOCK)
+            {
+                u8 j;
+
+                for (j = 0; j < cross.size(); j++)
+                {
+                    core::vector3di coord = objectCoord + cross[j];
+
+                    if (!map->GetObject(coord) ||
+                        map->GetObjectType(coord) != EOT_GROUND_BLOCK)
+                        break;
+                }
+
+                if (j == cross.size())
+                    surrounded_GroundBlocks.push_back(objectCoord);
+            }
+        }
+
+        // Then replace these with a ground block mesh that has no sides.
+
+        for (auto &surrounded_GroundBlock : surrounded_GroundBlocks)
+        {
+            RemoveObject(surrounded_GroundBlock);
+
+            IMesh *mesh =
+                AddObject(surrounded_GroundBlock, "ground_single_sideless.b3d",
+                          false, EOT_GROUND_BLOCK);
+            GroundBlockUV_Adjust2(mesh, surrounded_GroundBlock);
+        }
+    }
 
     // We're also going to add some level effects here
 
@@ -1158,6 +963,12 @@ void Level::AddFanParticleSystem(core::vector3di mapCoord, f32 height)
     irrNodes.push_back(ps);
 }
 
+static bool is_movable_object(E_OBJECT_TYPE type)
+{
+    return type == EOT_MOVABLE_BLOCK || type == EOT_SLIDING_BLOCK ||
+           type == EOT_BALLOON;
+}
+
 void Level::CreateObject(core::vector3di mapCoord, E_OBJECT_TYPE type)
 {
     if (map->GetObject(mapCoord))
@@ -1166,6 +977,22 @@ void Level::CreateObject(core::vector3di mapCoord, E_OBJECT_TYPE type)
         return;
     }
 
+    // Reuse an object from a previous level if there is one.
+    // (so a restart is mostly just moving things back into place)
+    // It already has all the setup below from when it was first created,
+    // which is why only types without per coordinate setup are poolable
+    // (see LevelObjectPool::IsPoolable). Take positions it and its children.
+    if (objectPool && CanPark(type))
+    {
+        if (ITransformable *object =
+                objectPool->Take(type, GetPosFromCoord(mapCoord)))
+        {
+            map->SetObject(mapCoord, object, is_movable_object(type), type);
+            ExpandBB(mapCoord);
+            return;
+        }
+    }
+
     IMesh *mesh = nullptr;
 
     switch (type)
@@ -1187,15 +1014,18 @@ void Level::CreateObject(core::vector3di mapCoord, E_OBJECT_TYPE type)
     case EOT_MOVABLE_BLOCK:
         mesh = AddObject(mapCoord, "box.b3d", true, type);
         ApplyWoodShaders(mesh);
+        mesh->SetInstanced(true);
         break;
     case EOT_SLIDING_BLOCK:
         mesh = AddObject(mapCoord, "icybox.irrmesh", true, type);
         // ApplyWoodShaders(mesh);
         ApplyPlainAlphaShaders(mesh, 150);
+        mesh->SetInstanced(true);
         {
             IMesh *insideMesh = world->AddMesh("icybox_inner.irrmesh");
             mesh->AddChild(insideMesh);
             ApplyIceShaders(insideMesh);
+            insideMesh->SetInstanced(true);
         }
         break;
     case EOT_BALLOON:
@@ -1204,6 +1034,7 @@ void Level::CreateObject(core::vector3di mapCoord, E_OBJECT_TYPE type)
         // ApplyPlainAlphaShaders(mesh, 230);
         ApplyBalloonShaders(mesh);
         SetMeshAlpha(mesh, 200);
+        mesh->SetInstanced(true);
 
         IBobAnimator *bobAnim =
             world->CreateBobAnimator(0.04, 1.0 + (rand() % 100) * 0.002);
@@ -1217,6 +1048,7 @@ void Level::CreateObject(core::vector3di mapCoord, E_OBJECT_TYPE type)
         // *** FAN BASE ***
         // Fan body, the main object
         mesh = AddObject(mapCoord, "magicfan_base.b3d", false, type);
+        mesh->SetInstanced(true);
 
         // *** FAN BLADES ***
         // And some fan blades as child of mesh.
@@ -1235,6 +1067,7 @@ void Level::CreateObject(core::vector3di mapCoord, E_OBJECT_TYPE type)
         bladeMesh->SetShader(0, nullptr);
         bladeMesh->GetMaterial(0).MaterialType = video::EMT_SPHERE_MAP;
         bladeMesh->GetMaterial(0).TextureLayer[0].Texture = sphereMap;
+        bladeMesh->SetInstanced(true);
 
         // fan blade rotation animator...
 
@@ -1249,12 +1082,15 @@ void Level::CreateObject(core::vector3di mapCoord, E_OBJECT_TYPE type)
         IMesh *orbMesh = world->AddMesh("magicfan_orb.irrmesh");
         mesh->AddChild(orbMesh);
         orbMesh->GetMaterial(0).Lighting = false;
+        orbMesh->SetInstanced(true);
 
         // Fan noise
         ISoundSource *soundSource = world->AddSoundSource();
         mesh->AddChild(soundSource);
         soundSource->GetSound()->SetIsLooped(true);
         soundSource->GetSound()->SetVolume(0.5);
+        // Some levels have lots of fans, let everything else be heard first.
+        soundSource->GetSound()->SetPriority(-1);
         soundSource->GetSound()->Play(
             paths::get_sfx("buttonflutter_micro.ogg"));
         soundSource->ApplyTransformNow();
@@ -1270,6 +1106,7 @@ void Level::CreateObject(core::vector3di mapCoord, E_OBJECT_TYPE type)
     case EOT_LIFT:
     {
         mesh = AddObject(mapCoord, "lift.b3d", false, type);
+        mesh->SetInstanced(true);
 
         // video::SMaterial &mat = mesh->GetMaterial(0,0);
         // mat.TextureLayer[0].Texture =
@@ -1279,6 +1116,7 @@ void Level::CreateObject(core::vector3di mapCoord, E_OBJECT_TYPE type)
         IMesh *glowMesh = world->AddMesh("lift_glow.irrmesh");
         mesh->AddChild(glowMesh);
         glowMesh->GetMaterial(0).Lighting = false;
+        glowMesh->SetInstanced(true);
 
         IMotionSensor *motionSensor = world->AddSoundMotionSensor(
             // I need a search path manager thing.
@@ -1301,6 +1139,7 @@ void Level::CreateObject(core::vector3di mapCoord, E_OBJECT_TYPE type)
             // mesh->GetMaterial(0).Lighting = false;
 
             ApplyPlainAlphaShaders(teleportMesh, 40 + rand() % 40);
+            teleportMesh->SetInstanced(true);
 
             f32 bottom = 0.1;
             f32 top = 0.9;
@@ -1383,6 +1222,28 @@ void Level::RemoveObject(core::vector3di mapCoord)
     }
 }
 
+bool Level::CanPark(E_OBJECT_TYPE type)
+{
+    if (!objectPool || objectPool->IsClosed() ||
+        !LevelObjectPool::IsPoolable(type))
+        return false;
+
+    // Combined ground blocks are just a body, their mesh having been removed.
+    // Otherwise each has its own UV adjusted mesh so isn't worth keeping.
+    if (type == EOT_GROUND_BLOCK)
+        return combineMeshes;
+
+    return true;
+}
+
+void Level::ParkOrRemoveObject(ITransformable *object, E_OBJECT_TYPE type)
+{
+    if (CanPark(type))
+        objectPool->Park(object, type);
+    else
+        world->RemoveTransformable(object);
+}
+
 void Level::PlayerPushed(core::vector3di mapCoord, core::vector3di pushVec)
 {
     if (!logicEnabled) // hack! so blocks used as decoration in final scene are
@@ -1685,6 +1546,9 @@ void Level::SetMeshAlpha(IMesh *mesh, u8 alpha)
     scene::IMeshManipulator *mm =
         engine->GetIrrlichtDevice()->getSceneManager()->getMeshManipulator();
     mm->setVertexColorAlpha(mesh->GetIrrlichtNode()->getMesh(), alpha);
+
+    // So instanced meshes pick it up.
+    mesh->GetIrrlichtNode()->getMesh()->setDirty(scene::EBT_VERTEX);
 }
 
 void Level::SetMeshColour(IMesh *mesh, video::SColor col)
@@ -1692,6 +1556,7 @@ void Level::SetMeshColour(IMesh *mesh, video::SColor col)
     scene::IMeshManipulator *mm =
         engine->GetIrrlichtDevice()->getSceneManager()->getMeshManipulator();
     mm->setVertexColors(mesh->GetIrrlichtNode()->getMesh(), col);
+    mesh->GetIrrlichtNode()->getMesh()->setDirty(scene::EBT_VERTEX);
 }
 
 /*
@@ -1786,7 +1651,8 @@ MonsterCharacterController(this,GetPlayer()); entity->SetController(controller);
 */
 
 Level::Level(MainState *mainState, core::stringc fileName,
-             std::deque<UndoState> *undoHistory)
+             std::deque<UndoState> *undoHistory,
+             const PreparedLevel *prepared)
 {
     this->engine = GetEngine();
     this->world = engine->GetWorld();
@@ -1794,6 +1660,11 @@ Level::Level(MainState *mainState, core::stringc fileName,
     this->mainState = mainState;
     this->fileName = fileName;
 
+    objectPool = mainState ? mainState->GetObjectPool() : nullptr;
+
+    if (objectPool)
+        objectPool->grab();
+
     this->localGridBasedMovement = gridBasedMovement;
 
     timeSinceLastUndoSave = 10000.f; // want to be able do undo immediately. (in
@@ -1887,156 +1758,13 @@ Level::Level(MainState *mainState, core::stringc fileName,
     }
     else
     {
-        Load();
+        Load(nullptr, prepared);
 
         // Then load tutorial texts.
-        io::path tutorialFileName = paths::get_tutorial_texts_dir();
-        tutorialFileName += "/";
-        tutorialFileName += os::path::splitext(GetShortName())[0];
-        tutorialFileName += ".ini";
-
-        std::vector<core::stringc> lines = file::get_lines(tutorialFileName);
-
-        if (lines.size() == 0)
-            NOTE << "No tutorial text existed: " << tutorialFileName;
+        if (prepared)
+            tutorialTexts = prepared->tutorialTexts;
         else
-        {
-            NOTE << "Found tutorial text: " << tutorialFileName;
-
-            std::vector<core::stringc> texts;
-
-            const f32 displayTimeDefault = 5.f;
-            const f32 delayTimeDefault = 0.f;
-
-            f32 displayTime = displayTimeDefault;
-            f32 delayTime = delayTimeDefault;
-
-            for (auto &line : lines)
-            {
-                std::vector<core::stringc> parts =
-                    str::explode_at_assignment(line);
-
-                if (parts[0].size() && parts[1].size())
-                {
-                    // push a line of text (may be multiple lines)
-                    if (parts[0] == "line")
-                        texts.push_back(parts[1]);
-
-                    if (parts[0] == "display_time")
-                        displayTime = str::from_f32(parts[1]);
-
-                    if (parts[0] == "delay_time")
-                        delayTime = str::from_f32(parts[1]);
-
-                    // finished pushing text lines, now we have the trigger
-                    // condition for those lines.
-                    if (parts[0] == "trigger" || parts[0] == "trigger_x" ||
-                        parts[0] == "trigger_y" || parts[0] == "trigger_z" ||
-                        parts[0] == "trigger_surround")
-                    {
-                        bool fail = false;
-
-                        TutorialText tutorialItem;
-                        tutorialItem.lines = texts;
-                        tutorialItem.displayTime = displayTime;
-                        tutorialItem.delayTime = delayTime;
-
-                        if (parts[0] == "trigger")
-                        {
-                            tutorialItem.type = TTT_NORMAL;
-
-                            // parse trigger
-
-                            std::vector<core::stringc> triggerParts =
-                                str::explode(",", parts[1]);
-
-                            if (triggerParts.size() == 3)
-                            {
-                                core::vector3di triggerPos;
-                                triggerPos.X = str::from_s32(triggerParts[0]);
-                                triggerPos.Y = str::from_s32(triggerParts[1]);
-                                triggerPos.Z = str::from_s32(triggerParts[2]);
-                                tutorialItem.trigger = triggerPos;
-                            }
-                            else
-                            {
-                                WARN << "Invalid trigger in tutorial text: "
-                                     << line;
-                                fail = true;
-                            }
-                        }
-                        else if (parts[0] == "trigger_surround")
-                        {
-                            tutorialItem.type = TTT_SURROUND;
-
-                            // parse trigger
-
-                            std::vector<core::stringc> triggerParts =
-                                str::explode(",", parts[1]);
-
-                            if (triggerParts.size() == 3)
-                            {
-                                core::vector3di triggerPos;
-                                triggerPos.X = str::from_s32(triggerParts[0]);
-                                triggerPos.Y = str::from_s32(triggerParts[1]);
-                                triggerPos.Z = str::from_s32(triggerParts[2]);
-                                tutorialItem.trigger = triggerPos;
-                            }
-                            else
-                            {
-                                WARN << "Invalid trigger in tutorial text: "
-                                     << line;
-                                fail = true;
-                            }
-                        }
-                        else if (parts[0] == "trigger_x")
-                        {
-                            tutorialItem.type = TTT_X;
-                            tutorialItem.trigger.X = str::from_s32(parts[1]);
-                        }
-                        else if (parts[0] == "trigger_y")
-                        {
-                            tutorialItem.type = TTT_Y;
-                            tutorialItem.trigger.Y = str::from_s32(parts[1]);
-                        }
-                        else if (parts[0] == "trigger_z")
-                        {
-                            tutorialItem.type = TTT_Z;
-                            tutorialItem.trigger.Z = str::from_s32(parts[1]);
-                        }
-
-                        // Success! Added a tutorial item.
-                        if (!fail)
-                            tutorialTexts.push_back(tutorialItem);
-
-                        // Reset the text lines for the next tutorial text.
-                        texts.clear();
-
-                        // Reset stuff
-                        displayTime = displayTimeDefault;
-                        delayTime = delayTimeDefault;
-                    }
-                }
-            }
-
-            // Just for info, output what was read.
-
-            for (auto &elem : tutorialTexts)
-            {
-                NOTE << "[tutorial item]";
-
-                for (auto &line : elem.lines)
-                {
-                    NOTE << "Line: " << line;
-                }
-
-                NOTE << "Will delay for: " << elem.delayTime << " seconds";
-                NOTE << "Will display for: " << elem.displayTime << " seconds";
-
-                NOTE << "Condition: trigger on map location {" << elem.trigger.X
-                     << "," << elem.trigger.Y << "," << elem.trigger.Z << "}";
-            }
-        }
+            tutorialTexts = ReadTutorialTexts(fileName);
     }
 
     // orient the player to be looking towards the centre of the bounding box
@@ -2125,7 +1853,7 @@ Level::~Level()
     {
         if (ITransformable *entity = map->GetObject(mapObject))
         {
-            world->RemoveTransformable(entity);
+            ParkOrRemoveObject(entity, map->GetObjectType(mapObject));
 
             // if this was an actor, it has been removed, so remove from actors
             // list. (so we don't attempt RemoveTransformable on an actor again
@@ -2153,8 +1881,12 @@ Level::~Level()
         world->RemoveTransformable(elem.entity);
 
     // Remove anything else (e.g. flowers)
+    // Parked objects are kept.
     world->RemoveAllTransformables();
 
+    if (objectPool)
+        objectPool->drop();
+
     // No more input
     // (subscribed to if Start has been called)
     world->UnsubscribeFromInput(this);
@@ -2314,7 +2046,7 @@ void Level::ReplaceWith(core::stringc fileName)
             if (map->GetObjectType(mapObject) != EOT_PLAYER_CENTRE &&
                 map->GetObjectType(mapObject) != EOT_PLAYER_INTERSECTING)
             {
-                world->RemoveTransformable(entity);
+                ParkOrRemoveObject(entity, map->GetObjectType(mapObject));
             }
         }
     }
@@ -2498,6 +2230,10 @@ void Level::ShowEndLevelScreen()
     world->GetUpdater().AddUpdatable(es);
     es->drop();
 
+    // Get the next level ready while the results are being read.
+    if (mainState)
+        mainState->PrepareNextLevel();
+
     ClearTutorialTextElements();
 }
 
@@ -2637,42 +2373,220 @@ void Level::Save()
     }
 }
 
-void Level::Load(UndoState *undoState)
+bool Level::ReadMapContents(const core::stringc &fileName,
+                            std::vector<UndoState::MapLoc> &mapContents)
 {
-    std::vector<core::vector3di> startPositions;
+    std::ifstream infile(fileName.c_str());
 
-    if (!undoState) // default, loads from filename
+    std::string line;
+    while (std::getline(infile, line))
+    {
+        std::stringstream ss(line);
+        int x, y, z;
+        int objectType;
+        int eventType;
+        // NOTE: UNKNOWN types of object or event indicate no object/event.
+        // format: {x},{y},{z}\t{objectType}\t{eventType}
+        // NOTE: The tabs are ignored when reading
+        char comma = ',';
+        if (!(ss >> x >> comma >> y >> comma >> z >> objectType >>
+              eventType) ||
+            comma != ',')
+        {
+            return false;
+        }
+
+        UndoState::MapLoc loc;
+        loc.coord = core::vector3di(x, y, z);
+        loc.objectType = objectType;
+        loc.eventType = eventType;
+        loc.hasPreviousCoord = false;
+        loc.is_sliding = false;
+        mapContents.push_back(loc);
+    }
+
+    return true;
+}
+
+std::vector<TutorialText>
+Level::ReadTutorialTexts(const core::stringc &fileName)
+{
+    std::vector<TutorialText> tutorialTexts;
+
+    io::path tutorialFileName = paths::get_tutorial_texts_dir();
+    tutorialFileName += "/";
+    tutorialFileName += os::path::splitext(os::path::basename(fileName))[0];
+    tutorialFileName += ".ini";
+
+    std::vector<core::stringc> lines = file::get_lines(tutorialFileName);
+
+    if (lines.size() == 0)
+        NOTE << "No tutorial text existed: " << tutorialFileName;
+    else
     {
-        std::ifstream infile(fileName.c_str());
+        NOTE << "Found tutorial text: " << tutorialFileName;
+
+        std::vector<core::stringc> texts;
 
-        std::string line;
-        while (std::getline(infile, line))
+        const f32 displayTimeDefault = 5.f;
+        const f32 delayTimeDefault = 0.f;
+
+        f32 displayTime = displayTimeDefault;
+        f32 delayTime = delayTimeDefault;
+
+        for (auto &line : lines)
         {
-            std::stringstream ss(line);
-            int x, y, z;
-            int objectType;
-            int eventType;
-            // NOTE: UNKNOWN types of object or event indicate no object/event.
-            // format: {x},{y},{z}\t{objectType}\t{eventType}
-            // NOTE: The tabs are ignored when reading
-            char comma = ',';
-            if (!(ss >> x >> comma >> y >> comma >> z >> objectType >>
-                  eventType) ||
-                comma != ',')
+            std::vector<core::stringc> parts =
+                str::explode_at_assignment(line);
+
+            if (parts[0].size() && parts[1].size())
             {
-                WARN << "Invalid level file (" << fileName << ")";
-                break;
+                // push a line of text (may be multiple lines)
+                if (parts[0] == "line")
+                    texts.push_back(parts[1]);
+
+                if (parts[0] == "display_time")
+                    displayTime = str::from_f32(parts[1]);
+
+                if (parts[0] == "delay_time")
+                    delayTime = str::from_f32(parts[1]);
+
+                // finished pushing text lines, now we have the trigger
+                // condition for those lines.
+                if (parts[0] == "trigger" || parts[0] == "trigger_x" ||
+                    parts[0] == "trigger_y" || parts[0] == "trigger_z" ||
+                    parts[0] == "trigger_surround")
+                {
+                    bool fail = false;
+
+                    TutorialText tutorialItem;
+                    tutorialItem.lines = texts;
+                    tutorialItem.displayTime = displayTime;
+                    tutorialItem.delayTime = delayTime;
+
+                    if (parts[0] == "trigger")
+                    {
+                        tutorialItem.type = TTT_NORMAL;
+
+                        // parse trigger
+
+                        std::vector<core::stringc> triggerParts =
+                            str::explode(",", parts[1]);
+
+                        if (triggerParts.size() == 3)
+                        {
+                            core::vector3di triggerPos;
+                            triggerPos.X = str::from_s32(triggerParts[0]);
+                            triggerPos.Y = str::from_s32(triggerParts[1]);
+                            triggerPos.Z = str::from_s32(triggerParts[2]);
+                            tutorialItem.trigger = triggerPos;
+                        }
+                        else
+                        {
+                            WARN << "Invalid trigger in tutorial text: "
+                                 << line;
+                            fail = true;
+                        }
+                    }
+                    else if (parts[0] == "trigger_surround")
+                    {
+                        tutorialItem.type = TTT_SURROUND;
+
+                        // parse trigger
+
+                        std::vector<core::stringc> triggerParts =
+                            str::explode(",", parts[1]);
+
+                        if (triggerParts.size() == 3)
+                        {
+                            core::vector3di triggerPos;
+                            triggerPos.X = str::from_s32(triggerParts[0]);
+                            triggerPos.Y = str::from_s32(triggerParts[1]);
+                            triggerPos.Z = str::from_s32(triggerParts[2]);
+                            tutorialItem.trigger = triggerPos;
+                        }
+                        else
+                        {
+                            WARN << "Invalid trigger in tutorial text: "
+                                 << line;
+                            fail = true;
+                        }
+                    }
+                    else if (parts[0] == "trigger_x")
+                    {
+                        tutorialItem.type = TTT_X;
+                        tutorialItem.trigger.X = str::from_s32(parts[1]);
+                    }
+                    else if (parts[0] == "trigger_y")
+                    {
+                        tutorialItem.type = TTT_Y;
+                        tutorialItem.trigger.Y = str::from_s32(parts[1]);
+                    }
+                    else if (parts[0] == "trigger_z")
+                    {
+                        tutorialItem.type = TTT_Z;
+                        tutorialItem.trigger.Z = str::from_s32(parts[1]);
+                    }
+
+                    // Success! Added a tutorial item.
+                    if (!fail)
+                        tutorialTexts.push_back(tutorialItem);
+
+                    // Reset the text lines for the next tutorial text.
+                    texts.clear();
+
+                    // Reset stuff
+                    displayTime = displayTimeDefault;
+                    delayTime = delayTimeDefault;
+                }
+            }
+        }
+
+        // Just for info, output what was read.
+
+        for (auto &elem : tutorialTexts)
+        {
+            NOTE << "[tutorial item]";
+
+            for (auto &line : elem.lines)
+            {
+                NOTE << "Line: " << line;
             }
 
-            const auto coord = core::vector3di(x, y, z);
+            NOTE << "Will delay for: " << elem.delayTime << " seconds";
+            NOTE << "Will display for: " << elem.displayTime << " seconds";
+
+            NOTE << "Condition: trigger on map location {" << elem.trigger.X
+                 << "," << elem.trigger.Y << "," << elem.trigger.Z << "}";
+        }
+    }
+
+    return tutorialTexts;
+}
+
+void Level::Load(UndoState *undoState, const PreparedLevel *prepared)
+{
+    std::vector<core::vector3di> startPositions;
+
+    if (!undoState) // default, loads from filename
+    {
+        std::vector<UndoState::MapLoc> readContents;
+
+        if (!prepared && !ReadMapContents(fileName, readContents))
+            WARN << "Invalid level file (" << fileName << ")";
+
+        const std::vector<UndoState::MapLoc> &mapContents =
+            prepared ? prepared->mapContents : readContents;
 
+        for (auto &loc : mapContents)
+        {
             // Successfully read a location, so create stuff!
-            CreateObject(coord, (E_OBJECT_TYPE)objectType);
-            CreateEvent(coord, (E_EVENT_TYPE)eventType);
+            CreateObject(loc.coord, (E_OBJECT_TYPE)loc.objectType);
+            CreateEvent(loc.coord, (E_EVENT_TYPE)loc.eventType);
 
             // Special logic for player start events.
-            if (eventType == EET_PLAYER_START_EVENT)
-                startPositions.push_back(coord);
+            if (loc.eventType == EET_PLAYER_START_EVENT)
+                startPositions.push_back(loc.coord);
         }
 
         lowestPointCache[fileName] = lowestPoint;
@@ -2741,7 +2655,7 @@ void Level::Load(UndoState *undoState)
     // Perform optimisations on level...
     // Some ground blocks may be replaced.......
     // Also adds some effects to the level.
-    OptimiseLevel();
+    OptimiseLevel(prepared);
 
     // Randomly position the player...
 
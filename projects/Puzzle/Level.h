@@ -10,6 +10,8 @@
 class Map;
 class IMapEventOwner;
 class MainState;
+class LevelObjectPool;
+struct PreparedLevel;
 class DefaultEvent;
 
 extern bool gridBasedMovement;
@@ -147,6 +149,10 @@ class Level : public IUpdatable, public IWantInput, public IWantEvents
     // (and destruction of this Level instance)
     MainState *mainState;
 
+    // Objects of the previous level to reuse, and where ours go when done.
+    // NULL if there is no MainState.
+    LevelObjectPool *objectPool;
+
     // may differ from global, e.g. if we are in final scene.
     bool localGridBasedMovement;
 
@@ -294,6 +300,11 @@ public:
 
     void PutDebugCube(core::vector3di mapCoord);
 
+    // Get the shared shader used by the Apply...Shaders methods below.
+    IShader *GetHemisphereShader(const c8 *vertexShaderFileName,
+                                 const c8 *pixelShaderFileName,
+                                 video::E_MATERIAL_TYPE baseMaterial);
+
     // Apply the default environment shaders to a mesh.
     void ApplyDefaultShaders(
         IMesh *mesh, video::E_MATERIAL_TYPE baseMaterial = video::EMT_SOLID);
@@ -326,7 +337,8 @@ public:
     void MaybeAddFlower(core::vector3df absPos);
 
     // this also adds some level effects like the fan vortex particle system
-    void OptimiseLevel();
+    // The combined ground mesh is taken from prepared if given.
+    void OptimiseLevel(const PreparedLevel *prepared = nullptr);
 
     void AddFanParticleSystem(core::vector3di mapCoord, f32 height);
 
@@ -335,6 +347,11 @@ public:
 
     void RemoveObject(core::vector3di mapCoord);
 
+    // Removes a map object from the world, or parks it in the object pool if
+    // it can be reused.
+    void ParkOrRemoveObject(ITransformable *object, E_OBJECT_TYPE type);
+    bool CanPark(E_OBJECT_TYPE type);
+
     // Called by Update when the player performs a push action towards a map
     // location Note that this only includes a direct push, and will NOT be
     // called if the player touches a corner of the map coordinate.
@@ -360,8 +377,11 @@ public:
 
     // MainState pointer is now optional (can be NULL), since we may create a
     // level without mainstate existing for preview in start screen.
+    // If the level was read ahead of time by LevelPreparer, the result can be
+    // given as prepared. (only used during construction)
     Level(MainState *mainState, core::stringc fileName,
-          std::deque<UndoState> *undoHistory = nullptr);
+          std::deque<UndoState> *undoHistory = nullptr,
+          const PreparedLevel *prepared = nullptr);
     ~Level();
 
     // used by options menu... for sfx testing...
@@ -400,7 +420,15 @@ public:
     Map *GetMap() { return map; }
 
     void Save();
-    void Load(UndoState *undoState = nullptr);
+    void Load(UndoState *undoState = nullptr,
+              const PreparedLevel *prepared = nullptr);
+
+    // Reading of level files, safe to call from any thread.
+    // The map contents of a level file as an undo state would store them.
+    static bool ReadMapContents(const core::stringc &fileName,
+                                std::vector<UndoState::MapLoc> &mapContents);
+    static std::vector<TutorialText>
+    ReadTutorialTexts(const core::stringc &fileName);
 
     ICharacter *GetPlayer() { return GetPlayerActor().GetCharacter(); }
     IThirdPersonCameraController *GetCamera() { return thirdPersonCamera; }
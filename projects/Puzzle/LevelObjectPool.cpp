@@ -0,0 +1,128 @@
+#include "LevelObjectPool.h"
+#include "ISoundQueue.h"
+
+// Well below anything a level will contain, so parked bodies are never
+// collided with or ray cast against.
+static const core::vector3df PARK_POS(0, -10000, 0);
+
+LevelObjectPool::LevelObjectPool()
+{
+    world = GetEngine()->GetWorld();
+    closed = false;
+}
+
+LevelObjectPool::~LevelObjectPool()
+{
+    Clear();
+}
+
+bool LevelObjectPool::IsPoolable(E_OBJECT_TYPE type)
+{
+    // A reused object keeps everything Level::CreateObject set up when it was
+    // first made, so only types with nothing tied to their map coordinate can
+    // be listed here. New types are not pooled until checked and added.
+    switch (type)
+    {
+    case EOT_GROUND_BLOCK:
+        // Only a body once its mesh is combined, see Level::CanPark.
+        // (otherwise its mesh has UVs adjusted for its coordinate)
+    case EOT_GROUND_BLOCK_FALL:
+    case EOT_MOVABLE_BLOCK:
+    case EOT_SLIDING_BLOCK:
+    case EOT_BALLOON:
+    case EOT_LIFT:
+        return true;
+    case EOT_FAN:
+    case EOT_EXIT_PORTAL:
+        // Blade and teleport mesh rotations are random, not chosen by
+        // coordinate, so the old ones look as good as new ones.
+        return true;
+    default:
+        // The player (which Level looks after itself), or not an object.
+        return false;
+    }
+}
+
+void LevelObjectPool::SetActive(ITransformable *transformable, bool active)
+{
+    if (auto *graphic = dynamic_cast<IVisibleGraphic *>(transformable))
+        graphic->SetVisible(active);
+
+    if (auto *soundSource = dynamic_cast<ISoundSource *>(transformable))
+    {
+        if (active)
+            soundSource->Resume();
+        else
+        {
+            // Anything queued (e.g. lift noises) is finished with.
+            soundSource->GetSoundQueue()->Clear();
+            soundSource->Pause();
+        }
+    }
+
+    // Otherwise the jump to or from the park position looks like motion.
+    if (auto *motionSensor = dynamic_cast<IMotionSensor *>(transformable))
+        motionSensor->Reset();
+
+    for (auto &child : transformable->GetChildren())
+        SetActive(child, active);
+}
+
+void LevelObjectPool::Park(ITransformable *object, E_OBJECT_TYPE type)
+{
+    ASSERT(IsPoolable(type));
+    ASSERT(!closed);
+    ASSERT(!object->GetParent());
+
+    world->SetKept(object, true);
+
+    SetActive(object, false);
+
+    object->SetPosition(PARK_POS);
+    object->ApplyTransformNow();
+
+    parked[type].push_back(object);
+}
+
+ITransformable *LevelObjectPool::Take(E_OBJECT_TYPE type,
+                                      const core::vector3df &pos)
+{
+    if (!IsPoolable(type) || parked[type].empty())
+        return nullptr;
+
+    ITransformable *object = parked[type].back();
+    parked[type].pop_back();
+
+    // Only the object itself is moved. Its children, and so bob animator
+    // start positions and the like, are relative to it and follow it when
+    // ApplyTransformNow positions the whole tree. An animator on the object
+    // itself would be working in world space, at the old position.
+    ASSERT(!object->GetParent());
+    ASSERT(object->GetAnimators().empty());
+
+    world->SetKept(object, false);
+
+    object->SetPosition(pos);
+    object->ApplyTransformNow();
+
+    SetActive(object, true);
+
+    return object;
+}
+
+void LevelObjectPool::Clear()
+{
+    for (auto &objects : parked)
+    {
+        for (auto &object : objects)
+            world->RemoveTransformable(object);
+
+        objects.clear();
+    }
+}
+
+void LevelObjectPool::Close()
+{
+    Clear();
+    closed = true;
+}
@@ -0,0 +1,45 @@
+#ifndef LEVEL_OBJECT_POOL_H
+#define LEVEL_OBJECT_POOL_H
+
+#include "Litha.h"
+#include "Enums.h"
+#include <vector>
+
+// Map objects left over from a level that has been torn down, kept so that
+// the next level (restart, undo or the next one) can reuse them rather than
+// creating every mesh, body, animator and sound source again.
+// Parked objects are kept by the world (see IWorld::SetKept) so not updated
+// or drawn, and are also hidden, silent and far away.
+// Reference counted since both MainState and any Level using it hold it.
+class LevelObjectPool : public virtual IReferenceCounted
+{
+    IWorld *world;
+
+    std::vector<ITransformable *> parked[EOT_COUNT];
+    bool closed;
+
+    void SetActive(ITransformable *transformable, bool active);
+
+public:
+    LevelObjectPool();
+    ~LevelObjectPool();
+
+    // Whether objects of this type can be parked and reused.
+    static bool IsPoolable(E_OBJECT_TYPE type);
+
+    // Hide the object away for reuse. It must be a root object, not a child.
+    void Park(ITransformable *object, E_OBJECT_TYPE type);
+
+    // A parked object of this type moved to pos, or NULL if there are none.
+    // The world owns it again as before it was parked.
+    ITransformable *Take(E_OBJECT_TYPE type, const core::vector3df &pos);
+
+    // Remove everything parked from the world.
+    void Clear();
+
+    // Clear, and take nothing more. For when the world may be going away.
+    void Close();
+    bool IsClosed() { return closed; }
+};
+
+#endif
@@ -0,0 +1,225 @@
+#include "LevelPreparer.h"
+#include <set>
+#include <tuple>
+
+bool GroundMeshSource::Load(scene::ISceneManager *smgr,
+                            const io::path &meshName)
+{
+    buffers.clear();
+
+    scene::IAnimatedMesh *animatedMesh = smgr->getMesh(meshName);
+
+    if (!animatedMesh || !animatedMesh->getMesh(0))
+    {
+        WARN << "Could not load ground mesh (" << meshName << ")";
+        return false;
+    }
+
+    scene::IMesh *mesh = animatedMesh->getMesh(0);
+
+    for (u32 i = 0; i < mesh->getMeshBufferCount(); i++)
+    {
+        scene::IMeshBuffer *mb = mesh->getMeshBuffer(i);
+
+        ASSERT(mb->getVertexType() == video::EVT_STANDARD);
+        ASSERT(mb->getIndexType() == video::EIT_16BIT);
+
+        Buffer buffer;
+
+        const auto *vertices = (const video::S3DVertex *)mb->getVertices();
+        buffer.vertices.assign(vertices, vertices + mb->getVertexCount());
+        buffer.indices.assign(mb->getIndices(),
+                              mb->getIndices() + mb->getIndexCount());
+
+        video::ITexture *texture = mb->getMaterial().TextureLayer[0].Texture;
+
+        if (texture)
+            buffer.textureName = os::path::basename(texture->getName());
+
+        buffers.push_back(buffer);
+    }
+
+    return true;
+}
+
+// Ground textures are scaled and offset by position to avoid ugly repetition.
+// (what formerly had to be done via the texture matrix)
+static void adjust_ground_uvs(video::S3DVertex *vertices, u32 count,
+                              const io::path &textureName, core::vector3df pos)
+{
+    const f32 scale = 3.f;
+    core::vector2df offset;
+
+    if (textureName == "mud_front.jpg")
+        offset.set(pos.Y, pos.X);
+    else if (textureName == "mud_back.jpg")
+        offset.set(-pos.Y, pos.X);
+    else if (textureName == "grass1_lighter.jpg")
+        offset.set(pos.X, -pos.Z);
+    else if (textureName == "mud_bottom.jpg")
+        offset.set(-pos.Z, pos.X);
+    else if (textureName == "mud_right.jpg")
+        offset.set(pos.Y, pos.Z);
+    else if (textureName == "mud_left.jpg")
+        offset.set(pos.Y, -pos.Z);
+    else
+        FAIL << "texture not handled...";
+
+    for (u32 i = 0; i < count; i++)
+    {
+        vertices[i].TCoords *= 1.f / scale;
+        vertices[i].TCoords += offset / scale;
+    }
+}
+
+static void append(std::vector<video::S3DVertex> &vertices,
+                   std::vector<u16> &indices,
+                   const GroundMeshSource::Buffer &buffer,
+                   core::vector3df pos)
+{
+    u32 first = vertices.size();
+
+    vertices.insert(vertices.end(), buffer.vertices.begin(),
+                    buffer.vertices.end());
+
+    // Ground blocks are never rotated, so moving them is enough.
+    for (u32 i = first; i < vertices.size(); i++)
+        vertices[i].Pos += pos;
+
+    adjust_ground_uvs(&vertices[first], buffer.vertices.size(),
+                      buffer.textureName, pos);
+
+    for (u16 index : buffer.indices)
+        indices.push_back(index + first);
+}
+
+void GroundMesh::Build(const std::vector<core::vector3di> &groundBlocks,
+                       const GroundMeshSource &single,
+                       const GroundMeshSource &sideless)
+{
+    grassVertices.clear();
+    grassIndices.clear();
+    mudVertices.clear();
+    mudIndices.clear();
+
+    std::set<std::tuple<s32, s32, s32>> occupied;
+
+    for (auto &coord : groundBlocks)
+        occupied.insert(std::make_tuple(coord.X, coord.Y, coord.Z));
+
+    // Adjacent 4 map coordinates (in cross shape)
+    const core::vector3di cross[] = {
+        core::vector3di(1, 0, 0), core::vector3di(-1, 0, 0),
+        core::vector3di(0, 0, 1), core::vector3di(0, 0, -1)};
+
+    for (auto &coord : groundBlocks)
+    {
+        bool surrounded = true;
+
+        for (auto &offset : cross)
+        {
+            core::vector3di other = coord + offset;
+
+            if (!occupied.count(std::make_tuple(other.X, other.Y, other.Z)))
+            {
+                surrounded = false;
+                break;
+            }
+        }
+
+        const GroundMeshSource &source = surrounded ? sideless : single;
+        core::vector3df pos(coord.X, coord.Y, coord.Z);
+
+        for (auto &buffer : source.buffers)
+        {
+            if (buffer.textureName == "grass1_lighter.jpg")
+                append(grassVertices, grassIndices, buffer, pos);
+            else
+                append(mudVertices, mudIndices, buffer, pos);
+        }
+    }
+}
+
+LevelPreparer::LevelPreparer()
+{
+    haveSources = false;
+    finished = false;
+    prepared = nullptr;
+}
+
+LevelPreparer::~LevelPreparer()
+{
+    Clear();
+}
+
+void LevelPreparer::Run()
+{
+    PROFILE_ZONE("LevelPreparer::Run");
+
+    if (!Level::ReadMapContents(prepared->fileName, prepared->mapContents))
+        WARN << "Invalid level file (" << prepared->fileName << ")";
+
+    prepared->tutorialTexts = Level::ReadTutorialTexts(prepared->fileName);
+
+    std::vector<core::vector3di> groundBlocks;
+
+    for (auto &loc : prepared->mapContents)
+    {
+        if ((E_OBJECT_TYPE)loc.objectType == EOT_GROUND_BLOCK)
+            groundBlocks.push_back(loc.coord);
+    }
+
+    prepared->groundMesh.Build(groundBlocks, groundSingle, groundSideless);
+
+    finished = true;
+}
+
+void LevelPreparer::Prepare(const core::stringc &fileName)
+{
+    Clear();
+
+    // Irrlicht's mesh cache is only used from here, on the main thread.
+    if (!haveSources)
+    {
+        scene::ISceneManager *smgr =
+            GetEngine()->GetIrrlichtDevice()->getSceneManager();
+
+        haveSources = groundSingle.Load(smgr, "ground_single.b3d") &&
+                      groundSideless.Load(smgr, "ground_single_sideless.b3d");
+
+        if (!haveSources)
+            return;
+    }
+
+    NOTE << "Preparing level in the background (" << fileName << ")";
+
+    prepared = new PreparedLevel();
+    prepared->fileName = fileName;
+
+    finished = false;
+    thread = std::thread(&LevelPreparer::Run, this);
+}
+
+PreparedLevel *LevelPreparer::Take(const core::stringc &fileName)
+{
+    if (!prepared || prepared->fileName != fileName)
+        return nullptr;
+
+    if (!finished)
+        NOTE << "Waiting for level to finish preparing (" << fileName << ")";
+
+    thread.join();
+
+    PreparedLevel *result = prepared;
+    prepared = nullptr;
+    return result;
+}
+
+void LevelPreparer::Clear()
+{
+    if (thread.joinable())
+        thread.join();
+
+    delete prepared;
+    prepared = nullptr;
+}
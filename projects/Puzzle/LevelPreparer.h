@@ -0,0 +1,86 @@
+#ifndef LEVEL_PREPARER_H
+#define LEVEL_PREPARER_H
+
+#include "Litha.h"
+#include "Level.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Geometry of a ground block mesh, copied out of Irrlicht so that it can be
+// read from another thread.
+struct GroundMeshSource
+{
+    struct Buffer
+    {
+        std::vector<video::S3DVertex> vertices;
+        std::vector<u16> indices;
+        io::path textureName;
+    };
+
+    std::vector<Buffer> buffers;
+
+    bool Load(scene::ISceneManager *smgr, const io::path &meshName);
+};
+
+// All ground blocks of a level merged into two buffers, grass and mud, ready
+// to be copied into Irrlicht mesh buffers.
+struct GroundMesh
+{
+    std::vector<video::S3DVertex> grassVertices;
+    std::vector<u16> grassIndices;
+    std::vector<video::S3DVertex> mudVertices;
+    std::vector<u16> mudIndices;
+
+    // Blocks surrounded by others use the sideless mesh.
+    void Build(const std::vector<core::vector3di> &groundBlocks,
+               const GroundMeshSource &single,
+               const GroundMeshSource &sideless);
+};
+
+// Everything about a level that can be worked out without touching Irrlicht
+// or ODE.
+struct PreparedLevel
+{
+    core::stringc fileName;
+
+    std::vector<UndoState::MapLoc> mapContents;
+    std::vector<TutorialText> tutorialTexts;
+    GroundMesh groundMesh;
+};
+
+// Reads and prepares a level on a worker thread, so that it is ready by the
+// time it is started. Used for the next level while the end of level screen
+// shows; the main thread is then left with creating the scene nodes and
+// bodies and uploading the ground mesh.
+class LevelPreparer
+{
+    GroundMeshSource groundSingle;
+    GroundMeshSource groundSideless;
+    bool haveSources;
+
+    std::thread thread;
+    std::atomic<bool> finished;
+    PreparedLevel *prepared;
+
+    void Run();
+
+public:
+    LevelPreparer();
+    ~LevelPreparer();
+
+    // Starts preparing a level, replacing anything prepared before.
+    // fileName is the full path as given to Level.
+    void Prepare(const core::stringc &fileName);
+
+    bool IsFinished() const { return finished; }
+
+    // The prepared level, if it is fileName, otherwise NULL. Waits for it if
+    // it is still being prepared. The caller must delete it.
+    PreparedLevel *Take(const core::stringc &fileName);
+
+    // Throw away anything prepared.
+    void Clear();
+};
+
+#endif
@@ -1,6 +1,8 @@
 
 #include "MainState.h"
 #include "Level.h"
+#include "LevelPreparer.h"
+#include "LevelObjectPool.h"
 #include "Editor.h"
 #include "get_lines.h"
 #include "Positioner.h"
@@ -280,6 +282,9 @@ MainState::MainState(MainState **mainStatePtrLoc)
     level = nullptr;
     editor = nullptr;
 
+    levelPreparer = new LevelPreparer();
+    objectPool = new LevelObjectPool();
+
     engine->GetLogicUpdater().AddUpdatable(this, false);
 
     nextLevel = false;
@@ -324,6 +329,16 @@ MainState::~MainState()
 
     menuSound->drop();
     delete pauseMenuPositioner;
+    delete levelPreparer;
+
+    // The level parks its objects as it goes, so it must go while the world
+    // is still here. Then the pool is emptied too, in case something else
+    // still holds the level (it then removes rather than parks).
+    RemoveLevelAndEditor();
+    objectPool->Close();
+
+    // May live on a little longer if a Level still holds it.
+    objectPool->drop();
 
     engine->UnregisterAllEventInterest(this);
 
@@ -491,8 +506,16 @@ void MainState::StartLevel(core::stringc levelFileName, bool startEditor,
     }
     */
 
-    level = new Level(this, level_path_rel_exe(levelFileName), undoHistory);
+    // Probably read while the end of the last level was showing.
+    // (undo states replace what is in the file)
+    core::stringc levelPath = level_path_rel_exe(levelFileName);
+    PreparedLevel *prepared =
+        undoHistory ? nullptr : levelPreparer->Take(levelPath);
+
+    level = new Level(this, levelPath, undoHistory, prepared);
     world->GetUpdater().AddUpdatable(level);
+
+    delete prepared;
     level->Start();
     level->drop();
 
@@ -859,6 +882,23 @@ void MainState::StartFirstLevel()
     }
 }
 
+void MainState::PrepareNextLevel()
+{
+    if (!level)
+        return;
+
+    core::stringc currentLevelFileName = GetCurrentLevelName();
+
+    for (u32 i = 0; i + 1 < levelFileNames.size(); i++)
+    {
+        if (levelFileNames[i] == currentLevelFileName)
+        {
+            levelPreparer->Prepare(level_path_rel_exe(levelFileNames[i + 1]));
+            return;
+        }
+    }
+}
+
 void MainState::NextLevel(bool wait)
 {
     if (wait)
@@ -18,6 +18,8 @@ gui::IGUIStaticText *add_static_text2(const wchar_t *str);
 gui::IGUIStaticText *add_static_text(const wchar_t *str);
 
 class Level;
+class LevelPreparer;
+class LevelObjectPool;
 class Editor;
 struct UndoState;
 
@@ -32,6 +34,12 @@ class MainState : public IUpdatable, public IWantEvents
     Level *level;
     Editor *editor;
 
+    // Reads the next level in the background.
+    LevelPreparer *levelPreparer;
+
+    // Objects of torn down levels, for reuse by the next.
+    LevelObjectPool *objectPool;
+
     ISound2D *menuSound;
 
     bool nextLevel;
@@ -140,6 +148,13 @@ public:
     // since level should not destruct itself!)
     void NextLevel(bool wait = false);
 
+    // Start reading the level after the current one in the background, so
+    // that NextLevel has less to do. Called when the end of level screen is
+    // shown.
+    void PrepareNextLevel();
+
+    LevelObjectPool *GetObjectPool() { return objectPool; }
+
     // Restart the currently playing level.
     // (e.g. on player death, suicide)
 
@@ -144,6 +144,10 @@ int main(int argc, const char **argv)
         loadingGUI->remove();
     }
 
+    // Compile all shaders now rather than part way through loading a level.
+    renderSystem->PreloadShaders(paths::get_media_dir() +
+                                 "/shaders/shaders.manifest");
+
     // Set up post processing.
     if (renderSystem->ShadersAreAvailable() &&
         renderSystem->PostProcessingEnabled())
@@ -310,55 +314,10 @@ int main(int argc, const char **argv)
     }
 
     // Sounds
-    {
-        ISoundSystem *soundSystem = engine->GetSoundSystem();
-        soundSystem->PreloadSound(paths::get_sfx("sea.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("beep.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("fallblock.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("buttonflutter_micro.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("hithard.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("liftrun.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("balloonpush.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("slide.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("windy.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("bell.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("stepballoon.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("step.ogg"));
-
-        soundSystem->PreloadSound(paths::get_sfx("appear.ogg"));
-
-        soundSystem->PreloadSound(paths::get_sfx("laugh.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("fair.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("good.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("excellent.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("perfect.ogg"));
-        soundSystem->PreloadSound(paths::get_sfx("extraordinary.ogg"));
-
-        // soundSystem->PreloadSound(paths::get_sfx("music.ogg"));
-    }
-
-    // Shaders!?
-    /*
-    if (renderSystem->ShadersAreAvailable())
-    {
-        IShader *shader;
-
-        shader = renderSystem->CreateShader("Hemisphere.vert",
-    "Hemisphere.frag", video::EMT_SOLID); shader->drop();
-
-        shader = renderSystem->CreateShader("HemisphereBalloon.vert",
-    "HemisphereBalloon.frag", video::EMT_SOLID); shader->drop();
-
-        shader = renderSystem->CreateShader("HemisphereLand.vert",
-    "Hemisphere.frag", video::EMT_SOLID); shader->drop();
-
-        shader = renderSystem->CreateShader("Hemisphere.vert",
-    "HemisphereWood.frag", video::EMT_SOLID); shader->drop();
-
-        shader = renderSystem->CreateShader("PlainWithAlpha.vert",
-    "PlainWithAlpha.frag", video::EMT_SOLID); shader->drop();
-    }
-    */
+    // Decoded in the background, while the first level loads.
+    // (long ambience like sea.ogg is streamed so isn't listed)
+    engine->GetSoundSystem()->PreloadSoundBank(
+        paths::get_sfx("sounds.manifest"));
 
     NOTE << "Finished preloading!";
 
@@ -0,0 +1,175 @@
+#include "Litha.h"
+#include "SoftwareSoundSystem.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+// Replays the sound workload of a busy level without a window or a sound
+// device, and reports what the audio costs: decoding, mixing and how many
+// sounds were playing. The mix can be written to a WAV file to listen to.
+// Usage: litha-soundbench <sfx dir> [seconds] [output.wav]
+
+// Roughly what a large level has going on.
+static const u32 FAN_COUNT = 12;
+static const u32 LIFT_COUNT = 4;
+static const f32 STEP_INTERVAL = 0.35f;
+static const f32 LIFT_INTERVAL = 3.f;
+static const f32 LIFT_RUN_TIME = 2.f;
+static const f32 END_OF_LEVEL_INTERVAL = 20.f;
+
+static f64 ms_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<f64, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+int main(int argc, const char **argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <sfx dir> [seconds] [output.wav]\n", argv[0]);
+        return 1;
+    }
+
+    io::path sfxDir = argv[1];
+    f32 seconds = argc > 2 ? atof(argv[2]) : 60.f;
+
+    VariantMap settings;
+    settings["appName"] = "Litha Sound Bench";
+    settings["headless"] = true;
+
+    if (argc > 3)
+    {
+        settings["soundSystem"] = "wav";
+        settings["soundOutputFile"] = argv[3];
+    }
+    else
+        settings["soundSystem"] = "null";
+
+    IEngine *engine = CreateEngine(argc, argv, &settings);
+    IWorld *world = engine->GetWorld();
+    ISoundSystem *soundSystem = engine->GetSoundSystem();
+
+    auto *software = dynamic_cast<SoftwareSoundSystem *>(soundSystem);
+    ASSERT(software);
+
+    // Joined as paths::get_sfx does, like the game's sound names.
+    auto sfx = [&](const c8 *name)
+    { return core::stringc(sfxDir) + "/" + name; };
+
+    // Preload, as a level load would.
+    auto start = std::chrono::steady_clock::now();
+
+    soundSystem->PreloadSoundBank(sfx("sounds.manifest"));
+
+    while (soundSystem->GetPreloadProgress() < 1.f)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    f64 preloadMs = ms_since(start);
+
+    soundSystem->SetListenerPosition(core::vector3df(0, 5, -10));
+    soundSystem->SetListenerOrientation(core::vector3df(0, 0, 1),
+                                        core::vector3df(0, 1, 0));
+
+    // Fans, looping quietly the whole time.
+    for (u32 i = 0; i < FAN_COUNT; i++)
+    {
+        ISoundSource *source = world->AddSoundSource();
+        source->SetPosition(core::vector3df((s32)(i % 4) * 4 - 6, 0,
+                                            (s32)(i / 4) * 4));
+
+        ISound3D *sound = source->GetSound();
+        sound->SetVolume(0.5f);
+        sound->SetPriority(-1);
+        sound->SetIsLooped(true);
+        sound->Play(sfx("buttonflutter_micro.ogg"));
+    }
+
+    // Lifts, queued like SoundMotionCallback does.
+    std::vector<ISoundQueue *> lifts;
+
+    for (u32 i = 0; i < LIFT_COUNT; i++)
+    {
+        ISoundSource *source = world->AddSoundSource();
+        source->SetPosition(core::vector3df((s32)i * 5 - 8, 2, 6));
+        lifts.push_back(source->GetSoundQueue());
+    }
+
+    ISound2D *footStep = soundSystem->CreateSound2D();
+    ISoundQueue *endOfLevel = soundSystem->CreateSoundQueue();
+
+    IUpdater &updater = engine->GetLogicUpdater();
+    const f32 dt = 0.01f;
+    f32 t = 0.f;
+    f32 nextStep = 0.f;
+    f32 nextEndOfLevel = END_OF_LEVEL_INTERVAL;
+    std::vector<f32> liftStarted(LIFT_COUNT, -1.f);
+    u32 ticks = 0;
+
+    start = std::chrono::steady_clock::now();
+
+    while (t < seconds)
+    {
+        // Lifts take turns to start, and stop after a while.
+        for (u32 i = 0; i < LIFT_COUNT; i++)
+        {
+            f32 offset = LIFT_INTERVAL * i / LIFT_COUNT;
+            f32 phase = fmod(t + offset, LIFT_INTERVAL * 2);
+
+            if (liftStarted[i] < 0.f && phase < dt)
+            {
+                lifts[i]->Add3D(sfx("hithard.ogg").c_str(),
+                                ESF_ENQUEUE | ESF_NO_WAIT);
+                lifts[i]->Add3D(sfx("liftrun.ogg").c_str(),
+                                ESF_ENQUEUE | ESF_LOOP | ESF_UNTIL_NEXT);
+                liftStarted[i] = t;
+            }
+            else if (liftStarted[i] >= 0.f &&
+                     t - liftStarted[i] > LIFT_RUN_TIME)
+            {
+                lifts[i]->Add3D(sfx("hithard.ogg").c_str(),
+                                ESF_ENQUEUE | ESF_NO_WAIT);
+                liftStarted[i] = -1.f;
+            }
+        }
+
+        if (t >= nextStep)
+        {
+            footStep->Play(sfx("step.ogg"));
+            nextStep += STEP_INTERVAL;
+        }
+
+        if (t >= nextEndOfLevel)
+        {
+            endOfLevel->Add2D(sfx("appear.ogg").c_str(), ESF_ENQUEUE);
+            endOfLevel->Add2D(sfx("good.ogg").c_str(), ESF_ENQUEUE);
+            endOfLevel->Add2D(sfx("bell.ogg").c_str(), ESF_ENQUEUE);
+            nextEndOfLevel += END_OF_LEVEL_INTERVAL;
+        }
+
+        t += dt;
+        updater.UpdateAllUpdatables(t, dt);
+        ticks++;
+    }
+
+    f64 runMs = ms_since(start);
+    const SoftwareSoundStats &stats = software->GetStats();
+
+    printf("Simulated %.1fs of sound in %.1fms (%.0fx realtime), %u ticks\n",
+           seconds, runMs, seconds * 1000.0 / runMs, ticks);
+    printf("Preload: %.1fms, %.1fKB of sound\n", preloadMs,
+           soundSystem->GetSoundMemoryUsage() / 1024.f);
+    printf("Decode on play: %.2fms\n", stats.decodeMs);
+    printf("Mix: %.2fms for %u frames (%.3fms per tick)\n", stats.mixMs,
+           stats.framesMixed, stats.mixMs / ticks);
+    printf("Voices mixed: %u peak (max %u), playing: %u peak\n",
+           stats.peakVoices, SoftwareSoundSystem::MAX_VOICES,
+           stats.peakActiveSounds);
+
+    footStep->drop();
+    endOfLevel->drop();
+    engine->drop();
+    return 0;
+}
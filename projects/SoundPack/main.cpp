@@ -0,0 +1,81 @@
+#include "Litha.h"
+#include "SoundArchive.h"
+#include "SoundBank.h"
+#include "SoundSystem.h"
+#include <cstdlib>
+
+// Decodes the short sounds listed in a sound manifest and packs them into a
+// sound archive (see SoundArchive), so that the game can load them without
+// decoding anything. Sounds longer than max seconds (music) are left out, they
+// are streamed instead.
+// The archive is written beside the manifest, where the game looks for it,
+// unless another archive file is given.
+// Usage: litha-soundpack <sound manifest> [max seconds] [archive file]
+
+int main(int argc, const char **argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <sound manifest> [max seconds] [archive file]\n",
+               argv[0]);
+        return 1;
+    }
+
+    io::path manifestFile = argv[1];
+    f32 maxSeconds = argc > 2 ? atof(argv[2]) : 10.f;
+
+    std::vector<core::stringc> manifest =
+        SoundSystem::ReadManifest(manifestFile);
+
+    if (!manifest.size())
+    {
+        printf("Could not read sound manifest \"%s\"\n", manifestFile.c_str());
+        return 1;
+    }
+
+    io::path dir = os::path::dirname(manifestFile);
+
+    std::vector<core::stringc> names;
+    std::vector<DecodedSound> decoded;
+    u32 bytes = 0;
+
+    for (auto &name : manifest)
+    {
+        DecodedSound sound;
+
+        if (SoundBank::Decode(SoundBank::JoinPath(dir, name), sound) !=
+            SoundBank::EDR_DECODED)
+        {
+            printf("Could not decode \"%s\"\n", name.c_str());
+            return 1;
+        }
+
+        f32 seconds = (f32)sound.GetFrameCount() / (f32)sound.sampleRate;
+
+        if (seconds > maxSeconds)
+        {
+            printf("Skipped \"%s\" (%.1fs, will be streamed)\n", name.c_str(),
+                   seconds);
+            continue;
+        }
+
+        bytes += sound.GetByteCount();
+        names.push_back(name);
+        decoded.push_back(std::move(sound));
+    }
+
+    io::path archiveFile = argc > 3
+                               ? io::path(argv[3])
+                               : SoundArchive::GetPathForManifest(manifestFile);
+
+    if (!SoundArchive::Write(archiveFile, names, decoded))
+    {
+        printf("Could not write \"%s\"\n", archiveFile.c_str());
+        return 1;
+    }
+
+    printf("Packed %u sounds (%u KB) into \"%s\"\n", (u32)names.size(),
+           bytes / 1024, archiveFile.c_str());
+
+    return 0;
+}
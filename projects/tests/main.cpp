@@ -1,5 +1,13 @@
 
 #include "Litha.h"
+#include "ShaderConstants.h"
+#include "DynamicResolution.h"
+#include "SoundSystem.h"
+#include "utils/paths.h"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <thread>
 
 // A very basic test system, simply using ASSERT.
 // So as soon as one assertion fails, the tests will stop.
@@ -8,12 +16,17 @@
 int main(int argc, const char **argv)
 {
     utils::log::setfile("tests.log");
-    NOTE("RUNNING TESTS...");
+    NOTE << "RUNNING TESTS...";
 
 #include "test_str.h"
 #include "test_Variant.h"
+#include "test_IndexedSet.h"
+#include "test_RingBuffer.h"
+#include "test_ShaderConstants.h"
+#include "test_DynamicResolution.h"
+#include "test_SoundBank.h"
 
-    NOTE("All tests passed!");
+    NOTE << "All tests passed!";
 
     return 0;
 }
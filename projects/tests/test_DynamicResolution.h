@@ -0,0 +1,39 @@
+{
+    NOTE << "Testing DynamicResolution";
+
+    DynamicResolution dynres;
+    dynres.SetParams(16.f, 0.5f, 1.f);
+    ASSERT(dynres.GetScale() == 1.f);
+
+    // On target, no change
+    for (u32 i = 0; i < 100; i++)
+        dynres.AddFrameTime(16.f);
+
+    ASSERT(dynres.GetScale() == 1.f);
+
+    // Too slow, scales down but not below the minimum
+    for (u32 i = 0; i < 20; i++)
+        dynres.AddFrameTime(32.f);
+
+    f32 lowered = dynres.GetScale();
+    ASSERT(lowered < 1.f && lowered >= 0.5f);
+
+    for (u32 i = 0; i < 1000; i++)
+        dynres.AddFrameTime(32.f);
+
+    ASSERT(dynres.GetScale() == 0.5f);
+    ASSERT(dynres.GetSize(core::dimension2du(800, 600)) ==
+           core::dimension2du(400, 300));
+
+    // Only slightly faster than the target, stays put
+    for (u32 i = 0; i < 1000; i++)
+        dynres.AddFrameTime(15.f);
+
+    ASSERT(dynres.GetScale() == 0.5f);
+
+    // Lots of time spare, recovers to the maximum
+    for (u32 i = 0; i < 1000; i++)
+        dynres.AddFrameTime(4.f);
+
+    ASSERT(dynres.GetScale() == 1.f);
+}
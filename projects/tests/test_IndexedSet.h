@@ -0,0 +1,104 @@
+
+{
+    NOTE << "Testing utils::IndexedSet";
+
+    // Basic set behaviour
+    {
+        IndexedSet<s32> set;
+        ASSERT(set.Insert(1));
+        ASSERT(set.Insert(2));
+        ASSERT(set.Insert(3));
+        ASSERT(!set.Insert(2));
+        ASSERT(set.size() == 3);
+        ASSERT(set.Contains(3));
+        ASSERT(!set.Contains(4));
+
+        // Remove keeps order
+        ASSERT(set.Remove(1));
+        ASSERT(!set.Remove(1));
+        ASSERT(set.size() == 2);
+        ASSERT(set[0] == 2);
+        ASSERT(set[1] == 3);
+        ASSERT(set.Contains(2));
+        ASSERT(set.Contains(3));
+
+        // SwapRemove moves the last element into the gap
+        ASSERT(set.Insert(4));
+        ASSERT(set.SwapRemove(2));
+        ASSERT(set.size() == 2);
+        ASSERT(set[0] == 4);
+        ASSERT(set[1] == 3);
+        ASSERT(set.Contains(4));
+        ASSERT(!set.Contains(2));
+
+        set.clear();
+        ASSERT(set.size() == 0);
+        ASSERT(!set.Contains(3));
+    }
+
+    // Union
+    {
+        IndexedSet<s32> a;
+        a.Insert(1);
+        a.Insert(2);
+
+        Set<s32> b;
+        b.Insert(2);
+        b.Insert(3);
+
+        ASSERT(a.Union(b));
+        ASSERT(!a.Union(b));
+        ASSERT(a.size() == 3);
+        ASSERT(a.Contains(3));
+    }
+
+    // Add and remove 10k transformables, as World does
+    {
+        const u32 count = 10000;
+        std::vector<ITransformable *> transformables;
+
+        for (u32 i = 0; i < count; i++)
+            transformables.push_back(new ITransformable());
+
+        auto start = std::chrono::steady_clock::now();
+
+        IndexedSet<ITransformable *> indexed;
+
+        for (auto &elem : transformables)
+            ASSERT(indexed.Insert(elem));
+
+        for (auto &elem : transformables)
+            ASSERT(indexed.Contains(elem));
+
+        for (auto &elem : transformables)
+            ASSERT(indexed.SwapRemove(elem));
+
+        ASSERT(indexed.size() == 0);
+
+        auto mid = std::chrono::steady_clock::now();
+
+        Set<ITransformable *> linear;
+
+        for (auto &elem : transformables)
+            ASSERT(linear.Insert(elem));
+
+        for (auto &elem : transformables)
+            ASSERT(linear.Contains(elem));
+
+        for (auto &elem : transformables)
+            ASSERT(linear.SwapRemove(elem));
+
+        ASSERT(linear.size() == 0);
+
+        auto end = std::chrono::steady_clock::now();
+
+        NOTE << "10k transformables add/contains/remove, IndexedSet: "
+             << (f32)std::chrono::duration<f64, std::milli>(mid - start).count()
+             << "ms, Set: "
+             << (f32)std::chrono::duration<f64, std::milli>(end - mid).count()
+             << "ms";
+
+        for (auto &elem : transformables)
+            elem->drop();
+    }
+}
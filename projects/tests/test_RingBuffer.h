@@ -0,0 +1,45 @@
+{
+    NOTE << "Testing utils::RingBuffer";
+
+    RingBuffer<s32> ring;
+    ASSERT(ring.empty());
+
+    // Wraps around without growing
+    for (s32 i = 0; i < 6; i++)
+        ring.PushBack(i);
+
+    for (s32 i = 0; i < 4; i++)
+        ring.PopFront();
+
+    for (s32 i = 6; i < 12; i++)
+        ring.PushBack(i);
+
+    ASSERT(ring.size() == 8);
+    ASSERT(ring.Front() == 4);
+    ASSERT(ring.Back() == 11);
+
+    for (u32 i = 0; i < ring.size(); i++)
+        ASSERT(ring[i] == (s32)i + 4);
+
+    // Grows, keeping the order
+    for (s32 i = 12; i < 40; i++)
+        ring.PushBack(i);
+
+    ASSERT(ring.size() == 36);
+
+    ring.PopBack();
+    ASSERT(ring.Back() == 38);
+    ring.PushBack(39);
+
+    for (s32 i = 4; i < 40; i++)
+    {
+        ASSERT(ring.Front() == i);
+        ring.PopFront();
+    }
+
+    ASSERT(ring.empty());
+
+    ring.PushBack(1);
+    ring.clear();
+    ASSERT(ring.size() == 0);
+}
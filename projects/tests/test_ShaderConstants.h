@@ -0,0 +1,276 @@
+{
+    NOTE << "Testing ShaderConstants";
+
+    // Stands in for the GPU program, counting what gets sent to it.
+    class MockServices : public video::IMaterialRendererServices
+    {
+        s32 Find(const c8 *name)
+        {
+            lookups++;
+
+            for (u32 i = 0; i < names.size(); i++)
+            {
+                if (names[i] == name)
+                    return i;
+            }
+
+            return -1;
+        }
+
+        bool Upload(s32 index, int count)
+        {
+            if (index == -1)
+                return false;
+
+            uploads++;
+            floatsUploaded += count;
+            return true;
+        }
+
+    public:
+        // Constants used by the program
+        std::vector<core::stringc> names;
+
+        u32 lookups = 0;
+        u32 uploads = 0;
+        u32 floatsUploaded = 0;
+
+        s32 lastStartRegister = -1;
+        s32 lastRegisterCount = 0;
+
+        void setBasicRenderStates(const video::SMaterial &material,
+                                  const video::SMaterial &lastMaterial,
+                                  bool resetAllRenderstates) override
+        {
+        }
+
+#if LITHA_SHADER_CONSTANT_IDS
+        s32 getVertexShaderConstantID(const c8 *name) override
+        {
+            return Find(name);
+        }
+
+        s32 getPixelShaderConstantID(const c8 *name) override
+        {
+            return Find(name);
+        }
+
+        bool setVertexShaderConstant(s32 index, const f32 *floats,
+                                     int count) override
+        {
+            return Upload(index, count);
+        }
+
+        bool setVertexShaderConstant(s32 index, const s32 *ints,
+                                     int count) override
+        {
+            return Upload(index, count);
+        }
+
+        bool setPixelShaderConstant(s32 index, const f32 *floats,
+                                    int count) override
+        {
+            return Upload(index, count);
+        }
+
+        bool setPixelShaderConstant(s32 index, const s32 *ints,
+                                    int count) override
+        {
+            return Upload(index, count);
+        }
+#else
+        bool setVertexShaderConstant(const c8 *name, const f32 *floats,
+                                     int count) override
+        {
+            return Upload(Find(name), count);
+        }
+
+        bool setPixelShaderConstant(const c8 *name, const f32 *floats,
+                                    int count) override
+        {
+            return Upload(Find(name), count);
+        }
+#endif
+
+        void setVertexShaderConstant(const f32 *data, s32 startRegister,
+                                     s32 constantAmount) override
+        {
+            Upload(0, constantAmount * 4);
+            lastStartRegister = startRegister;
+            lastRegisterCount = constantAmount;
+        }
+
+        void setPixelShaderConstant(const f32 *data, s32 startRegister,
+                                    s32 constantAmount) override
+        {
+            Upload(0, constantAmount * 4);
+            lastStartRegister = startRegister;
+            lastRegisterCount = constantAmount;
+        }
+
+        video::IVideoDriver *getVideoDriver() override { return nullptr; }
+    };
+
+    core::matrix4 world;
+    f32 time = 1.f;
+    f32 fogColour[4] = {0.5f, 0.6f, 0.7f, 1.f};
+
+    // Only changed constants are uploaded
+    {
+        MockServices services;
+        services.names.push_back("TransWorldMatrix");
+        services.names.push_back("timeSeconds");
+        services.names.push_back("fogColour");
+
+        ShaderConstants constants;
+        constants.Set("TransWorldMatrix", false, world.pointer(), 16);
+        constants.Set("timeSeconds", false, &time, 1);
+        constants.Set("fogColour", true, fogColour, 4);
+        constants.Set("notInProgram", true, &time, 1);
+
+        constants.UploadHighLevel(&services, false);
+        ASSERT(services.uploads == 3);
+        ASSERT(services.floatsUploaded == 21);
+
+        // Same values again, nothing to do
+        constants.Set("timeSeconds", false, &time, 1);
+        constants.UploadHighLevel(&services, false);
+        ASSERT(services.uploads == 3);
+
+        f32 later = 2.f;
+        constants.Set("timeSeconds", false, &later, 1);
+        constants.UploadHighLevel(&services, false);
+        ASSERT(services.uploads == 4);
+        ASSERT(services.floatsUploaded == 22);
+
+        // Another set of constants used the program
+        constants.UploadHighLevel(&services, true);
+        ASSERT(services.uploads == 7);
+
+        ASSERT(constants.Get("timeSeconds", false)[0] == later);
+        ASSERT(!constants.Get("timeSeconds", true));
+
+#if LITHA_SHADER_CONSTANT_IDS
+        // Each location looked up just once
+        ASSERT(services.lookups == 4);
+#endif
+    }
+
+    // Low level shaders only upload the registers that changed
+    {
+        MockServices services;
+
+        LowLevelShaderRegisterMap rmap;
+        rmap.PushFourRegisters("TransWorldMatrix");
+        rmap.PushSingleRegister("timeSeconds", nullptr, nullptr, nullptr);
+
+        ShaderConstants constants;
+        constants.SetRegisterMap(rmap, false);
+        constants.Set("TransWorldMatrix", false, world.pointer(), 16);
+        constants.Set("timeSeconds", false, &time, 1);
+
+        constants.UploadLowLevel(&services, false);
+        ASSERT(services.lastStartRegister == 0);
+        ASSERT(services.lastRegisterCount == 5);
+
+        f32 later = 2.f;
+        constants.Set("timeSeconds", false, &later, 1);
+        constants.UploadLowLevel(&services, false);
+        ASSERT(services.lastStartRegister == 4);
+        ASSERT(services.lastRegisterCount == 1);
+
+        u32 uploads = services.uploads;
+        constants.UploadLowLevel(&services, false);
+        ASSERT(services.uploads == uploads);
+    }
+
+    // CPU cost per draw, as a frame of many blocks sharing one shader would
+    // see it. Every draw has a new world matrix, everything else is the same.
+    {
+        const u32 draws = 100000;
+
+        MockServices services;
+        services.names.push_back("TransWorldMatrix");
+        services.names.push_back("timeSeconds");
+        services.names.push_back("fogColour");
+        services.names.push_back("cloudShadowTexture");
+
+        // As Shader used to do it, string keyed maps uploaded by name.
+        auto start = std::chrono::steady_clock::now();
+
+        std::map<core::stringc, std::vector<f32>> vertexConstants;
+        std::map<core::stringc, std::vector<f32>> pixelConstants;
+
+        for (u32 i = 0; i < draws; i++)
+        {
+            world.setTranslation(core::vector3df(i, 0, 0));
+
+            vertexConstants["TransWorldMatrix"] = std::vector<f32>(
+                world.pointer(), world.pointer() + 16);
+            vertexConstants["timeSeconds"] = std::vector<f32>(1, time);
+            pixelConstants["fogColour"] =
+                std::vector<f32>(fogColour, fogColour + 4);
+            pixelConstants["cloudShadowTexture"] = std::vector<f32>(1, 1.f);
+
+            for (auto &elem : vertexConstants)
+            {
+#if LITHA_SHADER_CONSTANT_IDS
+                services.setVertexShaderConstant(
+                    services.getVertexShaderConstantID(elem.first.c_str()),
+                    &elem.second[0], elem.second.size());
+#else
+                services.setVertexShaderConstant(
+                    elem.first.c_str(), &elem.second[0], elem.second.size());
+#endif
+            }
+
+            for (auto &elem : pixelConstants)
+            {
+#if LITHA_SHADER_CONSTANT_IDS
+                services.setPixelShaderConstant(
+                    services.getPixelShaderConstantID(elem.first.c_str()),
+                    &elem.second[0], elem.second.size());
+#else
+                services.setPixelShaderConstant(
+                    elem.first.c_str(), &elem.second[0], elem.second.size());
+#endif
+            }
+        }
+
+        auto mid = std::chrono::steady_clock::now();
+        u32 oldUploads = services.uploads;
+        u32 oldLookups = services.lookups;
+        services.uploads = 0;
+        services.lookups = 0;
+
+        ShaderConstants constants;
+        u32 worldIndex = constants.GetIndex("TransWorldMatrix", false, 16);
+        u32 timeIndex = constants.GetIndex("timeSeconds", false, 1);
+        f32 one = 1.f;
+        constants.Set("fogColour", true, fogColour, 4);
+        constants.Set("cloudShadowTexture", true, &one, 1);
+
+        for (u32 i = 0; i < draws; i++)
+        {
+            world.setTranslation(core::vector3df(i, 0, 0));
+
+            constants.Set(worldIndex, world.pointer());
+            constants.Set(timeIndex, &time);
+            constants.UploadHighLevel(&services, false);
+        }
+
+        auto end = std::chrono::steady_clock::now();
+
+        ASSERT(services.uploads == draws + 3);
+
+        NOTE << "Setting constants per draw, maps: "
+             << (f32)(std::chrono::duration<f64, std::nano>(mid - start).count() /
+                      draws)
+             << "ns (" << oldUploads << " uploads, " << oldLookups
+             << " lookups), ShaderConstants: "
+             << (f32)(std::chrono::duration<f64, std::nano>(end - mid).count() /
+                      draws)
+             << "ns (" << services.uploads << " uploads, " << services.lookups
+             << " lookups)";
+    }
+}
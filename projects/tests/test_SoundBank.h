@@ -0,0 +1,53 @@
+
+{
+    NOTE << "Testing SoundBank";
+
+    // Sounds preloaded from a manifest must be found by the name the game
+    // plays them with, from paths::get_sfx.
+    {
+        io::path manifestFile = paths::get_sfx("sounds.manifest");
+        io::path dir = os::path::dirname(manifestFile);
+
+        std::vector<core::stringc> names =
+            SoundSystem::ReadManifest(manifestFile);
+        ASSERT(names.size());
+
+        SoundBank bank;
+
+        for (auto &name : names)
+            bank.LoadAsync(SoundBank::JoinPath(dir, name));
+
+        while (bank.GetProgress() < 1.f)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        std::vector<core::stringc> loaded = bank.TakeNewlyLoaded();
+
+        for (auto &name : names)
+        {
+            ASSERT(std::find(loaded.begin(), loaded.end(),
+                             paths::get_sfx(name)) != loaded.end());
+        }
+    }
+
+    // Long files are only opened to find they are to be streamed, and a
+    // released file is still known not to be.
+    {
+        SoundBank bank;
+        bank.SetStreamMinSeconds(10.f);
+
+        ASSERT(bank.IsStreamed(paths::get_sfx("sea.ogg")));
+        ASSERT(!bank.Get(paths::get_sfx("sea.ogg")));
+        ASSERT(bank.GetMemoryUsage() == 0);
+
+        core::stringc bell = paths::get_sfx("bell.ogg");
+        ASSERT(!bank.IsStreamed(bell));
+        ASSERT(bank.GetMemoryUsage());
+
+        bank.Release(bell);
+        ASSERT(bank.GetMemoryUsage() == 0);
+        ASSERT(!bank.IsStreamed(bell));
+        ASSERT(bank.GetMemoryUsage() == 0);
+
+        ASSERT(bank.Get(bell));
+    }
+}
@@ -0,0 +1,161 @@
+
+#include "AnimationSystem.h"
+#include <climits>
+
+// Poses are sampled at fractions of a frame, since animations are usually
+// played at a lower rate than the screen is drawn.
+static const f32 POSE_STEPS_PER_FRAME = 4.f;
+
+// Enough for several characters' animations.
+static const u32 MAX_CACHED_POSES = 4096;
+
+AnimationSystem::AnimationSystem(scene::ISceneManager *smgr, ITimer *timer)
+{
+    this->smgr = smgr;
+    this->timer = timer;
+
+    poseCount = 0;
+
+    SetReducedRate(0.f, 1);
+}
+
+AnimationSystem::~AnimationSystem()
+{
+    scene::IAnimatedMesh *lastMesh = nullptr;
+
+    // Keys are ordered by mesh, so each mesh is only dropped once.
+    for (auto &elem : poses)
+    {
+        if (elem.first.first != lastMesh)
+        {
+            lastMesh = elem.first.first;
+            lastMesh->drop();
+        }
+    }
+}
+
+void AnimationSystem::SetReducedRate(f32 distance, u32 interval)
+{
+    reducedRateDistanceSQ = distance * distance;
+    reducedRateInterval = core::max_(interval, 1u);
+}
+
+void AnimationSystem::BeginTransition(JointAnimationState &state,
+                                      f32 transitionTime)
+{
+    // Plus a frame or so, as Irrlicht measures the transition from its next
+    // OnAnimate.
+    state.transitionEndMs = timer->getTime() + (u32)(transitionTime * 1000.f) +
+                            100;
+
+    // Don't wait around to start it.
+    state.framesSkipped = reducedRateInterval;
+}
+
+bool AnimationSystem::ShouldAnimate(scene::IAnimatedMeshSceneNode *node,
+                                    JointAnimationState &state)
+{
+    if (!node->isVisible())
+        return false;
+
+    // Uses the last frame's view, but it is close enough.
+    if (smgr->isCulled(node))
+        return false;
+
+    if (reducedRateInterval > 1)
+    {
+        scene::ICameraSceneNode *camera = smgr->getActiveCamera();
+
+        if (camera &&
+            camera->getAbsolutePosition().getDistanceFromSQ(
+                node->getAbsolutePosition()) > reducedRateDistanceSQ &&
+            ++state.framesSkipped < reducedRateInterval)
+        {
+            return false;
+        }
+    }
+
+    state.framesSkipped = 0;
+    return true;
+}
+
+void AnimationSystem::AnimateJoints(scene::IAnimatedMeshSceneNode *node,
+                                    JointAnimationState &state)
+{
+    if (!ShouldAnimate(node, state))
+        return;
+
+    scene::IAnimatedMesh *mesh = node->getMesh();
+    u32 jointCount = node->getJointCount();
+
+    // Only skinned meshes have joints to cache.
+    // Or while blending, the pose depends on more than the frame.
+    if (!mesh || mesh->getMeshType() != scene::EAMT_SKINNED ||
+        jointCount == 0 || timer->getTime() < state.transitionEndMs)
+    {
+        node->animateJoints();
+        return;
+    }
+
+    PoseKey key(mesh,
+                (s32)(node->getFrameNr() * POSE_STEPS_PER_FRAME + 0.5f));
+
+    auto it = poses.find(key);
+
+    if (it != poses.end() && it->second.size() == jointCount)
+    {
+        PROFILE_ZONE("AnimationSystem::ApplyPose");
+
+        const Pose &pose = it->second;
+
+        for (u32 i = 0; i < jointCount; i++)
+        {
+            scene::IBoneSceneNode *joint = node->getJointNode(i);
+            joint->setPosition(pose[i].position);
+            joint->setRotation(pose[i].rotation);
+            joint->setScale(pose[i].scale);
+        }
+
+        // As animateJoints does, so anything attached to a joint follows it.
+        for (u32 i = 0; i < jointCount; i++)
+        {
+            scene::IBoneSceneNode *joint = node->getJointNode(i);
+
+            if (joint->getParent() == node)
+                joint->updateAbsolutePositionOfAllChildren();
+        }
+
+        return;
+    }
+
+    {
+        PROFILE_ZONE("AnimationSystem::EvaluatePose");
+        node->animateJoints();
+    }
+
+    if (poseCount >= MAX_CACHED_POSES)
+        return;
+
+    if (it == poses.end())
+    {
+        // First pose for this mesh?
+        auto next = poses.lower_bound(PoseKey(mesh, INT_MIN));
+
+        if (next == poses.end() || next->first.first != mesh)
+            mesh->grab();
+
+        it = poses.insert(std::make_pair(key, Pose())).first;
+        poseCount++;
+    }
+
+    Pose &pose = it->second;
+    pose.resize(jointCount);
+
+    for (u32 i = 0; i < jointCount; i++)
+    {
+        scene::IBoneSceneNode *joint = node->getJointNode(i);
+        pose[i].position = joint->getPosition();
+        pose[i].rotation = joint->getRotation();
+        pose[i].scale = joint->getScale();
+    }
+}
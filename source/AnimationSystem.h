@@ -0,0 +1,67 @@
+#ifndef ANIMATION_SYSTEM_H
+#define ANIMATION_SYSTEM_H
+
+#include "litha_internal.h"
+#include <map>
+#include <vector>
+
+// Per mesh state kept by Mesh for the animation system.
+struct JointAnimationState
+{
+    // Irrlicht is blending from the previous animation until this time.
+    // (device timer milliseconds)
+    u32 transitionEndMs;
+
+    // Joint updates skipped since the last one.
+    u32 framesSkipped;
+};
+
+// Evaluates the joints of animated meshes (which Mesh controls through
+// EJUOR_CONTROL) for Mesh.
+// - Meshes outside the camera's view are not evaluated at all.
+// - Meshes far from the camera can be evaluated at a reduced rate.
+// - Sampled poses are cached by skinned mesh and frame, so meshes sharing an
+// animation (or one mesh looping it) copy joints rather than evaluating the
+// keyframes again. Not used while Irrlicht blends between animations.
+class AnimationSystem : public IReferenceCounted
+{
+    scene::ISceneManager *smgr;
+    ITimer *timer;
+
+    f32 reducedRateDistanceSQ;
+    u32 reducedRateInterval;
+
+    struct JointPose
+    {
+        core::vector3df position;
+        core::vector3df rotation;
+        core::vector3df scale;
+    };
+
+    typedef std::pair<scene::IAnimatedMesh *, s32> PoseKey;
+    typedef std::vector<JointPose> Pose;
+
+    // Meshes in the keys are grabbed.
+    std::map<PoseKey, Pose> poses;
+    u32 poseCount;
+
+    bool ShouldAnimate(scene::IAnimatedMeshSceneNode *node,
+                       JointAnimationState &state);
+
+public:
+    AnimationSystem(scene::ISceneManager *smgr, ITimer *timer);
+    ~AnimationSystem();
+
+    void SetReducedRate(f32 distance, u32 interval);
+
+    // The node is about to blend into a new animation over this long.
+    void BeginTransition(JointAnimationState &state, f32 transitionTime);
+
+    // Update the node's joints for its current frame if it needs it.
+    void AnimateJoints(scene::IAnimatedMeshSceneNode *node,
+                       JointAnimationState &state);
+
+    u32 GetCachedPoseCount() const { return poseCount; }
+};
+
+#endif
@@ -36,6 +36,11 @@ void Camera::CacheInterpolatableState()
     cachedTargetDistance = targetDistance;
 }
 
+bool Camera::HasMoved()
+{
+    return ITransformable::HasMoved() || targetDistance != cachedTargetDistance;
+}
+
 core::vector3df Camera::GetInterpolatedPosition(f32 alpha)
 {
     // Let's interpolate targetDistance
@@ -24,6 +24,7 @@ public:
     f32 GetAspectRatio() override { return irrCamera->getAspectRatio(); }
 
     void CacheInterpolatableState() override;
+    bool HasMoved() override;
 
     // Camera has custom position interpolation code.
     // (regular method does not ensure camera will remain looking at target)
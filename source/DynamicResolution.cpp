@@ -0,0 +1,53 @@
+
+#include "DynamicResolution.h"
+
+DynamicResolution::DynamicResolution()
+{
+    SetParams(1000.f / 60.f, 0.5f, 1.f);
+}
+
+void DynamicResolution::SetParams(f32 targetFrameMs, f32 minScale,
+                                  f32 maxScale)
+{
+    ASSERT(targetFrameMs > 0.f);
+    ASSERT(minScale > 0.f && minScale <= maxScale);
+
+    this->targetFrameMs = targetFrameMs;
+    this->minScale = minScale;
+    this->maxScale = maxScale;
+
+    averageFrameMs = 0.f;
+    scale = maxScale;
+}
+
+void DynamicResolution::AddFrameTime(f32 frameMs)
+{
+    if (averageFrameMs <= 0.f)
+        averageFrameMs = frameMs;
+    else
+        averageFrameMs += (frameMs - averageFrameMs) * 0.1f;
+
+    if (averageFrameMs <= 0.f)
+        return;
+
+    f32 ratio = targetFrameMs / averageFrameMs;
+
+    // Go down as soon as frames are too slow, but only go back up when there
+    // is plenty of time spare.
+    if (ratio > 0.95f && ratio < 1.25f)
+        return;
+
+    // Pixel count (so roughly the cost) goes with the square of the scale.
+    // Small steps, as the average takes a while to catch up.
+    f32 change = core::clamp(sqrtf(ratio), 0.97f, 1.02f);
+
+    scale = core::clamp(scale * change, minScale, maxScale);
+}
+
+core::dimension2du DynamicResolution::GetSize(
+    const core::dimension2du &screenSize) const
+{
+    return core::dimension2du(
+        core::max_((u32)(screenSize.Width * scale + 0.5f), 1u),
+        core::max_((u32)(screenSize.Height * scale + 0.5f), 1u));
+}
@@ -0,0 +1,33 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include "litha_internal.h"
+
+// Picks a resolution scale for rendering the scene from how long frames take.
+// Frame times are smoothed, and the scale is only changed when they are well
+// away from the target, so it doesn't keep flicking between sizes.
+class DynamicResolution
+{
+    f32 targetFrameMs;
+    f32 minScale;
+    f32 maxScale;
+
+    f32 averageFrameMs;
+    f32 scale;
+
+public:
+    DynamicResolution();
+
+    // Scale is a fraction of the screen width and height.
+    void SetParams(f32 targetFrameMs, f32 minScale, f32 maxScale);
+
+    // Give the time taken by the last frame.
+    void AddFrameTime(f32 frameMs);
+
+    f32 GetScale() const { return scale; }
+
+    // Scene size for a screen size at the current scale.
+    core::dimension2du GetSize(const core::dimension2du &screenSize) const;
+};
+
+#endif
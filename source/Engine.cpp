@@ -5,6 +5,7 @@
 #include "RenderTask.h"
 #include "Kernel.h"
 #include "OpenALSoundSystem.h"
+#include "SoftwareSoundSystem.h"
 #include "Updater.h"
 #include "EventQueue.h"
 #include "Event.h"
@@ -48,6 +49,26 @@ VariantMap Engine::GetDefaultSettings()
     defaultSettings["postProcessingEnabled"] = true;
     defaultSettings["vsync"] = true;
     defaultSettings["maxRenderFPS"] = 60;
+    // Render the scene at a lower resolution when frames take too long.
+    defaultSettings["dynamicResolution"] = false;
+    defaultSettings["dynamicResolutionMinScale"] = 0.5;
+    // Send sound positions to OpenAL from a thread of their own.
+    defaultSettings["audioThread"] = false;
+    // "openal", or mix in software without a device: "null" discards the
+    // mix, "wav" writes it to soundOutputFile.
+    defaultSettings["soundSystem"] = "openal";
+    defaultSettings["soundOutputFile"] = "sound.wav";
+    // No window or rendering, for benchmarks and tools.
+    defaultSettings["headless"] = false;
+    // These only have an effect if the profiler is compiled in.
+    defaultSettings["profilerOverlay"] = false;
+    defaultSettings["profilerTraceFile"] = "";
+    // Least important level logged: "note", "warn" or "fail". Levels
+    // compiled out with LITHA_MIN_LOG_LEVEL stay out regardless.
+    defaultSettings["logLevel"] = "note";
+    // If set, log records are written here in binary rather than as text.
+    // Relative to the log file's directory. (see utils::log::setbinaryfile)
+    defaultSettings["binaryLogFile"] = "";
     return defaultSettings;
 }
 
@@ -68,6 +89,7 @@ io::path Engine::GetSettingsPath()
 Engine::Engine(int argc, const char **argv, const VariantMap *settings)
 {
     restartOnExit = false;
+    postEventDepth = 0;
 
     // Set this pointer first, as some objects below will want to call GetEngine
     // to access some Engine methods. (e.g. GetEngineTime).
@@ -131,10 +153,32 @@ Engine::Engine(int argc, const char **argv, const VariantMap *settings)
 
 #endif
 
+    core::stringc logLevel = initSettings["logLevel"];
+    logLevel.make_lower();
+
+    if (logLevel == "warn")
+        utils::log::setlevel(utils::log::ELL_WARN);
+    else if (logLevel == "fail")
+        utils::log::setlevel(utils::log::ELL_FAIL);
+    else
+        utils::log::setlevel(utils::log::ELL_NOTE);
+
+    io::path binaryLogName = initSettings["binaryLogFile"];
+
+    if (binaryLogName.size())
+    {
+        utils::log::setbinaryfile(
+            os::path::concat(os::path::dirname(logPath), binaryLogName));
+    }
+
     // Some initial notes on the log
 
     NOTE << "Litha Game Engine";
 
+#if LITHA_PROFILER
+    utils::profile::set_thread_name("Main");
+#endif
+
     for (int i = 0; i < argc; i++)
     {
         NOTE << "Arg: " << argv[i];
@@ -151,6 +195,9 @@ Engine::Engine(int argc, const char **argv, const VariantMap *settings)
     if (logPath2.size())
         NOTE << "Also logging to " << logPath2;
 
+    if (binaryLogName.size())
+        NOTE << "Binary logging to " << binaryLogName;
+
     NOTE << "Original starting path: " << startDir;
 
     // Query current desktop resolution...
@@ -188,6 +235,13 @@ Engine::Engine(int argc, const char **argv, const VariantMap *settings)
     deviceParams.DriverType = initSettings["softwareMode"]
                                   ? video::EDT_BURNINGSVIDEO
                                   : video::EDT_OPENGL;
+
+    if (initSettings["headless"])
+    {
+        deviceParams.DriverType = video::EDT_NULL;
+        deviceParams.DeviceType = EIDT_CONSOLE;
+    }
+
     deviceParams.WindowSize = core::dimension2du(initSettings["screenWidth"],
                                                  initSettings["screenHeight"]);
     deviceParams.Bits = 32;
@@ -312,7 +366,17 @@ Engine::Engine(int argc, const char **argv, const VariantMap *settings)
     kernel = new Kernel();
 
     world = new World();
-    soundSystem = new OpenALSoundSystem();
+
+    core::stringc soundSystemName =
+        initSettings["soundSystem"].To<core::stringc>();
+
+    if (soundSystemName == "null")
+        soundSystem = new SoftwareSoundSystem();
+    else if (soundSystemName == "wav")
+        soundSystem = new SoftwareSoundSystem(
+            initSettings["soundOutputFile"].To<core::stringc>());
+    else
+        soundSystem = new OpenALSoundSystem(initSettings["audioThread"]);
 
     logicTask = new LogicTask();
     kernel->AddTask(logicTask);
@@ -328,6 +392,10 @@ Engine::Engine(int argc, const char **argv, const VariantMap *settings)
     // Set world to be updated by Logic task
     logicTask->GetUpdater().AddUpdatable(world);
 
+    // Sound system too, it starts sounds that were waiting for their files to
+    // load. (not part of the world, so keeps going when the world is paused)
+    logicTask->GetUpdater().AddUpdatable(soundSystem);
+
     // Now render system has been set up.
 
     // Shaders enabled?
@@ -339,6 +407,15 @@ Engine::Engine(int argc, const char **argv, const VariantMap *settings)
     // done with shaders.
     if (!initSettings["postProcessingEnabled"])
         GetRenderSystem()->ForceNoPostProcessing(true);
+
+    if (initSettings["dynamicResolution"])
+    {
+        GetRenderSystem()->SetDynamicResolution(
+            true, 1000.f / initSettings["maxRenderFPS"].To<f32>(),
+            initSettings["dynamicResolutionMinScale"].To<f32>());
+    }
+
+    GetRenderSystem()->ShowProfilerOverlay(initSettings["profilerOverlay"]);
 }
 
 Engine::~Engine()
@@ -377,6 +454,13 @@ Engine::~Engine()
     kernel->drop();
     device->drop();
 
+#if LITHA_PROFILER
+    core::stringc traceFile = initSettings["profilerTraceFile"];
+
+    if (traceFile.size())
+        utils::profile::save_trace(traceFile);
+#endif
+
     NOTE << "Litha Engine appears to have shut down successfully.";
 
     if (restartOnExit)
@@ -555,7 +639,7 @@ void Engine::RegisterEventInterest(IWantEvents *receiver,
 void Engine::UnregisterEventInterest(IWantEvents *receiver,
                                      const core::stringc &eventName)
 {
-    specificEventInterest[eventName].Remove(receiver);
+    specificEventInterest[eventName].SwapRemove(receiver);
 }
 
 void Engine::RegisterAllEventInterest(IWantEvents *receiver)
@@ -565,18 +649,22 @@ void Engine::RegisterAllEventInterest(IWantEvents *receiver)
 
 void Engine::UnregisterAllEventInterest(IWantEvents *receiver)
 {
-    allEventInterest.Remove(receiver);
+    allEventInterest.SwapRemove(receiver);
 
     // also remove from all specific event interest sets
     for (auto &elem : specificEventInterest)
     {
-        elem.second.Remove(receiver);
+        elem.second.SwapRemove(receiver);
     }
 }
 
 void Engine::PostEvent(const Event &event)
 {
-    Set<IWantEvents *> recipients;
+    if (postEventDepth == eventRecipients.size())
+        eventRecipients.emplace_back();
+
+    IndexedSet<IWantEvents *> &recipients = eventRecipients[postEventDepth++];
+    recipients.clear();
 
     // Add those interested in all events
     recipients.Union(allEventInterest);
@@ -593,6 +681,8 @@ void Engine::PostEvent(const Event &event)
 
     for (auto &recipient : recipients)
         recipient->OnEvent(event);
+
+    postEventDepth--;
 }
 
 void Engine::QueueEvent(const Event &event, f32 delay)
@@ -603,6 +693,8 @@ void Engine::QueueEvent(const Event &event, f32 delay)
 
 void Engine::ProcessEventQueue()
 {
+    PROFILE_ZONE("Engine::ProcessEventQueue");
+
     f32 currentTime = GetEngineTime();
 
     std::vector<Event> readyEvents;
@@ -2,19 +2,21 @@
 #include "IEngine.h"
 #include <stack>
 #include "Buttons.h"
+#include <deque>
 #include <map>
 
 class Kernel;
 class LogicTask;
 class RenderTask;
 class World;
+class SoundSystem;
 
 class Engine : public IEngine, public IEventReceiver
 {
     IrrlichtDevice *device;
     Kernel *kernel;
     World *world;
-    ISoundSystem *soundSystem;
+    SoundSystem *soundSystem;
     io::IFileSystem *filesys;
     ITimer *timer;
     gui::ICursorControl *curcon;
@@ -47,8 +49,15 @@ class Engine : public IEngine, public IEventReceiver
     bool autoCentreMouseY;
 
     // event system
-    std::map<core::stringc, Set<IWantEvents *>> specificEventInterest;
-    Set<IWantEvents *> allEventInterest;
+    // Receivers are not called in any particular order.
+    std::map<core::stringc, IndexedSet<IWantEvents *>> specificEventInterest;
+    IndexedSet<IWantEvents *> allEventInterest;
+
+    // Reused by PostEvent rather than allocating for every event.
+    // One per nested PostEvent, since an OnEvent may post another event.
+    // (a deque so those further out aren't moved by one being added)
+    std::deque<IndexedSet<IWantEvents *>> eventRecipients;
+    u32 postEventDepth;
 
     // event queue
     std::vector<Event> eventQueue;
@@ -32,6 +32,8 @@ void Kernel::Run()
     // (which is used by GetEngineTime())
     while (tasks.size() && device->run())
     {
+        PROFILE_ZONE("Kernel::Run");
+
 #ifdef __APPLE__
         // We don't do this on full screen on Mac is it causes a freeze... (much
         // like that Linux problem I had once...)
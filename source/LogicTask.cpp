@@ -5,6 +5,8 @@ LogicTask::LogicTask() = default;
 
 void LogicTask::Update(f32 dt)
 {
+    PROFILE_ZONE("LogicTask::Update");
+
     // World is updated here.
     // (it is an updatable added to this task's Updater)
     Task::Update(dt);
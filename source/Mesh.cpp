@@ -1,10 +1,16 @@
 
 #include "Mesh.h"
 #include "IShader.h"
+#include "MeshBatcher.h"
 
-Mesh::Mesh(scene::ISceneManager *smgr, const c8 *name)
+Mesh::Mesh(scene::ISceneManager *smgr, MeshBatcher *batcher,
+           AnimationSystem *animationSystem, const c8 *name)
 {
     this->smgr = smgr;
+    this->batcher = batcher;
+    batcher->grab();
+    this->animationSystem = animationSystem;
+    animationSystem->grab();
 
     meshNode = smgr->addAnimatedMeshSceneNode(smgr->getMesh(name));
 
@@ -12,6 +18,13 @@ Mesh::Mesh(scene::ISceneManager *smgr, const c8 *name)
     // (due to addition of "pass" system)
     // meshNode->setMaterialFlag(video::EMF_LIGHTING, false);
 
+    currentPass = -1;
+    materialsChanged = true;
+    visible = true;
+
+    instanced = false;
+    batched = false;
+
     // Create the first pass using materials from the given mesh.
     // meshNode should (WILL!) have the same number of materials as this.
     AddPass(name);
@@ -19,6 +32,8 @@ Mesh::Mesh(scene::ISceneManager *smgr, const c8 *name)
     // Animation...
     meshNode->setJointMode(scene::EJUOR_CONTROL);
     currentAnimation = nullptr;
+    animationState.transitionEndMs = 0;
+    animationState.framesSkipped = 0;
 
     // onFirstFrame = true;
 
@@ -29,6 +44,12 @@ Mesh::Mesh(scene::ISceneManager *smgr, const c8 *name)
 
 Mesh::~Mesh()
 {
+    if (instanced)
+        batcher->Remove(this);
+
+    batcher->drop();
+    animationSystem->drop();
+
     meshNode->remove();
 
     // struct Pass drops shaders on destruction.
@@ -78,6 +99,9 @@ video::SMaterial &Mesh::GetMaterial(u32 material, u16 pass)
     ASSERT(pass < GetPassCount());
     ASSERT(material < passes[pass].materials.size());
 
+    // Could be modified through the reference.
+    materialsChanged = true;
+
     return passes[pass].materials[material];
 }
 
@@ -102,6 +126,8 @@ void Mesh::SetShader(u32 material, IShader *shader, u16 pass)
     }
 
     SET_REF_COUNTED_POINTER(passes[pass].shaders[material], shader)
+
+    materialsChanged = true;
 }
 
 void Mesh::SetAllShaders(IShader *shader, u16 pass)
@@ -119,6 +145,8 @@ void Mesh::DisableMaterial(u32 material, u16 pass)
 
     passes[pass].materials[material].FrontfaceCulling = true;
     passes[pass].materials[material].BackfaceCulling = true;
+
+    materialsChanged = true;
 }
 
 void Mesh::DisableAllMaterials(u16 pass)
@@ -131,7 +159,11 @@ void Mesh::DisableAllMaterials(u16 pass)
 
 void Mesh::SetVisible(bool visible)
 {
-    meshNode->setVisible(visible);
+    this->visible = visible;
+
+    // Leave hidden if hidden for the current pass or batched.
+    if ((currentPass < GetPassCount() && !batched) || !visible)
+        meshNode->setVisible(visible);
 }
 
 void Mesh::ReceiveRenderPosition(core::vector3df pos)
@@ -160,25 +192,46 @@ void Mesh::SetCurrentPass(u16 pass)
     if (pass < GetPassCount())
     {
         // Set all mesh node materials to those from the appropriate pass.
+        // Unless they are already set.
+        if (pass != currentPass || materialsChanged)
+        {
+            ASSERT(meshNode->getMaterialCount() ==
+                   passes[pass].materials.size());
 
-        ASSERT(meshNode->getMaterialCount() == passes[pass].materials.size());
+            for (u32 i = 0; i < meshNode->getMaterialCount(); i++)
+                meshNode->getMaterial(i) = passes[pass].materials[i];
 
-        for (u32 i = 0; i < meshNode->getMaterialCount(); i++)
-        {
-            meshNode->getMaterial(i) = passes[pass].materials[i];
+            if (currentPass >= (s32)GetPassCount())
+                meshNode->setVisible(visible && !batched);
+
+            if (instanced && materialsChanged)
+                batcher->MaterialsChanged(this);
+
+            currentPass = pass;
+            materialsChanged = false;
         }
     }
-    else
+    else if (currentPass < (s32)GetPassCount())
     {
         // No materials set for this pass, so must hide node completely.
-        // Do this by setting both frontface and backface culling to true.
-        // (should not use meshNode->setVisible() as that effects child nodes
-        // too)
-        for (u32 i = 0; i < meshNode->getMaterialCount(); i++)
+        // Hiding the node means Irrlicht doesn't draw it at all, but should
+        // not use meshNode->setVisible() if it has children, as that effects
+        // child nodes too. So instead set both frontface and backface culling
+        // to true.
+        if (meshNode->getChildren().empty())
+        {
+            meshNode->setVisible(false);
+        }
+        else
         {
-            meshNode->getMaterial(i).BackfaceCulling = true;
-            meshNode->getMaterial(i).FrontfaceCulling = true;
+            for (u32 i = 0; i < meshNode->getMaterialCount(); i++)
+            {
+                meshNode->getMaterial(i).BackfaceCulling = true;
+                meshNode->getMaterial(i).FrontfaceCulling = true;
+            }
         }
+
+        currentPass = pass;
     }
 
     if (pass == 0)
@@ -215,7 +268,8 @@ void Mesh::SetCurrentPass(u16 pass)
             */
 
             // Animation
-            meshNode->animateJoints();
+            // Skipped if it can't be seen, see AnimationSystem.
+            animationSystem->AnimateJoints(meshNode, animationState);
 
             // Possibly end an animation if it is not looped.
             // Irrlicht's OnAnimationEnd callback didn't seem to work??
@@ -302,6 +356,10 @@ void Mesh::SetAnimation(s32 id)
         else // Don't need a transition with the first animation set.
             meshNode->setTransitionTime(0.f);
 
+        animationSystem->BeginTransition(
+            animationState, wasAnimation ? currentAnimation->transitionTime
+                                         : 0.f);
+
         // This is required for some reason.
         // Ensures transition is applied correctly.
         meshNode->setCurrentFrame(currentAnimation->start);
@@ -341,6 +399,9 @@ void Mesh::Scale(const core::vector3df &scale)
     meshNode->setMaterialFlag(video::EMF_NORMALIZE_NORMALS,
                               !(scale.X == 1.0 && scale.Y == 1.0 &&
                                 scale.Z == 1.0));
+
+    // Node materials are reset from the pass materials as before.
+    materialsChanged = true;
 }
 
 void Mesh::Rotate(const core::vector3df &rotation)
@@ -353,3 +414,43 @@ void Mesh::Translate(const core::vector3df &translation)
 {
     this->translation = translation;
 }
+
+void Mesh::SetInstanced(bool instanced)
+{
+    if (instanced == this->instanced)
+        return;
+
+    this->instanced = instanced;
+
+    if (instanced)
+    {
+        batcher->Add(this);
+    }
+    else
+    {
+        batcher->Remove(this);
+        SetBatched(false);
+    }
+}
+
+const video::SMaterial &Mesh::GetPassMaterial(u32 material, u16 pass) const
+{
+    ASSERT(pass < passes.size());
+    ASSERT(material < passes[pass].materials.size());
+
+    return passes[pass].materials[material];
+}
+
+void Mesh::SetBatched(bool batched)
+{
+    this->batched = batched;
+
+    // Otherwise hidden for the current pass, SetCurrentPass will show it.
+    if (currentPass < (s32)GetPassCount())
+        meshNode->setVisible(visible && !batched);
+}
+
+bool Mesh::IsInstanceVisible() const
+{
+    return visible && currentPass >= 0 && currentPass < (s32)passes.size();
+}
@@ -2,8 +2,11 @@
 #include "IMesh.h"
 
 #include "IShader.h"
+#include "AnimationSystem.h"
 #include <map>
 
+class MeshBatcher;
+
 // Utility struct
 struct Pass
 {
@@ -64,9 +67,28 @@ class Mesh : public IMesh
 
     std::vector<Pass> passes;
 
+    // Pass whose materials are currently set in the mesh node.
+    // (GetPassCount() or more if hidden, -1 if none yet)
+    s32 currentPass;
+
+    // Pass materials may have been changed since last set in the mesh node.
+    bool materialsChanged;
+
+    // As set by SetVisible, the node may also be hidden for a pass.
+    bool visible;
+
+    MeshBatcher *batcher;
+    bool instanced;
+
+    // Drawn by the batcher rather than the node. (node is kept hidden)
+    bool batched;
+
     std::map<s32, Animation> animations;
     Animation *currentAnimation;
 
+    AnimationSystem *animationSystem;
+    JointAnimationState animationState;
+
     // a permanent rotation to apply transparently to mesh scene node
     core::vector3df rotation;
     // a permanent translation
@@ -76,7 +98,8 @@ class Mesh : public IMesh
     // bool onFirstFrame;
 
 public:
-    Mesh(scene::ISceneManager *smgr, const c8 *name);
+    Mesh(scene::ISceneManager *smgr, MeshBatcher *batcher,
+         AnimationSystem *animationSystem, const c8 *name);
     ~Mesh();
 
     core::aabbox3df GetBoundingBox() override;
@@ -124,4 +147,13 @@ public:
     void Rotate(const core::vector3df &rotation) override;
 
     void Translate(const core::vector3df &translation) override;
+
+    void SetInstanced(bool instanced) override;
+
+    // Used by MeshBatcher.
+    const video::SMaterial &GetPassMaterial(u32 material, u16 pass) const;
+    void SetBatched(bool batched);
+
+    // Shown and has materials for the current pass.
+    bool IsInstanceVisible() const;
 };
@@ -0,0 +1,524 @@
+
+#include "MeshBatcher.h"
+#include "Mesh.h"
+#include <algorithm>
+#include <functional>
+
+// Draw order for batches, so consecutive draws share as much state as
+// possible. Changing shader costs the most, then textures. Only solid
+// materials are batched, so there is no blend state to sort on.
+static bool DrawsBefore(const video::SMaterial &a, const video::SMaterial &b)
+{
+    if (a.MaterialType != b.MaterialType)
+        return a.MaterialType < b.MaterialType;
+
+    for (u32 i = 0; i < video::MATERIAL_MAX_TEXTURES; i++)
+    {
+        video::ITexture *textureA = a.TextureLayer[i].Texture;
+        video::ITexture *textureB = b.TextureLayer[i].Texture;
+
+        if (textureA != textureB)
+            return std::less<video::ITexture *>()(textureA, textureB);
+    }
+
+    return false;
+}
+
+// Whether the box is entirely outside the frustum. (the planes face out)
+static bool IsCulled(const scene::SViewFrustum &frustum,
+                     const core::aabbox3df &box)
+{
+    for (u32 i = 0; i < scene::SViewFrustum::VF_PLANE_COUNT; i++)
+    {
+        if (box.classifyPlaneRelation(frustum.planes[i]) ==
+            core::ISREL3D_FRONT)
+            return true;
+    }
+
+    return false;
+}
+
+MeshBatcher::MeshBatcher(scene::ISceneNode *parent, scene::ISceneManager *smgr)
+    : scene::ISceneNode(parent, smgr)
+{
+#ifdef _DEBUG
+    setDebugName("MeshBatcher");
+#endif
+}
+
+MeshBatcher::~MeshBatcher()
+{
+    for (auto &batch : batches)
+    {
+        batch->source->drop();
+        FreeChunks(*batch);
+        delete batch;
+    }
+}
+
+void MeshBatcher::Add(Mesh *mesh)
+{
+    meshes.Insert(mesh);
+    changedMeshes.Insert(mesh);
+
+    // Hide the node straight away, rather than it being drawn until the next
+    // regroup.
+    mesh->SetBatched(IsBatchable(mesh));
+}
+
+void MeshBatcher::Remove(Mesh *mesh)
+{
+    meshes.SwapRemove(mesh);
+    changedMeshes.SwapRemove(mesh);
+
+    // The mesh is going, so its instances must be gone before the next
+    // update looks at them.
+    auto it = meshBatches.find(mesh);
+
+    if (it != meshBatches.end())
+    {
+        for (auto &batch : it->second)
+            batch->rechunk = true;
+
+        ungroupedMeshes.Insert(mesh);
+        meshBatches.erase(it);
+    }
+}
+
+void MeshBatcher::MaterialsChanged(Mesh *mesh)
+{
+    if (meshes.Contains(mesh))
+        changedMeshes.Insert(mesh);
+}
+
+bool MeshBatcher::IsBatchable(Mesh *mesh)
+{
+    scene::IAnimatedMeshSceneNode *node = mesh->GetIrrlichtNode();
+
+    // Hiding the node would hide any children too.
+    if (!node->getChildren().empty())
+        return false;
+
+    if (mesh->GetPassCount() != 1 || !node->getMesh())
+        return false;
+
+    scene::IMesh *source = node->getMesh()->getMesh(0);
+
+    if (!source || source->getMeshBufferCount() != mesh->GetMaterialCount())
+        return false;
+
+    video::IVideoDriver *driver = SceneManager->getVideoDriver();
+
+    for (u32 i = 0; i < source->getMeshBufferCount(); i++)
+    {
+        scene::IMeshBuffer *mb = source->getMeshBuffer(i);
+
+        if (mb->getVertexType() != video::EVT_STANDARD ||
+            mb->getIndexType() != video::EIT_16BIT)
+            return false;
+
+        // Would be drawn unsorted.
+        const video::SMaterial &material = mesh->GetPassMaterial(i, 0);
+        video::IMaterialRenderer *renderer =
+            driver->getMaterialRenderer(material.MaterialType);
+
+        if (renderer && renderer->isTransparent())
+            return false;
+    }
+
+    return true;
+}
+
+bool MeshBatcher::FitsBatches(Mesh *mesh, const std::vector<Batch *> &current)
+{
+    scene::IMesh *source = mesh->GetIrrlichtNode()->getMesh()->getMesh(0);
+
+    if (current.size() != source->getMeshBufferCount())
+        return false;
+
+    for (u32 i = 0; i < current.size(); i++)
+    {
+        if (current[i]->source != source->getMeshBuffer(i) ||
+            current[i]->material != mesh->GetPassMaterial(i, 0))
+            return false;
+    }
+
+    return true;
+}
+
+void MeshBatcher::Group(Mesh *mesh)
+{
+    std::vector<Batch *> &current = meshBatches[mesh];
+    scene::IMesh *source = mesh->GetIrrlichtNode()->getMesh()->getMesh(0);
+
+    for (u32 i = 0; i < source->getMeshBufferCount(); i++)
+    {
+        scene::IMeshBuffer *mb = source->getMeshBuffer(i);
+        const video::SMaterial &material = mesh->GetPassMaterial(i, 0);
+
+        Batch *batch = nullptr;
+
+        for (auto &elem : batches)
+        {
+            if (elem->source == mb && elem->material == material)
+            {
+                batch = elem;
+                break;
+            }
+        }
+
+        if (!batch)
+        {
+            batch = new Batch();
+            batch->source = mb;
+            batch->source->grab();
+            batch->material = material;
+            batch->sourceChangedID = mb->getChangedID_Vertex();
+            batch->instancesPerChunk = 0;
+
+            // Put in draw order.
+            auto pos = std::upper_bound(
+                batches.begin(), batches.end(), batch,
+                [](const Batch *a, const Batch *b) {
+                    return DrawsBefore(a->material, b->material);
+                });
+            batches.insert(pos, batch);
+        }
+
+        Instance instance;
+        instance.mesh = mesh;
+        instance.visible = false;
+        instance.written = false;
+        batch->instances.push_back(instance);
+        batch->rechunk = true;
+
+        current.push_back(batch);
+    }
+}
+
+void MeshBatcher::Regroup()
+{
+    PROFILE_ZONE("MeshBatcher::Regroup");
+
+    // Meshes to be put (back) in batches.
+    std::vector<Mesh *> grouping;
+
+    for (Mesh *mesh : changedMeshes)
+    {
+        bool batchable = IsBatchable(mesh);
+        mesh->SetBatched(batchable);
+
+        auto it = meshBatches.find(mesh);
+
+        // e.g. GetMaterial only read from, or a Scale, which doesn't change
+        // the pass materials.
+        if (it != meshBatches.end() && batchable &&
+            FitsBatches(mesh, it->second))
+            continue;
+
+        // Leave the old batches.
+        if (it != meshBatches.end())
+        {
+            for (auto &batch : it->second)
+                batch->rechunk = true;
+
+            ungroupedMeshes.Insert(mesh);
+            meshBatches.erase(it);
+        }
+
+        if (batchable)
+            grouping.push_back(mesh);
+    }
+
+    changedMeshes.clear();
+
+    // Drop the instances of meshes that left, before they are added again.
+    if (ungroupedMeshes.size())
+    {
+        for (auto &batch : batches)
+        {
+            if (!batch->rechunk)
+                continue;
+
+            std::vector<Instance> &instances = batch->instances;
+
+            auto left = [this](const Instance &instance) {
+                return ungroupedMeshes.Contains(instance.mesh);
+            };
+
+            instances.erase(
+                std::remove_if(instances.begin(), instances.end(), left),
+                instances.end());
+        }
+
+        ungroupedMeshes.clear();
+    }
+
+    for (auto &mesh : grouping)
+        Group(mesh);
+
+    // Only the batches that gained or lost instances are rebuilt.
+    for (u32 i = 0; i < batches.size(); i++)
+    {
+        Batch &batch = *batches[i];
+
+        if (!batch.rechunk)
+            continue;
+
+        FreeChunks(batch);
+
+        if (batch.instances.empty())
+        {
+            batch.source->drop();
+            delete batches[i];
+            batches.erase(batches.begin() + i);
+            i--;
+            continue;
+        }
+
+        // Instances have moved within the chunks, so all are written again.
+        for (auto &instance : batch.instances)
+            instance.written = false;
+
+        AllocateChunks(batch);
+        batch.rechunk = false;
+    }
+}
+
+void MeshBatcher::FreeChunks(Batch &batch)
+{
+    for (auto &chunk : batch.chunks)
+        chunk.buffer->drop();
+
+    batch.chunks.clear();
+}
+
+void MeshBatcher::AllocateChunks(Batch &batch)
+{
+    u32 vertexCount = batch.source->getVertexCount();
+    u32 indexCount = batch.source->getIndexCount();
+    const u16 *indices = batch.source->getIndices();
+
+    batch.instancesPerChunk =
+        core::max_(65536 / core::max_(vertexCount, 1u), 1u);
+
+    for (u32 first = 0; first < batch.instances.size();
+         first += batch.instancesPerChunk)
+    {
+        u32 count = core::min_(batch.instancesPerChunk,
+                               (u32)batch.instances.size() - first);
+
+        auto *buffer = new scene::SMeshBuffer();
+        buffer->Vertices.set_used(count * vertexCount);
+        buffer->Indices.set_used(count * indexCount);
+
+        for (u32 i = 0; i < count; i++)
+        {
+            for (u32 j = 0; j < indexCount; j++)
+                buffer->Indices[i * indexCount + j] =
+                    indices[j] + i * vertexCount;
+        }
+
+        // Instances that move are rewritten every frame, but most don't.
+        buffer->setHardwareMappingHint(scene::EHM_DYNAMIC, scene::EBT_VERTEX);
+        buffer->setHardwareMappingHint(scene::EHM_STATIC, scene::EBT_INDEX);
+
+        Chunk chunk;
+        chunk.buffer = buffer;
+        chunk.empty = true;
+        batch.chunks.push_back(chunk);
+    }
+}
+
+void MeshBatcher::WriteInstance(Batch &batch, u32 index)
+{
+    Instance &instance = batch.instances[index];
+
+    scene::SMeshBuffer *chunk =
+        batch.chunks[index / batch.instancesPerChunk].buffer;
+
+    u32 vertexCount = batch.source->getVertexCount();
+    const auto *src = (const video::S3DVertex *)batch.source->getVertices();
+    video::S3DVertex *dest =
+        &chunk->Vertices[(index % batch.instancesPerChunk) * vertexCount];
+
+    if (instance.visible)
+    {
+        for (u32 i = 0; i < vertexCount; i++)
+        {
+            instance.transform.transformVect(dest[i].Pos, src[i].Pos);
+            instance.transform.rotateVect(dest[i].Normal, src[i].Normal);
+            dest[i].Normal.normalize();
+            dest[i].TCoords = src[i].TCoords;
+            dest[i].Color = src[i].Color;
+        }
+
+        instance.box = batch.source->getBoundingBox();
+        instance.transform.transformBoxEx(instance.box);
+    }
+    else
+    {
+        // Hidden, so collapse to a single point. No fragments get drawn.
+        core::vector3df pos = instance.transform.getTranslation();
+
+        for (u32 i = 0; i < vertexCount; i++)
+            dest[i].Pos = pos;
+
+        instance.box.reset(pos);
+    }
+
+    chunk->setDirty(scene::EBT_VERTEX);
+    instance.written = true;
+}
+
+bool MeshBatcher::UpdateBatch(Batch &batch)
+{
+    bool changed = false;
+
+    // Source vertices changed (e.g. vertex colours set), so copy them again.
+    if (batch.source->getChangedID_Vertex() != batch.sourceChangedID)
+    {
+        batch.sourceChangedID = batch.source->getChangedID_Vertex();
+
+        for (auto &instance : batch.instances)
+            instance.written = false;
+    }
+
+    for (u32 i = 0; i < batch.instances.size(); i++)
+    {
+        Instance &instance = batch.instances[i];
+
+        scene::IAnimatedMeshSceneNode *node = instance.mesh->GetIrrlichtNode();
+
+        // Hidden nodes are skipped by Irrlicht's OnAnimate, which is what
+        // normally updates this.
+        node->updateAbsolutePosition();
+        const core::matrix4 &transform = node->getAbsoluteTransformation();
+
+        bool visible = instance.mesh->IsInstanceVisible();
+
+        if (instance.written && visible == instance.visible &&
+            transform == instance.transform)
+            continue;
+
+        instance.transform = transform;
+        instance.visible = visible;
+        WriteInstance(batch, i);
+
+        changed = true;
+    }
+
+    if (changed)
+    {
+        for (auto &chunk : batch.chunks)
+            chunk.empty = true;
+
+        bool first = true;
+
+        for (u32 i = 0; i < batch.instances.size(); i++)
+        {
+            const Instance &instance = batch.instances[i];
+
+            if (!instance.visible)
+                continue;
+
+            Chunk &chunk = batch.chunks[i / batch.instancesPerChunk];
+
+            if (chunk.empty)
+                chunk.box = instance.box;
+            else
+                chunk.box.addInternalBox(instance.box);
+
+            chunk.empty = false;
+
+            if (first)
+                batch.box = instance.box;
+            else
+                batch.box.addInternalBox(instance.box);
+
+            first = false;
+        }
+
+        if (first)
+            batch.box.reset(0, 0, 0);
+    }
+
+    return changed;
+}
+
+void MeshBatcher::OnRegisterSceneNode()
+{
+    if (IsVisible)
+    {
+        PROFILE_ZONE("MeshBatcher");
+
+        bool changed = false;
+
+        if (changedMeshes.size() || ungroupedMeshes.size())
+        {
+            Regroup();
+            changed = true;
+        }
+
+        for (auto &batch : batches)
+        {
+            if (UpdateBatch(*batch))
+                changed = true;
+        }
+
+        if (changed)
+        {
+            box.reset(0, 0, 0);
+
+            for (u32 i = 0; i < batches.size(); i++)
+            {
+                if (i == 0)
+                    box = batches[i]->box;
+                else
+                    box.addInternalBox(batches[i]->box);
+            }
+        }
+
+        if (batches.size())
+            SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+    }
+
+    ISceneNode::OnRegisterSceneNode();
+}
+
+void MeshBatcher::render()
+{
+    video::IVideoDriver *driver = SceneManager->getVideoDriver();
+
+    // Vertices are already in world space, as is the frustum.
+    driver->setTransform(video::ETS_WORLD, core::IdentityMatrix);
+
+    scene::ICameraSceneNode *camera = SceneManager->getActiveCamera();
+    const scene::SViewFrustum *frustum =
+        camera ? camera->getViewFrustum() : nullptr;
+
+    for (auto &batch : batches)
+    {
+        bool materialSet = false;
+
+        for (auto &chunk : batch->chunks)
+        {
+            if (chunk.empty || (frustum && IsCulled(*frustum, chunk.box)))
+                continue;
+
+            // Not set at all if every chunk is culled.
+            if (!materialSet)
+            {
+                driver->setMaterial(batch->material);
+                materialSet = true;
+            }
+
+            driver->drawMeshBuffer(chunk.buffer);
+        }
+    }
+}
+
+const core::aabbox3d<f32> &MeshBatcher::getBoundingBox() const
+{
+    return box;
+}
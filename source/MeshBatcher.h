@@ -0,0 +1,112 @@
+#ifndef MESH_BATCHER_H
+#define MESH_BATCHER_H
+
+#include "litha_internal.h"
+#include <unordered_map>
+#include <vector>
+
+class Mesh;
+
+// Draws instanced meshes (see IMesh::SetInstanced) that share the same mesh
+// buffer and material together.
+// Irrlicht has no hardware instancing, so this is a CPU batched path used with
+// every driver: each instance's geometry is transformed into one shared buffer
+// per mesh buffer and material, which is then drawn in a single call. The
+// per-instance transform is cached, so only instances that moved or were
+// hidden since the last frame are transformed again. (or all of them, if the
+// source mesh buffer was marked dirty)
+// Only solid materials are batched. Transparent meshes are left to Irrlicht,
+// which depth sorts each node, and one batch node can't be sorted like that.
+// Added to the scene manager as a scene node, so it is drawn by drawAll.
+// Batches are drawn sorted by shader then texture. Each is split into chunks
+// which are frustum culled by their bounds.
+// A mesh that is added, removed or has its materials changed only affects
+// the batches it leaves or joins.
+class MeshBatcher : public scene::ISceneNode
+{
+    struct Instance
+    {
+        Mesh *mesh;
+
+        // As last written into the batch vertices
+        core::matrix4 transform;
+        bool visible;
+        bool written;
+
+        core::aabbox3df box;
+    };
+
+    // Up to 64k vertices of a batch, so that indices fit in 16 bits.
+    struct Chunk
+    {
+        scene::SMeshBuffer *buffer;
+
+        // Of the visible instances in it, for frustum culling.
+        core::aabbox3df box;
+        bool empty;
+    };
+
+    // One mesh buffer and material.
+    struct Batch
+    {
+        scene::IMeshBuffer *source;
+        video::SMaterial material;
+
+        // Source vertices as last copied. (see IMeshBuffer::setDirty)
+        u32 sourceChangedID;
+
+        std::vector<Instance> instances;
+
+        std::vector<Chunk> chunks;
+        u32 instancesPerChunk;
+
+        // Instances added or removed, chunks must be allocated again.
+        bool rechunk;
+
+        core::aabbox3df box;
+    };
+
+    IndexedSet<Mesh *> meshes;
+
+    // Sorted in draw order. (pointers so they stay put for meshBatches)
+    std::vector<Batch *> batches;
+
+    // The batch of each of a mesh's buffers, in buffer order.
+    std::unordered_map<Mesh *, std::vector<Batch *>> meshBatches;
+
+    // Added, or with materials that may have changed, since the last regroup.
+    IndexedSet<Mesh *> changedMeshes;
+
+    // Removed, or to be grouped again. Their instances are dropped from
+    // batches marked to rechunk.
+    IndexedSet<Mesh *> ungroupedMeshes;
+
+    core::aabbox3df box;
+
+    bool IsBatchable(Mesh *mesh);
+
+    // Whether the mesh still belongs in the batches it is in.
+    bool FitsBatches(Mesh *mesh, const std::vector<Batch *> &current);
+
+    void Group(Mesh *mesh);
+    void Regroup();
+    void FreeChunks(Batch &batch);
+    void AllocateChunks(Batch &batch);
+    void WriteInstance(Batch &batch, u32 index);
+    bool UpdateBatch(Batch &batch);
+
+public:
+    MeshBatcher(scene::ISceneNode *parent, scene::ISceneManager *smgr);
+    ~MeshBatcher();
+
+    // Called by Mesh.
+    void Add(Mesh *mesh);
+    void Remove(Mesh *mesh);
+    void MaterialsChanged(Mesh *mesh);
+
+    void OnRegisterSceneNode() override;
+    void render() override;
+    const core::aabbox3d<f32> &getBoundingBox() const override;
+};
+
+#endif
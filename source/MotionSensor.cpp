@@ -56,6 +56,12 @@ void MotionSensor::EnableInitialEvents(bool initialEvents)
     this->initialEvents = initialEvents;
 }
 
+void MotionSensor::Reset()
+{
+    updateCount = 0;
+    ResetAveraging();
+}
+
 void MotionSensor::SetMinTranslateSpeed(f32 speed)
 {
     minTranslateSpeed = speed;
@@ -55,6 +55,7 @@ public:
 
     void SetRelative(bool relative) override;
     void EnableInitialEvents(bool initialEvents) override;
+    void Reset() override;
 
     void SetMinTranslateSpeed(f32 speed) override;
     void SetMinRotateSpeed(f32 speed) override;
@@ -0,0 +1,54 @@
+
+#include "MotionTracker.h"
+#include "IGraphic.h"
+
+void MotionTracker::AddMoving(ITransformable *transformable)
+{
+    if (auto *graphic = dynamic_cast<IGraphic *>(transformable))
+        movingGraphics.Insert(graphic);
+
+    for (auto &elem : transformable->GetChildren())
+        AddMoving(elem);
+}
+
+void MotionTracker::Add(ITransformable *transformable)
+{
+    transformable->SetMoving(true);
+    AddMoving(transformable);
+}
+
+void MotionTracker::Remove(IGraphic *graphic)
+{
+    movingGraphics.SwapRemove(graphic);
+}
+
+void MotionTracker::CheckBeforeUpdate(ITransformable *transformable)
+{
+    // Moving until shown to be otherwise. If it moved during the last update
+    // this keeps it moving until the final transform has been rendered.
+    bool moved = transformable->HasMoved();
+    transformable->SetMoving(moved);
+
+    if (moved)
+        AddMoving(transformable);
+}
+
+void MotionTracker::CheckAfterUpdate(ITransformable *transformable)
+{
+    if (transformable->HasMoved())
+        Add(transformable);
+}
+
+void MotionTracker::RemoveStopped()
+{
+    stopped.clear();
+
+    for (auto &elem : movingGraphics)
+    {
+        if (!elem->IsMoving())
+            stopped.push_back(elem);
+    }
+
+    for (auto &elem : stopped)
+        movingGraphics.SwapRemove(elem);
+}
@@ -0,0 +1,45 @@
+#ifndef MOTION_TRACKER_H
+#define MOTION_TRACKER_H
+
+#include "litha_internal.h"
+#include <vector>
+
+class ITransformable;
+class IGraphic;
+
+// Keeps a list of the graphics that are moving, so that only those need
+// interpolating each frame. Most level meshes never move once placed.
+// Transformables are checked for movement at the start and end of each world
+// update (see ITransformable::HasMoved). A graphic is moving if it or any of
+// its parents has moved. Once stopped it stays on the list until it has been
+// sent its final transform.
+class MotionTracker
+{
+    IndexedSet<IGraphic *> movingGraphics;
+
+    // Scratch for RemoveStopped
+    std::vector<IGraphic *> stopped;
+
+    // Add this and all graphics below it in the scene graph.
+    void AddMoving(ITransformable *transformable);
+
+public:
+    // New or just repositioned with ApplyTransformNow.
+    void Add(ITransformable *transformable);
+    void Remove(IGraphic *graphic);
+
+    // At the start of a world update, before the transformable's state is
+    // cached. Catches anything moved between updates.
+    void CheckBeforeUpdate(ITransformable *transformable);
+
+    // After the world update, catches anything moved during it.
+    void CheckAfterUpdate(ITransformable *transformable);
+
+    // Graphics that need interpolating this frame.
+    const IndexedSet<IGraphic *> &GetMovingGraphics() { return movingGraphics; }
+
+    // Call once the moving graphics have been sent their render transforms.
+    void RemoveStopped();
+};
+
+#endif
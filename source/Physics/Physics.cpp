@@ -55,6 +55,8 @@ Physics::~Physics()
 
 void Physics::Step(f32 dt)
 {
+    PROFILE_ZONE("Physics::Step");
+
     dSpaceCollide(space, this, ODE_Callback);
     dWorldQuickStep(world, dt);
     dJointGroupEmpty(perStepContactJointGroup);
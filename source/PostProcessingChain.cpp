@@ -2,18 +2,18 @@
 #include "PostProcessingChain.h"
 #include "IShader.h"
 #include "Colors.h"
+#include "Event.h"
 
 // for RTT dropping bug (see below)
 #include "IEngine.h"
 #include "IRenderSystem.h"
 
-inline bool is_POT(s32 n)
-{
-    return (n) && !(n & (n - 1));
-}
+// Smallest input texture size
+const u32 MINIMUM_SIZE = 8;
 
 PostProcessingChain::PostProcessingChain(video::IVideoDriver *driver,
                                          bool renderScreen)
+    : renderTargets(driver)
 {
     this->driver = driver;
     this->renderScreen = renderScreen;
@@ -33,140 +33,128 @@ PostProcessingChain::PostProcessingChain(video::IVideoDriver *driver,
     quadVertices[1].Pos = core::vector3df(-1.0, 1.0, 0.0);
     quadVertices[2].Pos = core::vector3df(1.0, 1.0, 0.0);
     quadVertices[3].Pos = core::vector3df(1.0, -1.0, 0.0);
+
+    // Screen fraction effects need new render targets.
+    GetEngine()->RegisterEventInterest(this, "ScreenResize");
 }
 
 PostProcessingChain::~PostProcessingChain()
 {
-    // Remove all RTTs and drop all shaders
+    GetEngine()->UnregisterAllEventInterest(this);
+
+    // Drop all shaders. (RTTs are removed by the pool)
     for (auto &elem : effects)
     {
-        driver->removeTexture(elem.material.TextureLayer[0].Texture);
-
         if (elem.shader)
             elem.shader->drop();
     }
 }
 
-void PostProcessingChain::AddEffect(video::SMaterial &material, IShader *shader,
-                                    video::ITexture *rt)
+void PostProcessingChain::AddEffect(const Effect &effect)
 {
-    if (!rt)
-    {
-        WARN << "AddEffect failed.";
+    // This kind of hacked in here.
+    // Temporary fix for PP chain bug.
+    // (when PP chains are created but not used and are deleted, dropping of
+    // RTTs causes other textures to be dropped? An Irrlicht bug?).
+    if (!GetEngine()->GetRenderSystem()->PostProcessingEnabled())
         return;
-    }
 
-    NOTE << "Actual effect RTT size is {" << rt->getSize().Width << ","
-         << rt->getSize().Height << "}.";
+    core::dimension2du size = GetInputSize(effect);
+
+    NOTE << "AddEffect "
+         << "{" << size.Width << "," << size.Height << "}.";
 
-    if (shader)
+    if (size.Width < MINIMUM_SIZE || size.Height < MINIMUM_SIZE)
     {
-        shader->grab();
-        shader->ApplyToIrrMaterial(material);
+        WARN << "AddEffect aborted, screen fraction too small.";
+        return;
     }
 
-    // Create RTT
-    material.TextureLayer[0].Texture = rt;
+    effects.push_back(effect);
+
+    Effect &added = effects.back();
 
-    material.TextureLayer[0].TextureWrapU = video::ETC_CLAMP_TO_EDGE;
-    material.TextureLayer[0].TextureWrapV = video::ETC_CLAMP_TO_EDGE;
+    if (added.shader)
+    {
+        added.shader->grab();
+        added.shader->ApplyToIrrMaterial(added.material);
+    }
 
-    Effect effect = {material, shader};
+    added.material.TextureLayer[0].TextureWrapU = video::ETC_CLAMP_TO_EDGE;
+    added.material.TextureLayer[0].TextureWrapV = video::ETC_CLAMP_TO_EDGE;
 
-    effects.push_back(effect);
+    AllocateRenderTargets(false);
 }
 
-// Fallback is done as described here, however it is probably actually never
-// necessary as either Irrlicht or the graphics driver does a similar fallback
-// transparently. If the specific size of render target for an effect is not
-// available, it will fall back as follows:
-// - if non power-of-two, fall back to biggest POT dimensions smaller than the
-// specified dimensions
-// - then fall back dividing by 2 each time until one of the dimensions reaches
-// a minimum size If falling back, will output fallback size to console.
 void PostProcessingChain::AddEffect(video::SMaterial material, IShader *shader,
                                     core::dimension2du size)
 {
-    const u32 MINIMUM_POT = 8;
+    Effect effect = {material, shader, size, 0};
+    AddEffect(effect);
+}
 
-    // This kind of hacked in here.
-    // Temporary fix for PP chain bug.
-    // (when PP chains are created but not used and are deleted, dropping of
-    // RTTs causes other textures to be dropped? An Irrlicht bug?).
-    if (!GetEngine()->GetRenderSystem()->PostProcessingEnabled())
-        return;
+void PostProcessingChain::AddEffect(video::SMaterial material, IShader *shader,
+                                    u32 screenFraction)
+{
+    Effect effect = {material, shader, core::dimension2du(0, 0),
+                     screenFraction};
+    AddEffect(effect);
+}
 
-    NOTE << "AddEffect "
-         << "{" << size.Width << "," << size.Height << "}.";
+core::dimension2du PostProcessingChain::GetInputSize(const Effect &effect)
+{
+    if (effect.screenFraction)
+        return driver->getScreenSize() / effect.screenFraction;
+    else
+        return effect.size;
+}
 
-    if (size.Width < MINIMUM_POT || size.Height < MINIMUM_POT)
+void PostProcessingChain::AllocateRenderTargets(bool clear)
+{
+    // Too small? (e.g. window minimised) Keep the textures we have.
+    for (auto &elem : effects)
     {
-        WARN << "AddEffect aborted, screen fraction too small.";
-        return;
-    }
+        core::dimension2du size = GetInputSize(elem);
 
-    video::ITexture *rt =
-        driver->addRenderTargetTexture(size, "rt", video::ECF_A8R8G8B8);
-
-    if (!rt)
-    {
-        // if not POT
-        if ((!is_POT(size.Width)) || (!is_POT(size.Height)))
+        if (size.Width < MINIMUM_SIZE || size.Height < MINIMUM_SIZE)
         {
-            NOTE << "Not POT, falling back...";
+            WARN << "Post processing size too small {" << size.Width << ","
+                 << size.Height << "}, not reallocating.";
+            return;
+        }
+    }
 
-            // find greatest POT dimensions that are just smaller
-            // I guess this could be optimised??
+    if (clear)
+        renderTargets.Clear();
 
-            while (!is_POT(size.Width) && size.Width > MINIMUM_POT)
-                size.Width--;
+    // Each effect reads its input texture and renders into the next effect's.
+    // So the same texture can't be used by two effects in a row, but can be
+    // again after that. Same size effects alternate between two slots.
+    core::dimension2du lastSize;
+    u32 lastSlot = 0;
 
-            while (!is_POT(size.Height) && size.Height > MINIMUM_POT)
-                size.Height--;
-        }
+    for (u32 i = 0; i < effects.size(); i++)
+    {
+        core::dimension2du size = GetInputSize(effects[i]);
+        u32 slot = (i > 0 && size == lastSize) ? 1 - lastSlot : 0;
 
-        // Attempt creation again with POT sizes
-        NOTE << "Trying again: {" << size.Width << "," << size.Height << "}.";
-        rt = driver->addRenderTargetTexture(size, "rt", video::ECF_A8R8G8B8);
+        video::ITexture *rt = renderTargets.Get(size, slot);
 
-        // Still not created?
         if (!rt)
         {
-            // Decrease RTT size until success
-            while (true)
-            {
-                size /= 2;
-
-                // end if a dimension reaches a minimum size
-                if (size.Width < MINIMUM_POT || size.Height < MINIMUM_POT)
-                    break;
-
-                NOTE << "Trying yet again: {" << size.Width << ","
-                     << size.Height << "}.";
-
-                if ((rt = driver->addRenderTargetTexture(size, "rt",
-                                                         video::ECF_A8R8G8B8)))
-                    break;
-            }
+            WARN << "Failed to create RTT, post processing will be disabled.";
+            GetEngine()->GetRenderSystem()->ForceNoPostProcessing(true);
+            return;
         }
-    }
 
-    if (rt)
-    {
-        NOTE << "Success!";
-        AddEffect(material, shader, rt);
-    }
-    else
-    {
-        WARN << "Failed to create RTT, post processing will be disabled.";
-        GetEngine()->GetRenderSystem()->ForceNoPostProcessing(true);
+        effects[i].material.TextureLayer[0].Texture = rt;
+
+        lastSize = size;
+        lastSlot = slot;
     }
-}
 
-void PostProcessingChain::AddEffect(video::SMaterial material, IShader *shader,
-                                    u32 screenFraction)
-{
-    AddEffect(material, shader, driver->getScreenSize() / screenFraction);
+    NOTE << effects.size() << " post processing effects using "
+         << renderTargets.GetTextureCount() << " render targets.";
 }
 
 video::ITexture *PostProcessingChain::GetInputTexture()
@@ -184,6 +172,8 @@ video::ITexture *PostProcessingChain::GetInputTexture()
 
 void PostProcessingChain::Process()
 {
+    PROFILE_ZONE("PostProcessingChain::Process");
+
     // Render each effect's texture into the next.
     // Last effect is excluded as it renders to screen (and must be called at a
     // different time)
@@ -200,6 +190,9 @@ void PostProcessingChain::Process()
 
 void PostProcessingChain::ApplyToScreen()
 {
+    if (effects.empty())
+        return;
+
     // Last effect rendered to screen
     // If screen hasn't been rendered to, we must also clear the frame buffer.
     // (as it may have stuff left over from rendering to textures in it)
@@ -209,3 +202,18 @@ void PostProcessingChain::ApplyToScreen()
     driver->setMaterial(effects[effects.size() - 1].material);
     driver->drawIndexedTriangleList(quadVertices, 4, quadIndices, 2);
 }
+
+void PostProcessingChain::OnEvent(const Event &event)
+{
+    if (event.IsType("ScreenResize"))
+    {
+        for (auto &elem : effects)
+        {
+            if (elem.screenFraction)
+            {
+                AllocateRenderTargets(true);
+                return;
+            }
+        }
+    }
+}
@@ -1,17 +1,23 @@
-
 #ifndef POST_PROCESSING_CHAIN_H
 #define POST_PROCESSING_CHAIN_H
 
 #include "IPostProcessingChain.h"
+#include "IWantEvents.h"
+#include "RenderTargetPool.h"
 #include <vector>
 
 struct Effect
 {
     video::SMaterial material;
     IShader *shader;
+
+    // Size of the input texture. Either fixed, or a fraction of the screen
+    // size if screenFraction is not zero.
+    core::dimension2du size;
+    u32 screenFraction;
 };
 
-class PostProcessingChain : public IPostProcessingChain
+class PostProcessingChain : public IPostProcessingChain, public IWantEvents
 {
     video::IVideoDriver *driver;
 
@@ -19,12 +25,20 @@ class PostProcessingChain : public IPostProcessingChain
 
     std::vector<Effect> effects;
 
+    // Input textures of all effects
+    RenderTargetPool renderTargets;
+
     // Screen quad used for rendering effects
     video::S3DVertex quadVertices[4];
     u16 quadIndices[6];
 
-    void AddEffect(video::SMaterial &material, IShader *shader,
-                   video::ITexture *rt);
+    void AddEffect(const Effect &effect);
+
+    core::dimension2du GetInputSize(const Effect &effect);
+
+    // Give each effect an input texture. Existing textures are reused unless
+    // cleared.
+    void AllocateRenderTargets(bool clear);
 
 public:
     PostProcessingChain(video::IVideoDriver *driver, bool renderScreen);
@@ -43,6 +57,8 @@ public:
     void Process() override;
 
     void ApplyToScreen() override;
+
+    void OnEvent(const Event &event) override;
 };
 
 #endif
@@ -0,0 +1,80 @@
+
+#include "RenderQueue.h"
+#include "IGraphic.h"
+
+void RenderQueue::Build(const IndexedSet<IGraphic *> &graphics)
+{
+    PROFILE_ZONE("RenderQueue::Build");
+
+    itemPassCounts.resize(graphics.size());
+
+    // Default to at least one pass so that non Litha Engine managed objects
+    // (other Irrlicht scene nodes) get rendered.
+    u16 passCount = 1;
+
+    for (u32 i = 0; i < graphics.size(); i++)
+    {
+        itemPassCounts[i] = graphics[i]->GetPassCount();
+
+        if (itemPassCounts[i] > passCount)
+            passCount = itemPassCounts[i];
+    }
+
+    // Counting sort on pass count, most passes first.
+    // Nearly everything has a single pass so this is just a copy really.
+    countsPerPass.assign(passCount + 1, 0);
+
+    for (u32 i = 0; i < graphics.size(); i++)
+        countsPerPass[itemPassCounts[i]]++;
+
+    passEnds.resize(passCount);
+
+    u32 end = 0;
+
+    for (s32 i = passCount - 1; i >= 0; i--)
+    {
+        end += countsPerPass[i + 1];
+        passEnds[i] = end;
+    }
+
+    // countsPerPass becomes the insert position for each pass count.
+    u32 start = 0;
+
+    for (s32 i = passCount; i >= 0; i--)
+    {
+        u32 count = countsPerPass[i];
+        countsPerPass[i] = start;
+        start += count;
+    }
+
+    items.resize(graphics.size());
+
+    for (u32 i = 0; i < graphics.size(); i++)
+        items[countsPerPass[itemPassCounts[i]]++] = graphics[i];
+}
+
+u16 RenderQueue::GetPassCount() const
+{
+    return passEnds.size() ? passEnds.size() : 1;
+}
+
+void RenderQueue::PreparePass(u16 pass)
+{
+    ASSERT(pass < passEnds.size());
+
+    // Items up to passEnds[pass] have this pass, those from there up to the
+    // previous pass's end have just run out of passes and need hiding.
+    // Anything after that was hidden by an earlier pass.
+    u32 end = pass > 0 ? passEnds[pass - 1] : items.size();
+
+    for (u32 i = 0; i < end; i++)
+        items[i]->SetCurrentPass(pass);
+}
+
+void RenderQueue::RenderPass(u16 pass)
+{
+    ASSERT(pass < passEnds.size());
+
+    for (u32 i = 0; i < passEnds[pass]; i++)
+        items[i]->Render(pass);
+}
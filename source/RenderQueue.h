@@ -0,0 +1,44 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "litha_internal.h"
+#include <vector>
+
+class IGraphic;
+
+// Works out which graphics need preparing and rendering for each pass.
+// Graphics are bucketed by pass count once per frame, so a pass only touches
+// the graphics that have it (plus those whose last pass has just been drawn,
+// so they can hide themselves) rather than every graphic.
+// This decides which graphics take part in a pass, not the order things are
+// drawn in. Irrlicht's drawAll sorts solid nodes by texture and transparent
+// ones by depth, and MeshBatcher sorts its batches by shader and texture.
+class RenderQueue
+{
+    // Graphics with the most passes first.
+    std::vector<IGraphic *> items;
+
+    // passEnds[i] is the number of items that have pass i.
+    // (all items before that index do)
+    std::vector<u32> passEnds;
+
+    // Scratch for Build
+    std::vector<u16> itemPassCounts;
+    std::vector<u32> countsPerPass;
+
+public:
+    // Collect graphics for this frame.
+    void Build(const IndexedSet<IGraphic *> &graphics);
+
+    // Greatest pass count of any graphic, at least 1.
+    u16 GetPassCount() const;
+
+    // Call IGraphic::SetCurrentPass on graphics with this pass, and on those
+    // whose passes ended with the previous one.
+    void PreparePass(u16 pass);
+
+    // Call IGraphic::Render on graphics with this pass.
+    void RenderPass(u16 pass);
+};
+
+#endif
@@ -0,0 +1,124 @@
+
+#include "RenderTargetPool.h"
+
+inline bool is_POT(s32 n)
+{
+    return (n) && !(n & (n - 1));
+}
+
+RenderTargetPool::RenderTargetPool(video::IVideoDriver *driver)
+{
+    this->driver = driver;
+}
+
+RenderTargetPool::~RenderTargetPool()
+{
+    Clear();
+}
+
+// Fallback is probably never actually necessary, as either Irrlicht or the
+// graphics driver does a similar fallback transparently. It goes:
+// - if non power-of-two, fall back to biggest POT dimensions smaller than the
+// specified dimensions
+// - then fall back dividing by 2 each time until one of the dimensions reaches
+// a minimum size
+video::ITexture *RenderTargetPool::Create(core::dimension2du size)
+{
+    const u32 MINIMUM_POT = 8;
+
+    for (auto &elem : fallbacks)
+    {
+        if (elem.requestedSize == size)
+        {
+            if (elem.size.Width == 0)
+                return nullptr;
+
+            return driver->addRenderTargetTexture(elem.size, "rt",
+                                                  video::ECF_A8R8G8B8);
+        }
+    }
+
+    Fallback fallback;
+    fallback.requestedSize = size;
+
+    video::ITexture *rt =
+        driver->addRenderTargetTexture(size, "rt", video::ECF_A8R8G8B8);
+
+    if (!rt)
+    {
+        // if not POT
+        if ((!is_POT(size.Width)) || (!is_POT(size.Height)))
+        {
+            NOTE << "Not POT, falling back...";
+
+            // find greatest POT dimensions that are just smaller
+            while (!is_POT(size.Width) && size.Width > MINIMUM_POT)
+                size.Width--;
+
+            while (!is_POT(size.Height) && size.Height > MINIMUM_POT)
+                size.Height--;
+        }
+
+        // Attempt creation again with POT sizes
+        NOTE << "Trying again: {" << size.Width << "," << size.Height << "}.";
+        rt = driver->addRenderTargetTexture(size, "rt", video::ECF_A8R8G8B8);
+
+        // Still not created?
+        if (!rt)
+        {
+            // Decrease RTT size until success
+            while (true)
+            {
+                size /= 2;
+
+                // end if a dimension reaches a minimum size
+                if (size.Width < MINIMUM_POT || size.Height < MINIMUM_POT)
+                    break;
+
+                NOTE << "Trying yet again: {" << size.Width << ","
+                     << size.Height << "}.";
+
+                if ((rt = driver->addRenderTargetTexture(size, "rt",
+                                                         video::ECF_A8R8G8B8)))
+                    break;
+            }
+        }
+
+        // Don't search again next time.
+        fallback.size = rt ? size : core::dimension2du(0, 0);
+        fallbacks.push_back(fallback);
+    }
+
+    return rt;
+}
+
+video::ITexture *RenderTargetPool::Get(const core::dimension2du &size, u32 slot)
+{
+    for (auto &elem : targets)
+    {
+        if (elem.size == size && elem.slot == slot)
+            return elem.texture;
+    }
+
+    video::ITexture *rt = Create(size);
+
+    if (!rt)
+        return nullptr;
+
+    NOTE << "Created render target {" << rt->getSize().Width << ","
+         << rt->getSize().Height << "} for {" << size.Width << ","
+         << size.Height << "} slot " << slot << ".";
+
+    Target target = {size, slot, rt};
+    targets.push_back(target);
+
+    return rt;
+}
+
+void RenderTargetPool::Clear()
+{
+    for (auto &elem : targets)
+        driver->removeTexture(elem.texture);
+
+    targets.clear();
+}
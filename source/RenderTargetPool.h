@@ -0,0 +1,51 @@
+#ifndef RENDER_TARGET_POOL_H
+#define RENDER_TARGET_POOL_H
+
+#include "litha_internal.h"
+#include <vector>
+
+// Render target textures, shared by size.
+// Each size has numbered slots, so that consecutive users of the same size can
+// ping-pong between two textures rather than each having their own.
+// If a size can't be created, smaller power of two sizes are tried. The result
+// is remembered so the search is only done once for each size.
+class RenderTargetPool
+{
+    video::IVideoDriver *driver;
+
+    struct Target
+    {
+        core::dimension2du size; // as requested
+        u32 slot;
+        video::ITexture *texture;
+    };
+
+    std::vector<Target> targets;
+
+    // What was actually created for a requested size.
+    // (zero if nothing could be)
+    struct Fallback
+    {
+        core::dimension2du requestedSize;
+        core::dimension2du size;
+    };
+
+    std::vector<Fallback> fallbacks;
+
+    video::ITexture *Create(core::dimension2du size);
+
+public:
+    RenderTargetPool(video::IVideoDriver *driver);
+    ~RenderTargetPool();
+
+    // Get the texture for a size and slot, creating it if necessary.
+    // The texture may be smaller than asked for. Returns NULL on failure.
+    video::ITexture *Get(const core::dimension2du &size, u32 slot);
+
+    // Remove all textures. (e.g. when the screen size changes)
+    void Clear();
+
+    u32 GetTextureCount() const { return targets.size(); }
+};
+
+#endif
@@ -8,6 +8,7 @@
 #include "Shader.h"
 #include "Event.h"
 #include "Colors.h"
+#include <chrono>
 
 RenderTask::RenderTask(World *world)
 {
@@ -41,10 +42,19 @@ RenderTask::RenderTask(World *world)
     SetBackgroundCol(Colors::black());
 
     renderInvisible = false;
+
+    profilerOverlay = false;
+
+    dynamicResolutionEnabled = false;
+    sceneTarget = nullptr;
+    renderScaled = false;
 }
 
 RenderTask::~RenderTask()
 {
+    if (sceneTarget)
+        driver->removeTexture(sceneTarget);
+
     if (ppChain)
         ppChain->drop();
 
@@ -77,6 +87,20 @@ IShader *RenderTask::CreateShader(const c8 *vertexShaderFileName,
                                        pixelShaderFileName, baseMaterial);
 }
 
+IShader *RenderTask::GetSharedShader(const c8 *vertexShaderFileName,
+                                     const c8 *pixelShaderFileName,
+                                     video::E_MATERIAL_TYPE baseMaterial,
+                                     bool *created)
+{
+    return shaderManager->GetSharedShader(
+        vertexShaderFileName, pixelShaderFileName, baseMaterial, created);
+}
+
+u32 RenderTask::PreloadShaders(const io::path &manifestFile)
+{
+    return shaderManager->PreloadShaders(manifestFile);
+}
+
 bool RenderTask::ShadersAreAvailable()
 {
     return shaderManager->ShadersAreAvailable();
@@ -149,6 +173,56 @@ bool RenderTask::IsFading()
     return !isFadeFinished;
 }
 
+void RenderTask::SetDynamicResolution(bool enabled, f32 targetFrameMs,
+                                      f32 minScale, f32 maxScale)
+{
+    dynamicResolutionEnabled = enabled;
+    dynamicResolution.SetParams(targetFrameMs, minScale, maxScale);
+
+    if (!enabled && sceneTarget)
+    {
+        driver->removeTexture(sceneTarget);
+        sceneTarget = nullptr;
+    }
+}
+
+f32 RenderTask::GetResolutionScale()
+{
+    return dynamicResolutionEnabled ? dynamicResolution.GetScale() : 1.f;
+}
+
+bool RenderTask::UpdateSceneTarget()
+{
+    core::dimension2du screenSize = driver->getScreenSize();
+
+    // Full screen size, so it needn't be recreated as the scale changes.
+    if (sceneTarget && sceneTarget->getSize() != screenSize)
+    {
+        driver->removeTexture(sceneTarget);
+        sceneTarget = nullptr;
+    }
+
+    if (!sceneTarget)
+    {
+        if (driver->queryFeature(video::EVDF_RENDER_TO_TARGET))
+            sceneTarget = driver->addRenderTargetTexture(screenSize,
+                                                         "DynamicResolution");
+
+        if (!sceneTarget)
+        {
+            WARN << "Could not create render target, disabling dynamic "
+                    "resolution";
+            dynamicResolutionEnabled = false;
+            return false;
+        }
+    }
+
+    core::dimension2du size = dynamicResolution.GetSize(screenSize);
+    sceneViewPort = core::recti(0, 0, size.Width, size.Height);
+
+    return true;
+}
+
 void RenderTask::RenderInvisible()
 {
     renderInvisible = true;
@@ -158,44 +232,62 @@ void RenderTask::RenderInvisible()
 
 void RenderTask::Update(f32 dt)
 {
-    const Set<IGraphic *> &graphics = world->GetAllGraphics();
+    // Each render is a frame as far as the profiler is concerned.
+    // (so includes any logic updates since the last one)
+    PROFILE_FRAME();
+    PROFILE_ZONE("RenderTask::Update");
+
+    auto frameStart = std::chrono::steady_clock::now();
+
+    const IndexedSet<IGraphic *> &graphics = world->GetAllGraphics();
 
     f32 logicInterpolationAlpha = engine->GetLogicInterpolationAlpha();
 
-    // - Through graphics, set transform to interpolated (from last logic
-    // transform to current transform)
+    // - Through moving graphics, set transform to interpolated (from last
+    // logic transform to current transform). Graphics that aren't moving keep
+    // the transform they were last sent.
     // - Rendering (custom Graphic.Render plus Irrlicht drawAll)
 
-    for (u32 i = 0; i < graphics.size(); i++)
+    MotionTracker &motionTracker = world->GetMotionTracker();
+    const IndexedSet<IGraphic *> &movingGraphics =
+        motionTracker.GetMovingGraphics();
+
+    for (u32 i = 0; i < movingGraphics.size(); i++)
     {
         // Interpolate
 
-        graphics[i]->ReceiveRenderPosition(
-            graphics[i]->GetInterpolatedAbsolutePosition(
+        movingGraphics[i]->ReceiveRenderPosition(
+            movingGraphics[i]->GetInterpolatedAbsolutePosition(
                 logicInterpolationAlpha));
-        graphics[i]->ReceiveRenderRotation(
-            graphics[i]->GetInterpolatedAbsoluteRotation(
+        movingGraphics[i]->ReceiveRenderRotation(
+            movingGraphics[i]->GetInterpolatedAbsoluteRotation(
                 logicInterpolationAlpha));
     }
 
+    motionTracker.RemoveStopped();
+
     // Multipass rendering.
-    // Need to first count the maximum passes required (find which IGraphic has
-    // greatest GetPassCount()). Then smgr->drawAll and IGraphic.Render for each
-    // pass, calling SetCurrentPass on *ALL* IGraphics before each drawAll.
+    // Graphics are sorted by pass count, so that each pass need only prepare
+    // and render those graphics that have it. See Render below.
+    renderQueue.Build(graphics);
+    u16 passCount = renderQueue.GetPassCount();
 
-    // Count number of passes (through all IGraphics, and find the maximum pass
-    // count) Default to at least one pass so that non Litha Engine managed
-    // objects (other Irrlicht scene nodes) get rendered.
-    u16 passCount = 1;
+    shaderManager->BeginFrame(GetUpdater().GetVirtualTime());
+
+    driver->beginScene(true, true, backgroundCol);
 
-    for (u32 i = 0; i < graphics.size(); i++)
+    renderScaled = dynamicResolutionEnabled && UpdateSceneTarget() &&
+                   dynamicResolution.GetScale() < 1.f;
+
+    // Render the scene just once at the lower resolution, then stretch that
+    // wherever the scene is wanted.
+    if (renderScaled)
     {
-        if (graphics[i]->GetPassCount() > passCount)
-            passCount = graphics[i]->GetPassCount();
+        driver->setRenderTarget(sceneTarget, true, true, backgroundCol);
+        driver->setViewPort(sceneViewPort);
+        Render(passCount);
     }
 
-    driver->beginScene(true, true, backgroundCol);
-
     if (ppChain && PostProcessingEnabled())
     {
         // If a post processing chain is set, we must first render to its input
@@ -205,7 +297,7 @@ void RenderTask::Update(f32 dt)
             driver->setRenderTarget(ppChain->GetInputTexture(), true, true,
                                     backgroundCol);
 
-            Render(passCount);
+            RenderScene(passCount);
 
             // Render all steps in the post processing chain.
             ppChain->Process();
@@ -218,7 +310,7 @@ void RenderTask::Update(f32 dt)
         {
             driver->setRenderTarget(video::ERT_FRAME_BUFFER, true, true,
                                     backgroundCol);
-            Render(passCount);
+            RenderScene(passCount);
         }
 
         // Apply post processing effects to screen.
@@ -228,7 +320,7 @@ void RenderTask::Update(f32 dt)
     {
         driver->setRenderTarget(video::ERT_FRAME_BUFFER, true, true,
                                 backgroundCol);
-        Render(passCount);
+        RenderScene(passCount);
     }
 
     // Reset render distination
@@ -250,6 +342,11 @@ void RenderTask::Update(f32 dt)
     if (fadeGUI) // Render fade after GUI
         RenderFade();
 
+#if LITHA_PROFILER
+    if (profilerOverlay)
+        RenderProfilerOverlay();
+#endif
+
     // Draw the background colour over the top?
     // This can be useful to init animations and stuff...
     // i.e. is a HACK!!
@@ -264,28 +361,59 @@ void RenderTask::Update(f32 dt)
 
     driver->endScene();
 
+    // GPU time can't be queried through Irrlicht, so this is the time to
+    // submit everything plus the swap.
+    if (dynamicResolutionEnabled && !renderInvisible)
+    {
+        dynamicResolution.AddFrameTime(
+            (f32)std::chrono::duration<f64, std::milli>(
+                std::chrono::steady_clock::now() - frameStart)
+                .count());
+    }
+
     // Super
     Task::Update(dt);
 }
 
+void RenderTask::RenderScene(u16 passCount)
+{
+    if (!renderScaled)
+    {
+        Render(passCount);
+        return;
+    }
+
+    PROFILE_ZONE("RenderTask::RenderScene");
+
+    core::dimension2du size = driver->getCurrentRenderTargetSize();
+
+#if IRRLICHT_VERSION_MAJOR > 1 || IRRLICHT_VERSION_MINOR >= 8
+    // Smooth rather than blocky when stretched.
+    driver->getMaterial2D().TextureLayer[0].BilinearFilter = true;
+    driver->enableMaterial2D(true);
+#endif
+
+    driver->draw2DImage(sceneTarget, core::recti(0, 0, size.Width, size.Height),
+                        sceneViewPort);
+
+#if IRRLICHT_VERSION_MAJOR > 1 || IRRLICHT_VERSION_MINOR >= 8
+    driver->enableMaterial2D(false);
+#endif
+}
+
 void RenderTask::Render(u16 passCount)
 {
-    const Set<IGraphic *> &graphics = world->GetAllGraphics();
+    PROFILE_ZONE("RenderTask::Render");
 
     // Render each pass
-    // (this was nested in some other loop, that's why the iterator starts at j)
-
     for (u16 i = 0; i < passCount; i++)
     {
         // Prepare each IGraphic for this pass.
         // The most likely use for this is to modify the materials of any
-        // wrapped irrlicht scene nodes. This is called for each pass of a
-        // graphic irrespective of whether the graphic has the pass set. This is
-        // so the graphic can set any scene nodes invisible if they are not to
-        // be rendered this pass.
-
-        for (u32 j = 0; j < graphics.size(); j++)
-            graphics[j]->SetCurrentPass(i);
+        // wrapped irrlicht scene nodes. This is called for each graphic with
+        // the pass, and once more for the pass after its last, so the graphic
+        // can set any scene nodes invisible that are not to be rendered.
+        renderQueue.PreparePass(i);
 
         // Render the entire world
         smgr->drawAll();
@@ -295,12 +423,7 @@ void RenderTask::Render(u16 passCount)
         // and will do nothing, as graphics rendering (of Irrlicht scene nodes)
         // is usually handled by Irrlicht internally. (and rendered in
         // ISceneManager->drawAll() )
-
-        for (u32 j = 0; j < graphics.size(); j++)
-        {
-            if (graphics[j]->GetPassCount() > i)
-                graphics[j]->Render(i);
-        }
+        renderQueue.RenderPass(i);
     }
 
     // To have the GUI post processed, would need to modify Irrlicht.
@@ -319,6 +442,30 @@ void RenderTask::Render(u16 passCount)
     // guienv->drawAll();
 }
 
+void RenderTask::ShowProfilerOverlay(bool show)
+{
+    profilerOverlay = show;
+}
+
+void RenderTask::RenderProfilerOverlay()
+{
+#if LITHA_PROFILER
+    gui::IGUIFont *font = guienv->getBuiltInFont();
+
+    if (!font)
+        return;
+
+    core::stringw text = utils::profile::get_last_frame_summary().c_str();
+    core::dimension2du size = font->getDimension(text.c_str());
+    core::recti rect(5, 5, 15 + size.Width, 15 + size.Height);
+
+    driver->draw2DRectangle(video::SColor(160, 0, 0, 0), rect);
+
+    rect.UpperLeftCorner += core::vector2di(5, 5);
+    font->draw(text, rect, video::SColor(255, 255, 255, 255));
+#endif
+}
+
 void RenderTask::RenderFade()
 {
     // default is fade has finished
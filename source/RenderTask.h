@@ -1,6 +1,8 @@
 
 #include "Task.h"
 #include "IRenderSystem.h"
+#include "RenderQueue.h"
+#include "DynamicResolution.h"
 
 class IEngine;
 class World;
@@ -18,6 +20,9 @@ class RenderTask : public Task, public IRenderSystem
 
     ShaderManager *shaderManager;
 
+    // Graphics to prepare and render for each pass, built each frame.
+    RenderQueue renderQueue;
+
     // currently set post processing chain
     IPostProcessingChain *ppChain;
     bool postProcessingEnabled;
@@ -38,8 +43,23 @@ class RenderTask : public Task, public IRenderSystem
 
     bool renderInvisible;
 
+    // Show the profiler's last frame over the GUI?
+    bool profilerOverlay;
+
+    // Dynamic resolution.
+    // The scene is rendered into part of sceneTarget (sceneViewPort), which
+    // is then stretched over whatever wants the scene.
+    bool dynamicResolutionEnabled;
+    DynamicResolution dynamicResolution;
+    video::ITexture *sceneTarget;
+    core::recti sceneViewPort;
+    bool renderScaled; // this frame
+
+    bool UpdateSceneTarget();
+    void RenderScene(u16 passCount);
     void Render(u16 passCount);
     void RenderFade();
+    void RenderProfilerOverlay();
 
 public:
     RenderTask(World *world);
@@ -56,6 +76,13 @@ public:
                           const c8 *pixelShaderFileName,
                           video::E_MATERIAL_TYPE baseMaterial) override;
 
+    IShader *GetSharedShader(const c8 *vertexShaderFileName,
+                             const c8 *pixelShaderFileName,
+                             video::E_MATERIAL_TYPE baseMaterial,
+                             bool *created) override;
+
+    u32 PreloadShaders(const io::path &manifestFile) override;
+
     bool ShadersAreAvailable() override;
     bool PostProcessingEnabled() override;
     void ForceNoShaders(bool noShaders) override;
@@ -71,8 +98,14 @@ public:
         backgroundCol = col;
     }
 
+    void SetDynamicResolution(bool enabled, f32 targetFrameMs, f32 minScale,
+                              f32 maxScale) override;
+    f32 GetResolutionScale() override;
+
     void RenderInvisible() override;
 
+    void ShowProfilerOverlay(bool show) override;
+
     // Task methods
     void Update(f32 dt) override;
 };
@@ -22,63 +22,91 @@ Shader::~Shader()
     if (callback)
         callback->drop();
 
+    shaderInstance->ForgetShader(this);
     shaderManager->UnregisterShader(this);
 }
 
 void Shader::SetVertexRegisterMap(const LowLevelShaderRegisterMap &registerMap)
 {
-    vertexRegisterMap = registerMap;
+    constants.SetRegisterMap(registerMap, false);
 }
 
 void Shader::SetPixelRegisterMap(const LowLevelShaderRegisterMap &registerMap)
 {
-    pixelRegisterMap = registerMap;
+    constants.SetRegisterMap(registerMap, true);
 }
 
 void Shader::SetVertexConstant(const c8 *name, s32 value)
 {
-    vertexShaderConstants[core::stringc(name)] =
-        std::vector<f32>(1, s32_As_f32(value));
+    f32 f = s32_As_f32(value);
+    constants.Set(name, false, &f, 1);
 }
 
 void Shader::SetVertexConstant(const c8 *name, f32 value)
 {
-    vertexShaderConstants[core::stringc(name)] = std::vector<f32>(1, value);
+    constants.Set(name, false, &value, 1);
 }
 
 void Shader::SetVertexConstants(const c8 *name, s32 *values, u16 count)
 {
-    vertexShaderConstants[core::stringc(name)] =
-        valuesToVector((void *)values, count);
+    constants.Set(name, false, (f32 *)values, count);
 }
 
 void Shader::SetVertexConstants(const c8 *name, f32 *values, u16 count)
 {
-    vertexShaderConstants[core::stringc(name)] =
-        valuesToVector((void *)values, count);
+    constants.Set(name, false, values, count);
 }
 
 void Shader::SetPixelConstant(const c8 *name, s32 value)
 {
-    pixelShaderConstants[core::stringc(name)] =
-        std::vector<f32>(1, s32_As_f32(value));
+    f32 f = s32_As_f32(value);
+    constants.Set(name, true, &f, 1);
 }
 
 void Shader::SetPixelConstant(const c8 *name, f32 value)
 {
-    pixelShaderConstants[core::stringc(name)] = std::vector<f32>(1, value);
+    constants.Set(name, true, &value, 1);
 }
 
 void Shader::SetPixelConstants(const c8 *name, s32 *values, u16 count)
 {
-    pixelShaderConstants[core::stringc(name)] =
-        valuesToVector((void *)values, count);
+    constants.Set(name, true, (f32 *)values, count);
 }
 
 void Shader::SetPixelConstants(const c8 *name, f32 *values, u16 count)
 {
-    pixelShaderConstants[core::stringc(name)] =
-        valuesToVector((void *)values, count);
+    constants.Set(name, true, values, count);
+}
+
+void Shader::SetAutoConstant(const c8 *name, E_AUTO_SHADER_CONSTANT type,
+                             bool pixel)
+{
+    AutoConstant autoConstant;
+    autoConstant.index = constants.GetIndex(
+        name, pixel, ShaderManager::GetAutoConstantSize(type));
+    autoConstant.type = type;
+
+    for (auto &elem : autoConstants)
+    {
+        if (elem.index == autoConstant.index)
+        {
+            elem.type = type;
+            return;
+        }
+    }
+
+    autoConstants.push_back(autoConstant);
+}
+
+void Shader::SetAutoVertexConstant(const c8 *name,
+                                   E_AUTO_SHADER_CONSTANT type)
+{
+    SetAutoConstant(name, type, false);
+}
+
+void Shader::SetAutoPixelConstant(const c8 *name, E_AUTO_SHADER_CONSTANT type)
+{
+    SetAutoConstant(name, type, true);
 }
 
 void Shader::SetCallback(IShaderCallback *callback)
@@ -92,7 +120,7 @@ void Shader::ApplyToIrrMaterial(video::SMaterial &material)
         (video::E_MATERIAL_TYPE)shaderInstance->GetIrrMaterialId();
 
     // Also set to the unique ID of this for setting constants.
-    material.MaterialTypeParam2 = *((f32 *)(&shaderId));
+    material.MaterialTypeParam2 = ShaderManager::ShaderIdToParam(shaderId);
 }
 
 void Shader::ClearFromIrrMaterial(video::SMaterial &material,
@@ -108,121 +136,20 @@ void Shader::OnSetConstants(video::IMaterialRendererServices *services,
     if (callback)
         callback->ShaderOnSetConstants(this);
 
-    if (shaderManager->GetShaderLevel() == ESL_HIGH)
-    {
-        // Set all vertex shader constants
-        for (std::map<core::stringc, std::vector<f32>>::const_iterator i =
-                 vertexShaderConstants.begin();
-             i != vertexShaderConstants.end(); i++)
-        {
-            const core::stringc &name = i->first;
-            const std::vector<f32> &floats = i->second;
-
-            services->setVertexShaderConstant(name.c_str(), &floats[0],
-                                              floats.size());
-        }
+    f32 values[16];
 
-        // Set all pixel shader constants
-        for (std::map<core::stringc, std::vector<f32>>::const_iterator i =
-                 pixelShaderConstants.begin();
-             i != pixelShaderConstants.end(); i++)
-        {
-            const core::stringc &name = i->first;
-            const std::vector<f32> &floats = i->second;
-
-            services->setPixelShaderConstant(name.c_str(), &floats[0],
-                                             floats.size());
-        }
-    }
-    else // ESL_LOW, low level shaders.
+    for (auto &elem : autoConstants)
     {
-        // For low level shaders, we set registers, not named variables.
-        // LowLevelShaderRegisterMap contains the register -> named variable
-        // mappings.
+        shaderManager->GetAutoConstant(elem.type, values);
+        constants.Set(elem.index, values);
+    }
 
-        // vertex shaders (using vertexRegisterMap)
-        {
-            // Just a list of names... which map in to vertexShaderConstants.
-            const std::vector<LowLevelShaderRegisterMap::RegisterComponentGroup>
-                &names = vertexRegisterMap.GetRegisterComponentNames();
-            std::vector<f32> data;
-
-            for (auto &name : names)
-            {
-                LowLevelShaderRegisterMap::RegisterComponentGroup rcg = name;
-
-                // Name NULL or doesn't exist in named variable map?
-                // Unused, just add zeroes.
-                if (rcg.name.size() == 0 ||
-                    vertexShaderConstants.count(rcg.name) == 0)
-                {
-                    for (u32 j = 0; j < rcg.size; j++)
-                        data.push_back(0.f);
-
-                    continue;
-                }
-
-                const std::vector<f32> &groupFloats =
-                    vertexShaderConstants[rcg.name];
-
-                // Must match the number of register components!
-                ASSERT(groupFloats.size() == rcg.size);
-
-                // Add it to the data
-                for (auto &groupFloat : groupFloats)
-                    data.push_back(groupFloat);
-            }
-
-            // Each register has 4 components.
-            // This should have been enforced by LowLevelShaderRegisterMap
-            // class.
-            ASSERT(data.size() % 4 == 0);
-            if (!data.empty())
-                services->setVertexShaderConstant(&(data[0]), 0,
-                                                  data.size() / 4);
-        }
+    // Constants are kept by the GPU program, so unchanged ones can be skipped
+    // unless another Shader sharing the program set its own since.
+    bool all = shaderInstance->SetConstantsOwner(this);
 
-        // pixel shaders (using pixelRegisterMap)
-        // basically copy pasted from above.
-        {
-            // Just a list of names... which map in to vertexShaderConstants.
-            const std::vector<LowLevelShaderRegisterMap::RegisterComponentGroup>
-                &names = pixelRegisterMap.GetRegisterComponentNames();
-            std::vector<f32> data;
-
-            for (auto &name : names)
-            {
-                LowLevelShaderRegisterMap::RegisterComponentGroup rcg = name;
-
-                // Name NULL or doesn't exist in named variable map?
-                // Unused, just add zeroes.
-                if (rcg.name.size() == 0 ||
-                    pixelShaderConstants.count(rcg.name) == 0)
-                {
-                    for (u32 j = 0; j < rcg.size; j++)
-                        data.push_back(0.f);
-
-                    continue;
-                }
-
-                const std::vector<f32> &groupFloats =
-                    pixelShaderConstants[rcg.name];
-
-                // Must match the number of register components!
-                ASSERT(groupFloats.size() == rcg.size);
-
-                // Add it to the data
-                for (auto &groupFloat : groupFloats)
-                    data.push_back(groupFloat);
-            }
-
-            // Each register has 4 components.
-            // This should have been enforced by LowLevelShaderRegisterMap
-            // class.
-            ASSERT(data.size() % 4 == 0);
-            if (!data.empty())
-                services->setPixelShaderConstant(&(data[0]), 0,
-                                                 data.size() / 4);
-        }
-    }
+    if (shaderManager->GetShaderLevel() == ESL_HIGH)
+        constants.UploadHighLevel(services, all);
+    else // ESL_LOW, low level shaders set registers using the register maps.
+        constants.UploadLowLevel(services, all);
 }
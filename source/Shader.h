@@ -4,9 +4,9 @@
 
 #include "IShader.h"
 #include <vector>
-#include <map>
 
 #include "ShaderInstanceDef.h"
+#include "ShaderConstants.h"
 
 class ShaderManager;
 class ShaderInstance;
@@ -23,29 +23,22 @@ class Shader : public IShader
 
     u32 shaderId;
 
-    std::map<core::stringc, std::vector<f32>> vertexShaderConstants;
-    std::map<core::stringc, std::vector<f32>> pixelShaderConstants;
-
-    LowLevelShaderRegisterMap vertexRegisterMap;
-    LowLevelShaderRegisterMap pixelRegisterMap;
+    ShaderConstants constants;
 
     IShaderCallback *callback;
 
-    f32 s32_As_f32(s32 value) { return *((f32 *)(&value)); }
-
-    // Converts array of arbitrary 32bit values to a vector of floats
-    // (i.e. these could either be f32* or s32*)
-    std::vector<f32> valuesToVector(void *values, u16 count)
+    struct AutoConstant
     {
-        f32 *floats = (f32 *)values;
+        u32 index; // in constants
+        E_AUTO_SHADER_CONSTANT type;
+    };
 
-        std::vector<f32> result;
+    std::vector<AutoConstant> autoConstants;
 
-        for (u16 i = 0; i < count; i++)
-            result.push_back(floats[i]);
+    void SetAutoConstant(const c8 *name, E_AUTO_SHADER_CONSTANT type,
+                         bool pixel);
 
-        return result;
-    }
+    f32 s32_As_f32(s32 value) { return *((f32 *)(&value)); }
 
 public:
     Shader(ShaderManager *shaderManager, ShaderInstanceDef shaderInstanceDef);
@@ -70,6 +63,11 @@ public:
     void SetPixelConstants(const c8 *name, s32 *values, u16 count) override;
     void SetPixelConstants(const c8 *name, f32 *values, u16 count) override;
 
+    void SetAutoVertexConstant(const c8 *name,
+                               E_AUTO_SHADER_CONSTANT type) override;
+    void SetAutoPixelConstant(const c8 *name,
+                              E_AUTO_SHADER_CONSTANT type) override;
+
     void SetCallback(IShaderCallback *callback) override;
 
     void ApplyToIrrMaterial(video::SMaterial &material) override;
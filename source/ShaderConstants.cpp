@@ -0,0 +1,255 @@
+
+#include "ShaderConstants.h"
+#include <cstring>
+
+ShaderConstants::ShaderConstants()
+{
+    anyDirty = false;
+    vertexRegisters.compiled = false;
+    pixelRegisters.compiled = false;
+}
+
+u32 ShaderConstants::GetIndex(const c8 *name, bool pixel, u32 size)
+{
+    for (u32 i = 0; i < constants.size(); i++)
+    {
+        Constant &constant = constants[i];
+
+        if (constant.pixel == pixel && constant.name == name)
+        {
+            // Different size? Move it to the end of the data.
+            if (constant.size != size)
+            {
+                constant.offset = data.size();
+                constant.size = size;
+                constant.dirty = true;
+                data.resize(data.size() + size, 0.f);
+
+                anyDirty = true;
+                vertexRegisters.compiled = false;
+                pixelRegisters.compiled = false;
+            }
+
+            return i;
+        }
+    }
+
+    Constant constant;
+    constant.name = name;
+    constant.pixel = pixel;
+    constant.offset = data.size();
+    constant.size = size;
+    constant.dirty = true;
+    constant.location = -1;
+    constant.resolved = false;
+    constants.push_back(constant);
+
+    data.resize(data.size() + size, 0.f);
+
+    anyDirty = true;
+    vertexRegisters.compiled = false;
+    pixelRegisters.compiled = false;
+
+    return constants.size() - 1;
+}
+
+void ShaderConstants::Set(u32 index, const f32 *values)
+{
+    ASSERT(index < constants.size());
+
+    Constant &constant = constants[index];
+    f32 *dest = &data[constant.offset];
+
+    if (memcmp(dest, values, sizeof(f32) * constant.size) != 0)
+    {
+        memcpy(dest, values, sizeof(f32) * constant.size);
+        constant.dirty = true;
+        anyDirty = true;
+    }
+}
+
+void ShaderConstants::Set(const c8 *name, bool pixel, const f32 *values,
+                          u32 count)
+{
+    Set(GetIndex(name, pixel, count), values);
+}
+
+const f32 *ShaderConstants::Get(const c8 *name, bool pixel) const
+{
+    for (auto &constant : constants)
+    {
+        if (constant.pixel == pixel && constant.name == name)
+            return &data[constant.offset];
+    }
+
+    return nullptr;
+}
+
+void ShaderConstants::SetRegisterMap(
+    const LowLevelShaderRegisterMap &registerMap, bool pixel)
+{
+    Registers &registers = pixel ? pixelRegisters : vertexRegisters;
+    registers.map = registerMap;
+    registers.compiled = false;
+}
+
+void ShaderConstants::CompileRegisters(Registers &registers, bool pixel)
+{
+    registers.copies.clear();
+
+    u32 size = 0;
+
+    for (auto &rcg : registers.map.GetRegisterComponentNames())
+    {
+        RegisterCopy copy;
+        copy.source = -1;
+        copy.size = rcg.size;
+
+        // Name NULL or doesn't exist as a constant?
+        // Unused, just left as zeroes.
+        if (rcg.name.size())
+        {
+            for (auto &constant : constants)
+            {
+                if (constant.pixel == pixel && constant.name == rcg.name)
+                {
+                    // Must match the number of register components!
+                    ASSERT(constant.size == rcg.size);
+                    copy.source = constant.offset;
+                    break;
+                }
+            }
+        }
+
+        registers.copies.push_back(copy);
+        size += rcg.size;
+    }
+
+    // Each register has 4 components.
+    // This should have been enforced by LowLevelShaderRegisterMap class.
+    ASSERT(size % 4 == 0);
+
+    registers.values.assign(size, 0.f);
+    registers.compiled = true;
+}
+
+void ShaderConstants::UploadRegisters(
+    video::IMaterialRendererServices *services, Registers &registers,
+    bool pixel, bool all)
+{
+    if (!registers.compiled)
+    {
+        CompileRegisters(registers, pixel);
+        all = true;
+    }
+
+    if (registers.values.empty())
+        return;
+
+    // Range of components that changed.
+    u32 first = registers.values.size();
+    u32 last = 0;
+    u32 dest = 0;
+
+    for (auto &copy : registers.copies)
+    {
+        if (copy.source >= 0)
+        {
+            const f32 *src = &data[copy.source];
+            f32 *dst = &registers.values[dest];
+
+            if (memcmp(dst, src, sizeof(f32) * copy.size) != 0)
+            {
+                memcpy(dst, src, sizeof(f32) * copy.size);
+                first = core::min_(first, dest);
+                last = core::max_(last, dest + copy.size);
+            }
+        }
+
+        dest += copy.size;
+    }
+
+    if (all)
+    {
+        first = 0;
+        last = registers.values.size();
+    }
+
+    if (first >= last)
+        return;
+
+    // Round out to whole registers.
+    u32 startRegister = first / 4;
+    u32 registerCount = (last + 3) / 4 - startRegister;
+    const f32 *values = &registers.values[startRegister * 4];
+
+    if (pixel)
+        services->setPixelShaderConstant(values, startRegister, registerCount);
+    else
+        services->setVertexShaderConstant(values, startRegister, registerCount);
+}
+
+void ShaderConstants::UploadHighLevel(
+    video::IMaterialRendererServices *services, bool all)
+{
+    if (!anyDirty && !all)
+        return;
+
+    for (auto &constant : constants)
+    {
+        if (!constant.dirty && !all)
+            continue;
+
+        constant.dirty = false;
+
+        const f32 *values = &data[constant.offset];
+
+#if LITHA_SHADER_CONSTANT_IDS
+        if (!constant.resolved)
+        {
+            constant.location =
+                constant.pixel
+                    ? services->getPixelShaderConstantID(constant.name.c_str())
+                    : services->getVertexShaderConstantID(
+                          constant.name.c_str());
+            constant.resolved = true;
+        }
+
+        // Not used by the program.
+        if (constant.location == -1)
+            continue;
+
+        if (constant.pixel)
+            services->setPixelShaderConstant(constant.location, values,
+                                             constant.size);
+        else
+            services->setVertexShaderConstant(constant.location, values,
+                                              constant.size);
+#else
+        if (constant.pixel)
+            services->setPixelShaderConstant(constant.name.c_str(), values,
+                                             constant.size);
+        else
+            services->setVertexShaderConstant(constant.name.c_str(), values,
+                                              constant.size);
+#endif
+    }
+
+    anyDirty = false;
+}
+
+void ShaderConstants::UploadLowLevel(video::IMaterialRendererServices *services,
+                                     bool all)
+{
+    if (!anyDirty && !all && vertexRegisters.compiled &&
+        pixelRegisters.compiled)
+        return;
+
+    UploadRegisters(services, vertexRegisters, false, all);
+    UploadRegisters(services, pixelRegisters, true, all);
+
+    for (auto &constant : constants)
+        constant.dirty = false;
+
+    anyDirty = false;
+}
@@ -0,0 +1,92 @@
+#ifndef SHADER_CONSTANTS_H
+#define SHADER_CONSTANTS_H
+
+#include "litha_internal.h"
+#include "IShader.h" // for LowLevelShaderRegisterMap
+#include <vector>
+
+// Irrlicht 1.8 can look up a constant's location once rather than by name
+// every time it is set.
+#if IRRLICHT_VERSION_MAJOR > 1 || IRRLICHT_VERSION_MINOR >= 8
+#define LITHA_SHADER_CONSTANT_IDS 1
+#else
+#define LITHA_SHADER_CONSTANT_IDS 0
+#endif
+
+// The constants of a single Shader, stored flat.
+// All values live in one contiguous float array. Each constant remembers if it
+// has changed since it was last uploaded, and its location in the GPU program
+// once that has been looked up, so uploading only touches what changed.
+class ShaderConstants
+{
+    struct Constant
+    {
+        core::stringc name;
+        bool pixel;
+        u32 offset; // into data
+        u32 size;
+        bool dirty;
+
+        // Location in the program, or -1 if the program doesn't use it.
+        // Resolved on first upload.
+        s32 location;
+        bool resolved;
+    };
+
+    std::vector<Constant> constants;
+    std::vector<f32> data;
+    bool anyDirty;
+
+    // Low level shaders set whole registers rather than named constants, so
+    // each register map is compiled into a list of copies from data.
+    struct RegisterCopy
+    {
+        s32 source; // offset into data, or -1 to leave zeroed
+        u32 size;
+    };
+
+    struct Registers
+    {
+        LowLevelShaderRegisterMap map;
+        std::vector<RegisterCopy> copies;
+
+        // As last uploaded.
+        std::vector<f32> values;
+        bool compiled;
+    };
+
+    Registers vertexRegisters;
+    Registers pixelRegisters;
+
+    void CompileRegisters(Registers &registers, bool pixel);
+    void UploadRegisters(video::IMaterialRendererServices *services,
+                         Registers &registers, bool pixel, bool all);
+
+public:
+    ShaderConstants();
+
+    // Returns the index of a constant for use with Set, adding it if it does
+    // not already exist.
+    u32 GetIndex(const c8 *name, bool pixel, u32 size);
+
+    // Set by index, values must hold the size given to GetIndex.
+    // Only marks the constant as changed if the values actually differ.
+    void Set(u32 index, const f32 *values);
+
+    // Set by name. Changing the size of an existing constant is allowed.
+    void Set(const c8 *name, bool pixel, const f32 *values, u32 count);
+
+    // Returns NULL if no constant has that name.
+    const f32 *Get(const c8 *name, bool pixel) const;
+
+    void SetRegisterMap(const LowLevelShaderRegisterMap &registerMap,
+                        bool pixel);
+
+    // Upload constants that have changed since the last upload, or all of
+    // them if another set of constants was uploaded to the same program since.
+    void UploadHighLevel(video::IMaterialRendererServices *services,
+                         bool all);
+    void UploadLowLevel(video::IMaterialRendererServices *services, bool all);
+};
+
+#endif
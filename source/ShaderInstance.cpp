@@ -10,11 +10,34 @@ ShaderInstance::ShaderInstance(video::IVideoDriver *driver,
     this->shaderManager = shaderManager;
     this->shaderInstanceDef = shaderInstanceDef;
 
-    usedMaterial = nullptr;
+    usedShader = nullptr;
+    constantsOwner = nullptr;
 
     video::IGPUProgrammingServices *gpu = driver->getGPUProgrammingServices();
 
-    if (shaderManager->GetShaderLevel() == ESL_LOW)
+    // Sources may already have been read by ShaderManager::PreloadShaders.
+    const core::stringc *vertexSource = shaderManager->GetPreloadedSource(
+        shaderInstanceDef.vertexShaderFileName);
+    const core::stringc *pixelSource = shaderManager->GetPreloadedSource(
+        shaderInstanceDef.pixelShaderFileName);
+
+    if (vertexSource && pixelSource)
+    {
+        if (shaderManager->GetShaderLevel() == ESL_LOW)
+        {
+            irrMaterialId = gpu->addShaderMaterial(
+                vertexSource->c_str(), pixelSource->c_str(), this,
+                shaderInstanceDef.baseMaterial, 0);
+        }
+        else
+        {
+            irrMaterialId = gpu->addHighLevelShaderMaterial(
+                vertexSource->c_str(), "main", video::EVST_VS_1_1,
+                pixelSource->c_str(), "main", video::EPST_PS_1_1, this,
+                shaderInstanceDef.baseMaterial, 0);
+        }
+    }
+    else if (shaderManager->GetShaderLevel() == ESL_LOW)
     {
         irrMaterialId = gpu->addShaderMaterialFromFiles(
             shaderInstanceDef.vertexShaderFileName,
@@ -47,26 +70,35 @@ const ShaderInstanceDef &ShaderInstance::GetDef()
     return shaderInstanceDef;
 }
 
-void ShaderInstance::OnSetMaterial(const video::SMaterial &material)
+bool ShaderInstance::SetConstantsOwner(Shader *shader)
 {
-    usedMaterial = &material;
+    if (constantsOwner == shader)
+        return false;
+
+    constantsOwner = shader;
+    return true;
 }
 
-void ShaderInstance::OnSetConstants(video::IMaterialRendererServices *services,
-                                    s32 userData)
+void ShaderInstance::ForgetShader(Shader *shader)
 {
-    ASSERT(usedMaterial);
+    if (constantsOwner == shader)
+        constantsOwner = nullptr;
 
-    // Now find the correct Shader object to use to set the shader constants.
-    // shader ID is packed in MaterialTypeParam2.
-
-    f32 MaterialTypeParam2 = usedMaterial->MaterialTypeParam2;
+    if (usedShader == shader)
+        usedShader = nullptr;
+}
 
-    // get f32 pointer, cast to a u32 pointer, then dereference
-    u32 shaderId = *((u32 *)(&MaterialTypeParam2));
+void ShaderInstance::OnSetMaterial(const video::SMaterial &material)
+{
+    // Find the correct Shader object to use to set the shader constants.
+    // shader ID is packed in MaterialTypeParam2.
+    usedShader = shaderManager->GetShaderById(
+        ShaderManager::ParamToShaderId(material.MaterialTypeParam2));
+}
 
-    if (Shader *shader = shaderManager->GetShaderById(shaderId))
-    {
-        shader->OnSetConstants(services, userData);
-    }
+void ShaderInstance::OnSetConstants(video::IMaterialRendererServices *services,
+                                    s32 userData)
+{
+    if (usedShader)
+        usedShader->OnSetConstants(services, userData);
 }
@@ -5,6 +5,7 @@
 #include "ShaderInstanceDef.h"
 
 class ShaderManager;
+class Shader;
 
 // An instance of an Irrlicht shader material
 class ShaderInstance : public video::IShaderConstantSetCallBack
@@ -15,8 +16,13 @@ class ShaderInstance : public video::IShaderConstantSetCallBack
 
     s32 irrMaterialId;
 
-    // Cached from OnSetMaterial, for use in OnSetConstants.
-    const video::SMaterial *usedMaterial;
+    // Found from the material in OnSetMaterial, for use in OnSetConstants.
+    // Irrlicht only calls OnSetMaterial when the material changes, so this
+    // saves looking it up for every draw.
+    Shader *usedShader;
+
+    // Shader whose constants were last uploaded to this program.
+    Shader *constantsOwner;
 
 public:
     ShaderInstance(video::IVideoDriver *driver, ShaderManager *shaderManager,
@@ -29,6 +35,14 @@ public:
     // definition.
     const ShaderInstanceDef &GetDef();
 
+    // Called by a Shader before uploading its constants.
+    // Returns true if a different Shader uploaded to this program last, in
+    // which case all constants need uploading again.
+    bool SetConstantsOwner(Shader *shader);
+
+    // Called when a Shader is destroyed.
+    void ForgetShader(Shader *shader);
+
     // NEED TO ENSURE THAT IRRLICHT DOES ACTUALLY SET THE MATERIAL BEFORE
     // CALLING OnSetConstants!!
 
@@ -4,7 +4,7 @@
 
 #include "litha_internal.h"
 
-// Used as a key in a map.
+// Used as a key in a hash map. (see ShaderInstanceDef_Hash)
 struct ShaderInstanceDef
 {
     ShaderInstanceDef() { baseMaterial = video::EMT_SOLID; }
@@ -25,19 +25,28 @@ struct ShaderInstanceDef
                baseMaterial == other.baseMaterial;
     }
 
-    /*
-    bool operator<(const ShaderInstanceDef &other) const
-    {
-        //return baseMaterial < other.baseMaterial;
-
-        return vertexShaderFileName < other.vertexShaderFileName
-                && pixelShaderFileName < other.pixelShaderFileName
-                && baseMaterial < other.baseMaterial;
-    }*/
-
     core::stringc vertexShaderFileName;
     core::stringc pixelShaderFileName;
     video::E_MATERIAL_TYPE baseMaterial;
 };
 
+struct ShaderInstanceDef_Hash
+{
+    size_t operator()(const ShaderInstanceDef &def) const
+    {
+        // FNV-1a over both file names and the base material.
+        size_t hash = 2166136261u;
+
+        for (const c8 *c = def.vertexShaderFileName.c_str(); *c; c++)
+            hash = (hash ^ (u8)*c) * 16777619u;
+
+        hash = (hash ^ '|') * 16777619u;
+
+        for (const c8 *c = def.pixelShaderFileName.c_str(); *c; c++)
+            hash = (hash ^ (u8)*c) * 16777619u;
+
+        return (hash ^ (size_t)def.baseMaterial) * 16777619u;
+    }
+};
+
 #endif
@@ -2,17 +2,10 @@
 #include "ShaderManager.h"
 #include "Shader.h"
 #include "ShaderInstance.h"
-
-u32 ShaderManager::GenShaderId()
-{
-    while (true)
-    {
-        u32 id = (u32)rand();
-
-        if (!GetShaderById(id))
-            return id;
-    }
-}
+#include <cstring>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 ShaderManager::ShaderManager(video::IVideoDriver *driver)
 {
@@ -21,6 +14,18 @@ ShaderManager::ShaderManager(video::IVideoDriver *driver)
     forceNoShaders = false;
 
     SetShaderLevel(ESL_HIGH);
+
+    frameConstants.timeSeconds = 0.f;
+    frameMatricesValid = false;
+
+    // ID 0 means no shader.
+    shaders.push_back(nullptr);
+}
+
+ShaderManager::~ShaderManager()
+{
+    for (auto &elem : sharedShaders)
+        elem.second->drop();
 }
 
 bool ShaderManager::ShadersAreAvailable()
@@ -50,9 +55,22 @@ u32 ShaderManager::RegisterShader(Shader *shader)
 {
     ASSERT(shader);
 
-    u32 shaderId = GenShaderId();
+    if (freeShaderIds.size())
+    {
+        u32 shaderId = freeShaderIds.back();
+        freeShaderIds.pop_back();
 
-    shaders[shaderId] = shader;
+        ASSERT(!shaders[shaderId]);
+        shaders[shaderId] = shader;
+        return shaderId;
+    }
+
+    u32 shaderId = shaders.size();
+
+    // Must survive the trip through MaterialTypeParam2.
+    ASSERT(ParamToShaderId(ShaderIdToParam(shaderId)) == shaderId);
+
+    shaders.push_back(shader);
 
     return shaderId;
 }
@@ -60,58 +78,139 @@ u32 ShaderManager::RegisterShader(Shader *shader)
 void ShaderManager::UnregisterShader(Shader *shader)
 {
     ASSERT(shader);
-    shaders.erase(shader->GetID());
+    ASSERT(GetShaderById(shader->GetID()) == shader);
+    shaders[shader->GetID()] = nullptr;
+    freeShaderIds.push_back(shader->GetID());
 }
 
-Shader *ShaderManager::GetShaderById(u32 shaderId)
+ShaderInstance *ShaderManager::GetShaderInstance(
+    ShaderInstanceDef &shaderInstanceDef)
 {
-    if (shaders.count(shaderId))
-        return shaders[shaderId];
-    else
-        return nullptr;
+    ShaderInstance *&shaderInstance = shaderInstances[shaderInstanceDef];
+
+    if (!shaderInstance)
+    {
+        // Doesn't exist, so create
+        shaderInstance = new ShaderInstance(driver, this, shaderInstanceDef);
+
+        // It's immediately (and permanently) added to the Irrlicht engine as
+        // a material so we no longer need to keep track of it.
+        shaderInstance->drop();
+    }
+
+    return shaderInstance;
 }
 
-ShaderInstance *ShaderManager::GetShaderInstance(
-    ShaderInstanceDef &shaderInstanceDef)
+// Parse a material type as named by Irrlicht, e.g. "trans_vertex_alpha"
+bool get_material_type(const core::stringc &name,
+                       video::E_MATERIAL_TYPE &materialType)
 {
-    for (auto &elem : shaderInstances)
+    for (u32 i = 0; video::sBuiltInMaterialTypeNames[i]; i++)
     {
-        if (elem->GetDef() == shaderInstanceDef)
-            return elem;
+        if (name == video::sBuiltInMaterialTypeNames[i])
+        {
+            materialType = (video::E_MATERIAL_TYPE)i;
+            return true;
+        }
     }
 
-    // Doesn't exist, so create
-    auto *shaderInstance = new ShaderInstance(driver, this, shaderInstanceDef);
+    return false;
+}
 
-    // It's immediately (and permanently) added to the Irrlicht engine as a
-    // material so we no longer need to keep track of it.
-    shaderInstance->drop();
+u32 ShaderManager::PreloadShaders(const io::path &manifestFile)
+{
+    PROFILE_ZONE("ShaderManager::PreloadShaders");
 
-    shaderInstances.push_back(shaderInstance);
+    if (!ShadersAreAvailable())
+        return 0;
 
-    return shaderInstance;
+    std::vector<core::stringc> lines = file::get_lines(manifestFile);
 
-    // Was formerly using map for this.
-    // I had a bug in my map functor or something, so I took the easy route and
-    // am using vector instead.
-    /*
-    // Does this shader instance already exist?
-    if (shaderInstances.find(shaderInstanceDef) == shaderInstances.end() )
+    if (!lines.size())
     {
-        // Doesn't exist, so create
-        ShaderInstance *shaderInstance = new ShaderInstance(driver, this,
-    shaderInstanceDef);
+        WARN << "Could not read shader manifest " << manifestFile;
+        return 0;
+    }
 
-        // It's immediately (and permanently) added to the Irrlicht engine as a
-    material so we
-        // no longer need to keep track of it.
-        shaderInstance->drop();
+    std::vector<ShaderInstanceDef> defs;
+
+    // Files not yet read
+    std::vector<core::stringc> fileNames;
+
+    for (auto &line : lines)
+    {
+        core::stringc trimmed = str::trim(line);
 
-        shaderInstances[shaderInstanceDef] = shaderInstance;
+        if (!trimmed.size() || trimmed[0] == '#')
+            continue;
+
+        std::vector<core::stringc> parts = str::explode_chars(" \t", trimmed);
+        video::E_MATERIAL_TYPE baseMaterial = video::EMT_SOLID;
+
+        if (parts.size() < 2 || parts.size() > 3 ||
+            (parts.size() == 3 && !get_material_type(parts[2], baseMaterial)))
+        {
+            WARN << "Bad line in shader manifest: " << line;
+            continue;
+        }
+
+        defs.push_back(ShaderInstanceDef(parts[0].c_str(), parts[1].c_str(),
+                                         baseMaterial));
+
+        for (u32 i = 0; i < 2; i++)
+        {
+            if (!shaderSources.count(parts[i]) &&
+                std::find(fileNames.begin(), fileNames.end(), parts[i]) ==
+                    fileNames.end())
+                fileNames.push_back(parts[i]);
+        }
     }
 
-    return shaderInstances[shaderInstanceDef];
-    */
+    // Read the files on as many threads as are useful.
+    // Shader files are relative to the manifest.
+    io::path dir = os::path::dirname(manifestFile);
+    std::vector<core::stringc> sources(fileNames.size());
+    std::atomic<u32> nextFile(0);
+
+    auto readFiles = [&]() {
+        for (u32 i = nextFile++; i < fileNames.size(); i = nextFile++)
+            sources[i] = file::get(os::path::concat(dir, fileNames[i]));
+    };
+
+    u32 threadCount = core::min_<u32>(std::thread::hardware_concurrency(),
+                                      fileNames.size());
+    std::vector<std::thread> threads;
+
+    for (u32 i = 1; i < threadCount; i++)
+        threads.emplace_back(readFiles);
+
+    readFiles();
+
+    for (auto &thread : threads)
+        thread.join();
+
+    for (u32 i = 0; i < fileNames.size(); i++)
+    {
+        if (sources[i].size())
+            shaderSources[fileNames[i]] = sources[i];
+        else
+            WARN << "Could not preload shader " << fileNames[i];
+    }
+
+    // Compiling has to happen here, the driver is not thread safe.
+    for (auto &def : defs)
+        GetShaderInstance(def);
+
+    NOTE << "Preloaded " << defs.size() << " shaders from " << manifestFile;
+
+    return defs.size();
+}
+
+const core::stringc *ShaderManager::GetPreloadedSource(
+    const core::stringc &fileName)
+{
+    auto it = shaderSources.find(fileName);
+    return it != shaderSources.end() ? &it->second : nullptr;
 }
 
 void ShaderManager::SetShaderLevel(E_SHADER_LEVEL level)
@@ -141,3 +240,95 @@ Shader *ShaderManager::CreateShader(const c8 *vertexShaderFileName,
                       ShaderInstanceDef(vertexShaderFileName,
                                         pixelShaderFileName, baseMaterial));
 }
+
+Shader *ShaderManager::GetSharedShader(const c8 *vertexShaderFileName,
+                                       const c8 *pixelShaderFileName,
+                                       video::E_MATERIAL_TYPE baseMaterial,
+                                       bool *created)
+{
+    ShaderInstanceDef def(vertexShaderFileName, pixelShaderFileName,
+                          baseMaterial);
+
+    if (created)
+        *created = false;
+
+    auto it = sharedShaders.find(def);
+
+    if (it != sharedShaders.end())
+        return it->second;
+
+    Shader *shader = CreateShader(vertexShaderFileName, pixelShaderFileName,
+                                  baseMaterial);
+
+    if (shader)
+    {
+        sharedShaders[def] = shader;
+
+        if (created)
+            *created = true;
+    }
+
+    return shader;
+}
+
+void ShaderManager::BeginFrame(f32 timeSeconds)
+{
+    frameConstants.timeSeconds = timeSeconds;
+    frameMatricesValid = false;
+}
+
+u32 ShaderManager::GetAutoConstantSize(E_AUTO_SHADER_CONSTANT type)
+{
+    switch (type)
+    {
+    case EASC_TIME_SECONDS:
+        return 1;
+    default:
+        return 16;
+    }
+}
+
+void ShaderManager::GetAutoConstant(E_AUTO_SHADER_CONSTANT type, f32 *values)
+{
+    if (type == EASC_VIEW_MATRIX || type == EASC_PROJECTION_MATRIX)
+    {
+        if (!frameMatricesValid)
+        {
+            frameConstants.viewMatrix = driver->getTransform(video::ETS_VIEW);
+            frameConstants.projectionMatrix =
+                driver->getTransform(video::ETS_PROJECTION);
+            frameMatricesValid = true;
+        }
+    }
+
+    switch (type)
+    {
+    case EASC_WORLD_MATRIX:
+        memcpy(values, driver->getTransform(video::ETS_WORLD).pointer(),
+               sizeof(f32) * 16);
+        break;
+    case EASC_WORLD_MATRIX_TRANSPOSED:
+    {
+        const f32 *m = driver->getTransform(video::ETS_WORLD).pointer();
+
+        for (u32 i = 0; i < 4; i++)
+        {
+            for (u32 j = 0; j < 4; j++)
+                values[i * 4 + j] = m[j * 4 + i];
+        }
+        break;
+    }
+    case EASC_VIEW_MATRIX:
+        memcpy(values, frameConstants.viewMatrix.pointer(), sizeof(f32) * 16);
+        break;
+    case EASC_PROJECTION_MATRIX:
+        memcpy(values, frameConstants.projectionMatrix.pointer(),
+               sizeof(f32) * 16);
+        break;
+    case EASC_TIME_SECONDS:
+        values[0] = frameConstants.timeSeconds;
+        break;
+    default:
+        FAIL << "Unknown auto shader constant " << s32(type);
+    }
+}
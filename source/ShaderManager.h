@@ -4,13 +4,23 @@
 
 #include "litha_internal.h"
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include "ShaderInstanceDef.h"
 #include "IRenderSystem.h" // for E_SHADER_LEVEL
+#include "IShader.h"        // for E_AUTO_SHADER_CONSTANT
 
 class Shader;
 class ShaderInstance;
 
+// Values shared by all shaders for a frame.
+struct ShaderFrameConstants
+{
+    f32 timeSeconds;
+    core::matrix4 viewMatrix;
+    core::matrix4 projectionMatrix;
+};
+
 class ShaderManager : public virtual IReferenceCounted
 {
     video::IVideoDriver *driver;
@@ -19,18 +29,37 @@ class ShaderManager : public virtual IReferenceCounted
 
     E_SHADER_LEVEL shaderLevel;
 
-    // shader IDs mapped to Shader objects
-    std::map<u32, Shader *> shaders;
+    // Shader objects indexed by their ID, NULL once unregistered.
+    // ID 0 is never used, as a cleared material has MaterialTypeParam2 of
+    // zero.
+    std::vector<Shader *> shaders;
+
+    // IDs of destroyed Shaders, handed out again before shaders grows so it
+    // stays as big as the most Shaders alive at once. A material still
+    // holding a destroyed Shader's ID may find whichever Shader took it next.
+    std::vector<u32> freeShaderIds;
 
     // Shader instances (irrlicht shader materials)
-    // std::map<ShaderInstanceDef, ShaderInstance *, ShaderInstanceDef_Compare>
-    // shaderInstances;
-    std::vector<ShaderInstance *> shaderInstances;
+    std::unordered_map<ShaderInstanceDef, ShaderInstance *,
+                       ShaderInstanceDef_Hash>
+        shaderInstances;
+
+    // Shaders returned by GetSharedShader, grabbed until destruction.
+    std::unordered_map<ShaderInstanceDef, Shader *, ShaderInstanceDef_Hash>
+        sharedShaders;
+
+    // Sources read by PreloadShaders, by file name.
+    std::map<core::stringc, core::stringc> shaderSources;
+
+    ShaderFrameConstants frameConstants;
 
-    u32 GenShaderId();
+    // View and projection are only known once the camera has been rendered,
+    // so they're read from the driver on first use each frame.
+    bool frameMatricesValid;
 
 public:
     ShaderManager(video::IVideoDriver *driver);
+    ~ShaderManager();
 
     bool ShadersAreAvailable();
     void ForceNoShaders(bool noShaders);
@@ -39,10 +68,24 @@ public:
     u32 RegisterShader(Shader *shader);
     void UnregisterShader(Shader *shader);
 
-    Shader *GetShaderById(u32 shaderId);
+    Shader *GetShaderById(u32 shaderId)
+    {
+        return shaderId < shaders.size() ? shaders[shaderId] : nullptr;
+    }
+
+    // Shader IDs are stored in a material's MaterialTypeParam2.
+    // As a plain float value, exact for any ID below 2^24.
+    static f32 ShaderIdToParam(u32 shaderId) { return (f32)shaderId; }
+    static u32 ParamToShaderId(f32 param) { return (u32)param; }
 
     ShaderInstance *GetShaderInstance(ShaderInstanceDef &shaderInstanceDef);
 
+    // See IRenderSystem::PreloadShaders
+    u32 PreloadShaders(const io::path &manifestFile);
+
+    // Returns NULL if the file was not preloaded.
+    const core::stringc *GetPreloadedSource(const core::stringc &fileName);
+
     void SetShaderLevel(E_SHADER_LEVEL level);
     E_SHADER_LEVEL GetShaderLevel();
 
@@ -52,6 +95,22 @@ public:
     Shader *CreateShader(const c8 *vertexShaderFileName,
                          const c8 *pixelShaderFileName,
                          video::E_MATERIAL_TYPE baseMaterial);
+
+    // Not grabbed. See IRenderSystem::GetSharedShader.
+    Shader *GetSharedShader(const c8 *vertexShaderFileName,
+                            const c8 *pixelShaderFileName,
+                            video::E_MATERIAL_TYPE baseMaterial,
+                            bool *created);
+
+    // Called by the render task before anything is drawn each frame.
+    void BeginFrame(f32 timeSeconds);
+
+    // Number of floats an auto constant takes.
+    static u32 GetAutoConstantSize(E_AUTO_SHADER_CONSTANT type);
+
+    // Write the current value of an auto constant.
+    // values must have room for GetAutoConstantSize(type) floats.
+    void GetAutoConstant(E_AUTO_SHADER_CONSTANT type, f32 *values);
 };
 
 #endif
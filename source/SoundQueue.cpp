@@ -1,14 +1,17 @@
 
 #include "SoundQueue.h"
-#include "ISoundSystem.h"
+#include "SoundSystem.h"
 #include "ISound2D.h"
 #include "ISound3D.h"
 #include "IEngine.h"
 
-SoundQueue::SoundQueue(ISoundSystem *soundSystem)
+SoundQueue::SoundQueue(SoundSystem *soundSystem)
 {
     this->soundSystem = soundSystem;
 
+    changed = false;
+    watchLoop = false;
+
     // Update this in logic task.
     // But task must not keep a reference to this sound queue, as there is no
     // RemoveSoundQueue method.
@@ -17,10 +20,13 @@ SoundQueue::SoundQueue(ISoundSystem *soundSystem)
 
 SoundQueue::~SoundQueue()
 {
-    for (auto &elem : soundInfos)
+    for (u32 i = 0; i < soundInfos.size(); i++)
     {
-        if (elem.sound)
-            elem.sound->drop();
+        if (ISound *sound = soundInfos[i].sound)
+        {
+            soundSystem->UnwatchSound(sound);
+            sound->drop();
+        }
     }
 
     GetEngine()->GetLogicUpdater().RemoveUpdatable(this);
@@ -35,20 +41,24 @@ void SoundQueue::Add(ISound *sound, const c8 *soundFile, s32 flags)
     }
 
     // sound not already present?
-    for (auto &elem : soundInfos)
+    for (u32 i = 0; i < soundInfos.size(); i++)
     {
-        if (elem.sound == sound)
+        if (soundInfos[i].sound == sound)
             return;
     }
 
     sound->grab();
+    soundSystem->WatchSound(sound, this);
+
+    Changed();
 
     QueuedSoundInfo info;
     info.sound = sound;
     info.flags = flags;
     info.started = false;
     info.lastPlayPosition = 0.0;
-    soundInfos.push_back(info);
+    info.removed = false;
+    soundInfos.PushBack(info);
 
     // Now start the sound playing, then immediately pause it, ready!
     // Also set loop flag.
@@ -81,28 +91,111 @@ void SoundQueue::Add3D(const c8 *soundFile, s32 flags)
 
 void SoundQueue::BreakLoop()
 {
+    Changed();
+
     QueuedSoundInfo info;
     info.sound = nullptr;
     info.flags = ESF_ENQUEUE | ESF_BREAK_LOOP;
     info.started = false;
     info.lastPlayPosition = 0.0;
-    soundInfos.push_back(info);
+    info.removed = false;
+    soundInfos.PushBack(info);
+}
+
+void SoundQueue::Clear()
+{
+    for (u32 i = 0; i < soundInfos.size(); i++)
+    {
+        if (!soundInfos[i].removed)
+            RemoveSound(i);
+    }
+
+    soundInfos.clear();
+
+    changed = false;
+    watchLoop = false;
 }
 
 const std::vector<ISound *> &SoundQueue::GetAllSounds()
 {
     tempSounds.clear();
 
-    for (auto &elem : soundInfos)
+    for (u32 i = 0; i < soundInfos.size(); i++)
     {
-        // ignore NULL sounds from BreakLoop()
-        if (elem.sound)
-            tempSounds.push_back(elem.sound);
+        // ignore NULL sounds from BreakLoop() (and removed ones)
+        if (soundInfos[i].sound)
+            tempSounds.push_back(soundInfos[i].sound);
     }
 
     return tempSounds;
 }
 
+void SoundQueue::OnSoundFinished(ISound *sound)
+{
+    changed = true;
+}
+
+void SoundQueue::Changed()
+{
+    changed = true;
+
+    // Play positions are only kept up to date while a loop could be broken,
+    // so start again from here rather than from some old position.
+    for (u32 i = 0; i < soundInfos.size(); i++)
+    {
+        QueuedSoundInfo &info = soundInfos[i];
+
+        if (info.started && !info.removed && (info.flags & ESF_LOOP))
+            info.lastPlayPosition = info.sound->GetPlayPosition();
+    }
+}
+
+s32 SoundQueue::GetNext(u32 i)
+{
+    for (u32 j = i + 1; j < soundInfos.size(); j++)
+    {
+        if (!soundInfos[j].removed)
+            return j;
+    }
+
+    return -1;
+}
+
+void SoundQueue::RemoveSound(u32 i)
+{
+    QueuedSoundInfo &info = soundInfos[i];
+
+    if (info.sound)
+    {
+        // Unwatched first, this queue knows it's been stopped.
+        soundSystem->UnwatchSound(info.sound);
+        info.sound->Stop();
+        info.sound->drop();
+        info.sound = nullptr;
+    }
+
+    info.removed = true;
+}
+
+void SoundQueue::Compact()
+{
+    // Usually it's the oldest sounds that have finished.
+    while (soundInfos.size() && soundInfos.Front().removed)
+        soundInfos.PopFront();
+
+    // Otherwise close up the gaps, keeping the order.
+    u32 count = 0;
+
+    for (u32 i = 0; i < soundInfos.size(); i++)
+    {
+        if (!soundInfos[i].removed)
+            soundInfos[count++] = soundInfos[i];
+    }
+
+    while (soundInfos.size() > count)
+        soundInfos.PopBack();
+}
+
 void SoundQueue::OnPause()
 {
     IUpdatable::OnPause();
@@ -132,74 +225,95 @@ void SoundQueue::Update(f32 dt)
     if (IsPaused())
         return;
 
+    // Nothing can happen until a sound finishes or another is added.
+    if (!changed && !watchLoop)
+        return;
+
+    changed = false;
+    watchLoop = false;
+
     bool noWait = true;
+    bool removedAny = false;
 
     for (u32 i = 0; i < soundInfos.size(); i++)
     {
-        if (soundInfos[i].started)
+        QueuedSoundInfo &info = soundInfos[i];
+
+        if (info.removed)
+            continue;
+
+        if (info.started)
         {
+            s32 next = GetNext(i);
+
             // remove if finished OR has ESF_UNTIL_NEXT and another sound
             // waiting
-            int endSound = (soundInfos[i].sound->IsFinished() ||
-                            ((soundInfos[i].flags & ESF_UNTIL_NEXT) &&
-                             soundInfos.size() > i + 1));
+            bool endSound = info.sound->IsFinished() ||
+                            ((info.flags & ESF_UNTIL_NEXT) && next != -1);
+
             // OR if: ESF_LOOP and current PlayPosition is smaller than last
             // (loop over) and another sound waiting and other sound has
             // ESF_BREAK_LOOP
-            if ((soundInfos[i].flags & ESF_LOOP) && soundInfos.size() > i + 1 &&
-                soundInfos[i].sound->GetPlayPosition() <
-                    soundInfos[i].lastPlayPosition)
+            if ((info.flags & ESF_LOOP) && next != -1 &&
+                (soundInfos[next].flags & ESF_BREAK_LOOP) && !endSound)
             {
-                endSound += soundInfos[i + 1].flags & ESF_BREAK_LOOP;
+                f32 playPosition = info.sound->GetPlayPosition();
+
+                if (playPosition < info.lastPlayPosition)
+                    endSound = true;
+                else
+                {
+                    info.lastPlayPosition = playPosition;
+                    watchLoop = true;
+                }
             }
 
             if (endSound)
             {
                 // remove a finished sound
-                soundInfos[i].sound->Stop();
-                soundInfos[i].sound->drop();
-                soundInfos.erase(soundInfos.begin() + i);
-                i--;
+                RemoveSound(i);
+                removedAny = true;
                 continue;
             }
-            else
-            {
-                soundInfos[i].lastPlayPosition =
-                    soundInfos[i].sound->GetPlayPosition();
-            }
         }
         else // not playing yet, so decide whether it needs playing
         {
-            if (soundInfos[i].flags & ESF_ENQUEUE)
+            if (info.flags & ESF_ENQUEUE)
             {
                 // Will play if first in queue OR all sounds so far were
                 // SOUNDANIM_NO_WAIT
                 if (noWait)
                 {
-                    if (!soundInfos[i].sound)
+                    if (!info.sound)
                     {
                         // empty sound? remove it. Probably from BreakLoop().
-                        soundInfos.erase(soundInfos.begin() + i);
-                        i--;
+                        RemoveSound(i);
+                        removedAny = true;
                         continue;
                     }
-                    soundInfos[i].started = true;
-                    soundInfos[i].sound->Resume();
+                    info.started = true;
+                    info.sound->Resume();
+
+                    // Look again next update, in case it could not play.
+                    changed = true;
                 }
             }
             else // play instantly
             {
-                soundInfos[i].started = true;
-                soundInfos[i].sound->Resume();
+                info.started = true;
+                info.sound->Resume();
+                changed = true;
 
                 continue;
             }
         }
 
-        if (!(soundInfos[i].flags & ESF_NO_WAIT) &&
-            !(soundInfos[i].flags & ESF_UNTIL_NEXT))
+        if (!(info.flags & ESF_NO_WAIT) && !(info.flags & ESF_UNTIL_NEXT))
         {
             noWait = false;
         }
     }
+
+    if (removedAny)
+        Compact();
 }
@@ -2,7 +2,7 @@
 #include "ISoundQueue.h"
 #include "IUpdatable.h"
 
-class ISoundSystem;
+class SoundSystem;
 
 struct QueuedSoundInfo
 {
@@ -10,21 +10,37 @@ struct QueuedSoundInfo
     s32 flags;
     bool started;
     f32 lastPlayPosition;
+
+    // Finished with, removed at the end of the update.
+    bool removed;
 };
 
 class SoundQueue : public ISoundQueue, public IUpdatable
 {
-    ISoundSystem *soundSystem;
+    SoundSystem *soundSystem;
 
-    std::vector<QueuedSoundInfo> soundInfos;
+    // Oldest first. Most sounds finish in order, so are popped off the front.
+    RingBuffer<QueuedSoundInfo> soundInfos;
     std::vector<ISound *> tempSounds;
 
+    // Something was added or finished since the last update.
+    bool changed;
+
+    // A looped sound is playing with a BreakLoop waiting behind it, so must be
+    // watched every update for the end of its loop.
+    bool watchLoop;
+
+    void Changed();
+    s32 GetNext(u32 i);
+    void RemoveSound(u32 i);
+    void Compact();
+
 protected:
     void OnPause() override;
     void OnResume() override;
 
 public:
-    SoundQueue(ISoundSystem *soundSystem);
+    SoundQueue(SoundSystem *soundSystem);
     ~SoundQueue();
 
     void Add(ISound *sound, const c8 *soundFile, s32 flags) override;
@@ -33,8 +49,12 @@ public:
     void Add3D(const c8 *soundFile, s32 flags) override;
 
     void BreakLoop() override;
+    void Clear() override;
 
     const std::vector<ISound *> &GetAllSounds() override;
 
+    // Called by SoundSystem.
+    void OnSoundFinished(ISound *sound);
+
     void Update(f32 dt) override;
 };
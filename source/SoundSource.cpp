@@ -45,26 +45,20 @@ void SoundSource::Update(f32 dt)
     if (IsPaused())
         return;
 
-    // Create a list of all sounds, from "sound" and "soundQueue".
-
-    std::vector<ISound *> tempAllSounds;
-
-    tempAllSounds.push_back(sound);
-
-    const std::vector<ISound *> &soundQueueSounds = soundQueue->GetAllSounds();
-
-    for (auto &soundQueueSound : soundQueueSounds)
-        tempAllSounds.push_back(soundQueueSound);
-
-    // Set all 3D sounds with a position and velocity
+    // Set all 3D sounds with a position and velocity.
+    // These are only recorded here, the sound system sends whatever moved
+    // to OpenAL at the end of the update.
 
     core::vector3df pos = GetAbsolutePosition();
     core::vector3df vel = GetAbsoluteLinearVelocity();
 
-    for (auto &tempAllSound : tempAllSounds)
+    sound->SetPosition(pos);
+    sound->SetVelocity(vel);
+
+    for (auto &queuedSound : soundQueue->GetAllSounds())
     {
         // Is it a 3D sound?
-        if (auto *sound3d = dynamic_cast<ISound3D *>(tempAllSound))
+        if (auto *sound3d = dynamic_cast<ISound3D *>(queuedSound))
         {
             sound3d->SetPosition(pos);
             sound3d->SetVelocity(vel);
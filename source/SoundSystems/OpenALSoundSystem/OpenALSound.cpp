@@ -1,8 +1,8 @@
 
 #include "OpenALSound.h"
 #include "OpenALSoundSystem.h"
-
-s32 sourceCounter = 0;
+#include "OpenALTransformBatch.h"
+#include "OpenALVoicePool.h"
 
 OpenALSound::OpenALSound(OpenALSoundSystem* soundSystem)
 {
@@ -11,82 +11,115 @@ OpenALSound::OpenALSound(OpenALSoundSystem* soundSystem)
     volume = 1.f;
     separateVolume = 1.f;
 
-    source = 0;
-    alGenSources(1, &source);
+    looped = false;
+    priority = 0;
 
-    if (check_openal_error())
-    {
-        WARN << "OpenAL source count probably exceeded: " << sourceCounter
-             << " sources in use.";
-    }
+    relative = false;
+    transformSlot = soundSystem->GetTransformBatch()->Add();
+    referenceDistance = 1.f;
 
-    SetIsLooped(false);
-    ApplyVolume();
+    buffer = 0;
+    length = 0.f;
+    streaming = false;
+    active = false;
+    virtualPosition = 0.f;
 
-    sourceCounter++;
+    // No voice until played.
+    source = 0;
 }
 
 OpenALSound::~OpenALSound()
 {
     Stop();
-
-    alDeleteSources(1, &source);
-    check_openal_error();
-
-    sourceCounter--;
+    soundSystem->GetTransformBatch()->Remove(transformSlot);
 }
 
 void OpenALSound::Play(const core::stringc& soundFile)
 {
     Stop();
 
-    // Get the OpenAL buffer for this sound file.
-
-    ALuint buffer;
-
-    if (!soundSystem->GetOpenALBuffer(soundFile.c_str(), &buffer))
+    // Still being decoded by PreloadSoundBank? Wait for it rather than
+    // decoding it again here. (this also finds out if it is streamed)
+    if (soundSystem->IsLoading(soundFile))
     {
-        WARN << "Could not get buffer (" << soundFile.c_str() << ")";
+        pendingFile = soundFile;
+        soundSystem->AddPending(this);
         return;
     }
 
-    // If this buffer is not already set, then set it.
-
-    ALint currentBuffer;
-    alGetSourcei(source, AL_BUFFER, &currentBuffer);
-
-    if (check_openal_error())
-        return;
-
-    if ((ALint)buffer != currentBuffer)
+    // Long sounds are decoded as they play.
+    // Streams can't be virtual, so take a voice from something else if
+    // needed.
+    if (soundSystem->IsStreamed(soundFile))
     {
-        alSourcei(source, AL_BUFFER, buffer);
+        streaming = true;
 
-        if (check_openal_error())
+        if (!soundSystem->GetVoicePool()->Acquire(this))
+        {
+            WARN << "No voice to stream (" << soundFile.c_str() << ")";
+            streaming = false;
             return;
+        }
+
+        if (!soundSystem->GetStreamer()->Start(source, soundFile, looped,
+                                               !IsPaused()))
+        {
+            WARN << "Could not stream (" << soundFile.c_str() << ")";
+            Stop();
+            return;
+        }
+
+        active = true;
+        return;
     }
 
-    // Start playing
+    // Get the OpenAL buffer for this sound file.
 
-    if (!IsPaused())
+    if (!soundSystem->GetOpenALBuffer(soundFile.c_str(), &buffer))
     {
-        alSourcePlay(source);
-        check_openal_error();
+        WARN << "Could not get buffer (" << soundFile.c_str() << ")";
+        buffer = 0;
+        return;
     }
 
-    // OpenAL source retains settings like looping, volume, so we don't need to
-    // re-set them here.
+    length = soundSystem->GetBufferLength(buffer);
+    virtualPosition = 0.f;
+    active = true;
+
+    // Starts playing now if there is a voice for it, otherwise it starts
+    // virtual.
+    soundSystem->GetVoicePool()->Acquire(this);
 }
 
 void OpenALSound::Stop()
 {
-    alSourceStop(source);
-    check_openal_error();
+    // Stopped before the end, which whatever is waiting for it to finish
+    // (e.g. a sound queue) needs to hear about too.
+    bool wasPlaying = active || pendingFile.size();
+
+    if (pendingFile.size())
+    {
+        soundSystem->RemovePending(this);
+        pendingFile = "";
+    }
+
+    if (streaming && source)
+        soundSystem->GetStreamer()->Stop(source);
+
+    if (source)
+        soundSystem->GetVoicePool()->Release(this);
+
+    streaming = false;
+    active = false;
+    virtualPosition = 0.f;
+
+    if (wasPlaying)
+        soundSystem->NotifyFinished(this);
 }
 
 void OpenALSound::OnPause()
 {
-    if (!IsFinished())
+    if (source && !IsFinished())
     {
         alSourcePause(source);
         check_openal_error();
@@ -95,6 +128,16 @@ void OpenALSound::OnPause()
 
 void OpenALSound::OnResume()
 {
+    if (!active)
+        return;
+
+    if (!source)
+    {
+        // Might be heard now.
+        soundSystem->GetVoicePool()->Acquire(this);
+        return;
+    }
+
     if (!IsFinished())
     {
         alSourcePlay(source);
@@ -104,23 +147,37 @@ void OpenALSound::OnResume()
 
 void OpenALSound::SetIsLooped(bool loop)
 {
+    looped = loop;
+
+    if (!source)
+        return;
+
+    // A stream loops by decoding from the start again, not with AL_LOOPING.
+    if (streaming)
+    {
+        soundSystem->GetStreamer()->SetIsLooped(source, loop);
+        return;
+    }
+
     alSourcei(source, AL_LOOPING, loop);
     check_openal_error();
 }
 
 bool OpenALSound::IsFinished()
 {
-    ALint state;
-    alGetSourcei(source, AL_SOURCE_STATE, &state);
-
-    if (check_openal_error())
+    if (pendingFile.size())
         return false;
 
-    return state == AL_STOPPED;
+    // The voice pool notices when voices stop, once per update for all of
+    // them, so there is no need to ask OpenAL here.
+    return !active;
 }
 
 bool OpenALSound::IsPlaying()
 {
+    if (!source)
+        return active && !IsPaused();
+
     ALint state;
     alGetSourcei(source, AL_SOURCE_STATE, &state);
 
@@ -135,6 +192,12 @@ f32 OpenALSound::GetPlayPosition()
     if (IsFinished())
         return 0.0;
 
+    if (!source)
+        return virtualPosition;
+
+    if (streaming)
+        return soundSystem->GetStreamer()->GetPlayPosition(source);
+
     ALfloat playPosition = 0.0;
     alGetSourcef(source, AL_SEC_OFFSET, &playPosition);
 
@@ -150,6 +213,11 @@ void OpenALSound::SetVolume(f32 volume)
     ApplyVolume();
 }
 
+void OpenALSound::SetPriority(s32 priority)
+{
+    this->priority = priority;
+}
+
 void OpenALSound::SetSeparateVolume(f32 volume)
 {
     separateVolume = volume;
@@ -158,6 +226,150 @@ void OpenALSound::SetSeparateVolume(f32 volume)
 
 void OpenALSound::ApplyVolume()
 {
+    if (!source)
+        return;
+
     alSourcef(source, AL_GAIN, volume * separateVolume);
     check_openal_error();
 }
+
+void OpenALSound::SetSourceRelative(bool relative)
+{
+    this->relative = relative;
+
+    if (source)
+    {
+        alSourcei(source, AL_SOURCE_RELATIVE, relative);
+        check_openal_error();
+    }
+}
+
+void OpenALSound::SetSourcePosition(const core::vector3df &pos)
+{
+    soundSystem->GetTransformBatch()->SetPosition(transformSlot, pos);
+}
+
+void OpenALSound::SetSourceVelocity(const core::vector3df &vel)
+{
+    soundSystem->GetTransformBatch()->SetVelocity(transformSlot, vel);
+}
+
+void OpenALSound::SetReferenceDistance(f32 distance)
+{
+    referenceDistance = distance;
+
+    if (source)
+    {
+        alSourcef(source, AL_REFERENCE_DISTANCE, distance);
+        check_openal_error();
+    }
+}
+
+f32 OpenALSound::GetAudibleGain(const core::vector3df &listenerPos,
+                                f32 minGain)
+{
+    if (IsPaused())
+        return 0.f;
+
+    f32 gain = volume * separateVolume;
+
+    if (relative)
+        return gain >= minGain ? gain : 0.f;
+
+    core::vector3df sourcePosition =
+        soundSystem->GetTransformBatch()->GetPosition(transformSlot);
+
+    // OpenAL's default inverse distance clamped model, with a rolloff of 1.
+    // Too far to be heard? Culled on the squared distance, most sounds in a
+    // level will be.
+    f32 distanceSQ = sourcePosition.getDistanceFromSQ(listenerPos);
+    f32 maxDistance = gain * referenceDistance / minGain;
+
+    if (distanceSQ > maxDistance * maxDistance)
+        return 0.f;
+
+    f32 distance = core::max_(sqrtf(distanceSQ), referenceDistance);
+
+    return gain * referenceDistance / distance;
+}
+
+void OpenALSound::AttachVoice(ALuint voice)
+{
+    source = voice;
+
+    alSourcef(source, AL_GAIN, volume * separateVolume);
+    alSourcei(source, AL_SOURCE_RELATIVE, relative);
+    alSourcef(source, AL_REFERENCE_DISTANCE, referenceDistance);
+    check_openal_error();
+
+    // Must be in place before it starts playing.
+    soundSystem->GetTransformBatch()->Attach(transformSlot, source);
+
+    // The streamer sets up its own buffers.
+    if (streaming)
+        return;
+
+    // Back to AL_INITIAL, so that if it doesn't start playing yet (paused)
+    // it's not taken for having finished.
+    alSourceRewind(source);
+    alSourcei(source, AL_LOOPING, looped);
+    alSourcei(source, AL_BUFFER, buffer);
+    alSourcef(source, AL_SEC_OFFSET, virtualPosition);
+    check_openal_error();
+
+    if (!IsPaused())
+    {
+        alSourcePlay(source);
+        check_openal_error();
+    }
+}
+
+ALuint OpenALSound::DetachVoice()
+{
+    ALuint voice = source;
+
+    // So nothing more is sent to it, once it belongs to another sound.
+    soundSystem->GetTransformBatch()->Detach(transformSlot);
+
+    // Carry on from here while virtual.
+    if (active && !streaming)
+    {
+        ALfloat playPosition = 0.0;
+        alGetSourcef(source, AL_SEC_OFFSET, &playPosition);
+
+        if (!check_openal_error())
+            virtualPosition = playPosition;
+    }
+
+    alSourceStop(source);
+    alSourcei(source, AL_BUFFER, 0);
+    check_openal_error();
+
+    source = 0;
+    return voice;
+}
+
+void OpenALSound::OnVoiceStopped()
+{
+    active = false;
+    streaming = false;
+    virtualPosition = 0.f;
+
+    soundSystem->NotifyFinished(this);
+}
+
+void OpenALSound::AdvanceVirtual(f32 dt)
+{
+    if (!active || source || IsPaused())
+        return;
+
+    virtualPosition += dt;
+
+    if (virtualPosition < length)
+        return;
+
+    if (looped && length > 0.f)
+        virtualPosition = fmodf(virtualPosition, length);
+    else
+        OnVoiceStopped(); // finished, as if it had a voice
+}
@@ -4,9 +4,14 @@
 
 #include "ISound.h"
 #include "openal_stuff.h"
+#include "sound_reg.h"
 
 class OpenALSoundSystem;
 
+// A sound only has an OpenAL source (a voice) while it is one of the most
+// audible. The rest are virtual: their settings are kept here and their play
+// position advances with time, so they carry on from the right place if they
+// get a voice again. See OpenALVoicePool.
 class OpenALSound : public virtual ISound
 {
     f32 volume;
@@ -16,14 +21,44 @@ class OpenALSound : public virtual ISound
     // within the ApplyVolume call.
     f32 separateVolume;
 
+    bool looped;
+    s32 priority;
+
+    // Source settings, applied whenever a voice is attached.
+    // Position and velocity are kept in the OpenALTransformBatch, which sends
+    // them to the voice.
+    bool relative;
+    u32 transformSlot;
+    f32 referenceDistance;
+
+    // What is playing
+    ALuint buffer;
+    f32 length; // seconds
+    bool streaming;
+
+    // Played and not yet stopped or finished.
+    bool active;
+
+    // Play position while virtual.
+    f32 virtualPosition;
+
+    // Played while its file was still loading, so will play once it has.
+    core::stringc pendingFile;
+
 protected:
     OpenALSoundSystem *soundSystem;
 
+    // Voice, 0 if virtual.
     ALuint source;
 
     void OnPause() override;
     void OnResume() override;
 
+    void SetSourceRelative(bool relative);
+    void SetSourcePosition(const core::vector3df &pos);
+    void SetSourceVelocity(const core::vector3df &vel);
+    void SetReferenceDistance(f32 distance);
+
 public:
     OpenALSound(OpenALSoundSystem *soundSystem);
     ~OpenALSound();
@@ -36,12 +71,36 @@ public:
     bool IsPlaying() override;
     f32 GetPlayPosition() override;
     void SetVolume(f32 volume) override;
+    void SetPriority(s32 priority) override;
 
     void SetSeparateVolume(f32 volume);
 
     // actually set the openal volume, taking into account
     // both the regular volume and the separate volume.
     void ApplyVolume();
+
+    const core::stringc &GetPendingFile() const { return pendingFile; }
+
+    // Place in the sound_reg lists.
+    SoundRegEntry reg;
+
+    // Used by OpenALVoicePool
+    bool IsActive() const { return active; }
+    bool IsStreaming() const { return streaming; }
+    bool HasVoice() const { return source != 0; }
+    s32 GetPriority() const { return priority; }
+
+    // How loud it would be heard, from the volume and distance.
+    // Anything quieter than minGain is just 0.
+    f32 GetAudibleGain(const core::vector3df &listenerPos, f32 minGain);
+
+    void AttachVoice(ALuint voice);
+    ALuint DetachVoice();
+
+    // The voice played to the end.
+    void OnVoiceStopped();
+
+    void AdvanceVirtual(f32 dt);
 };
 
 #endif
@@ -9,24 +9,22 @@ OpenALSound3D::OpenALSound3D(OpenALSoundSystem *soundSystem)
     SetVelocity(core::vector3df(0, 0, 0));
     SetMaxVolumePoint(1.0);
 
-    register_sound3d(this);
+    register_sound(this, ESG_3D);
 }
 
 OpenALSound3D::~OpenALSound3D()
 {
-    unregister_sound3d(this);
+    unregister_sound(this);
 }
 
 void OpenALSound3D::SetPosition(core::vector3df pos)
 {
-    alSource3f(source, AL_POSITION, pos.X, pos.Y, -pos.Z);
-    check_openal_error();
+    SetSourcePosition(core::vector3df(pos.X, pos.Y, -pos.Z));
 }
 
 void OpenALSound3D::SetVelocity(core::vector3df vel)
 {
-    alSource3f(source, AL_VELOCITY, vel.X, vel.Y, -vel.Z);
-    check_openal_error();
+    SetSourceVelocity(core::vector3df(vel.X, vel.Y, -vel.Z));
 }
 
 void OpenALSound3D::SetMaxVolumePoint(f32 proximity)
@@ -34,6 +32,5 @@ void OpenALSound3D::SetMaxVolumePoint(f32 proximity)
     // AL_REFERENCE_DISTANCE may not entirely be correct.
     // it may vary depending on other OpenAL settings.
     // Consider it untested.
-    alSourcef(source, AL_REFERENCE_DISTANCE, proximity);
-    check_openal_error();
+    SetReferenceDistance(proximity);
 }
@@ -2,10 +2,14 @@
 #include "OpenALSoundSystem.h"
 #include "OpenALSound2D.h"
 #include "OpenALSound3D.h"
-#include "stb_vorbis.h"
+#include "OpenALTransformBatch.h"
+#include "OpenALVoicePool.h"
 #include "sound_reg.h"
 
-OpenALSoundSystem::OpenALSoundSystem()
+// Oggs longer than this are streamed rather than decoded whole.
+static const f32 STREAM_MIN_SECONDS = 10.f;
+
+OpenALSoundSystem::OpenALSoundSystem(bool threaded)
 {
     device = alcOpenDevice(nullptr);
     context = nullptr;
@@ -37,6 +41,14 @@ OpenALSoundSystem::OpenALSoundSystem()
         }
     }
 
+    streamer = new OpenALStreamer();
+    transformBatch = new OpenALTransformBatch(context, threaded);
+    voicePool = new OpenALVoicePool(device, streamer);
+    bufferBytes = 0;
+
+    // Preloading then finds out which are streamed, off the main thread.
+    soundBank.SetStreamMinSeconds(STREAM_MIN_SECONDS);
+
     globalVolume2D = 1.f;
     globalVolume3D = 1.f;
 
@@ -48,6 +60,11 @@ OpenALSoundSystem::OpenALSoundSystem()
 
 OpenALSoundSystem::~OpenALSoundSystem()
 {
+    // Stream thread must be stopped before the context goes.
+    delete streamer;
+    delete voicePool;
+    delete transformBatch;
+
     // delete all OpenAL buffers
     for (std::map<core::stringc, ALuint>::const_iterator i = buffers.begin();
          i != buffers.end(); i++)
@@ -84,132 +101,137 @@ bool OpenALSoundSystem::GetOpenALBuffer(const core::stringc &fileName,
     }
 
     // Otherwise we create buffer.
+    // Copied straight from an archive if it's in one.
+    if (const SoundArchive::Sound *archived = FindArchived(fileName))
+    {
+        return CreateBuffer(fileName, archived->samples,
+                            archived->GetByteCount(), archived->channels,
+                            archived->sampleRate, buffer);
+    }
 
-    // determine file type by extension
-    io::path fileExt = os::path::getext(fileName);
+    // Decoded now, unless it has already been by PreloadSoundBank.
+    DecodedSoundPtr sound = soundBank.Get(fileName);
 
-    if (fileExt == "wav")
-    {
-        // Load WAV files with ALUT.
+    if (!sound)
+        return false;
 
+    bool ok = CreateBuffer(fileName, &sound->samples[0], sound->GetByteCount(),
+                           sound->channels, sound->sampleRate, buffer);
+
+    // OpenAL has its own copy now.
+    soundBank.Release(fileName);
+    return ok;
+}
+
+bool OpenALSoundSystem::CreateBuffer(const core::stringc &fileName,
+                                     const s16 *samples, u32 byteCount,
+                                     u32 channels, u32 sampleRate,
+                                     ALuint *buffer)
+{
+    ALuint newbuffer = 0;
+    alGenBuffers(1, &newbuffer);
+
+    if (check_openal_error())
         return false;
 
-        /*
-        ALuint newbuffer = alutCreateBufferFromFile(fileName.c_str());
+    ALenum format = channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
 
-        if (newbuffer == AL_NONE)
-        {
-            WARN << "Could not create buffer from file (" << fileName << ")";
-            check_openal_error();
-        }
-        else
-        {
-            buffers[fileName] = newbuffer;
-            *buffer = newbuffer;
-            return true;
-        }
-        */
-    }
-    else if (fileExt == "ogg")
+    alBufferData(newbuffer, format, samples, byteCount, sampleRate);
+
+    if (check_openal_error())
     {
-        // Try the Ogg loader.
-        // In future, ogg files should probably be streamed rather than entirely
-        // buffered in memory.
+        WARN << "alBufferData failed for " << fileName;
 
-        ALuint newbuffer = 0;
-        alGenBuffers(1, &newbuffer);
+        alDeleteBuffers(1, &newbuffer);
+        check_openal_error();
+        return false;
+    }
 
-        if (check_openal_error())
-            return false;
-        else
-        {
-            // First query to find frequency. (since the other function doesn't
-            // give it)
+    bufferLengths[newbuffer] =
+        (f32)byteCount / (f32)(sizeof(s16) * channels * sampleRate);
+    bufferBytes += byteCount;
 
-            ALsizei frequency;
-            bool gotFrequency = false;
+    buffers[fileName] = newbuffer;
+    *buffer = newbuffer;
+    return true;
+}
 
-            int error;
-            stb_vorbis *v = stb_vorbis_open_filename((char *)fileName.c_str(),
-                                                     &error, nullptr);
+bool OpenALSoundSystem::IsStreamed(const core::stringc &fileName)
+{
+    // Archives only hold short sounds, and it saves opening the Ogg.
+    // Otherwise the bank opens it once, and keeps it decoded if it is short
+    // for GetOpenALBuffer.
+    return !FindArchived(fileName) && soundBank.IsStreamed(fileName);
+}
 
-            if (v)
-            {
-                stb_vorbis_info info = stb_vorbis_get_info(v);
+f32 OpenALSoundSystem::GetBufferLength(ALuint buffer)
+{
+    auto it = bufferLengths.find(buffer);
+    return it != bufferLengths.end() ? it->second : 0.f;
+}
 
-                frequency = info.sample_rate;
+bool OpenALSoundSystem::IsLoading(const core::stringc &fileName)
+{
+    return !buffers.count(fileName) && soundBank.IsLoading(fileName);
+}
 
-                stb_vorbis_close(v);
+void OpenALSoundSystem::AddPending(OpenALSound *sound)
+{
+    pendingSounds.Insert(sound);
+}
 
-                gotFrequency = true;
-            }
+void OpenALSoundSystem::RemovePending(OpenALSound *sound)
+{
+    pendingSounds.SwapRemove(sound);
+}
 
-            // Load the ogg
+u32 OpenALSoundSystem::GetSoundMemoryUsage()
+{
+    return SoundSystem::GetSoundMemoryUsage() + bufferBytes;
+}
 
-            short *data = nullptr;
-            int channels, len, sample_rate;
+void OpenALSoundSystem::Update(f32 dt)
+{
+    SoundSystem::Update(dt);
 
-            len = stb_vorbis_decode_filename((char *)fileName.c_str(),
-                                             &channels, &sample_rate, &data);
+    // Move preloaded sounds into OpenAL buffers as they finish decoding.
+    ALuint buffer;
 
-            if (len && gotFrequency)
-            {
-                // Fill buffer with loaded ogg file.
-
-                if (channels == 1 || channels == 2)
-                {
-                    ALenum format;
-
-                    if (channels == 1)
-                        format = AL_FORMAT_MONO16;
-                    else
-                        format = AL_FORMAT_STEREO16;
-
-                    alBufferData(newbuffer, format, data,
-                                 sizeof(short) * len * channels, frequency);
-
-                    if (!check_openal_error())
-                    {
-                        if (data)
-                            free(data);
-
-                        buffers[fileName] = newbuffer;
-                        *buffer = newbuffer;
-                        return true;
-                    }
-                    else
-                    {
-                        WARN << "alBufferData failed for Ogg file, "
-                             << fileName;
-                    }
-                }
-                else
-                {
-                    WARN << "Ogg file has invalid number of channels: ("
-                         << channels << ") - " << fileName;
-                }
-            }
-            else
-            {
-                WARN << "Ogg loading failed: " << fileName;
-            }
+    for (auto &fileName : soundBank.TakeNewlyLoaded())
+        GetOpenALBuffer(fileName, &buffer);
 
-            if (data)
-                free(data);
+    // Start anything that was waiting for them.
+    std::vector<OpenALSound *> ready;
 
-            alDeleteBuffers(1, &newbuffer);
-            check_openal_error(); // may not be an openal error if it was ogg
-                                  // loader that failed
+    for (auto &sound : pendingSounds)
+    {
+        if (!IsLoading(sound->GetPendingFile()))
+            ready.push_back(sound);
+    }
 
-            return false;
-        }
+    for (auto &sound : ready)
+    {
+        core::stringc fileName = sound->GetPendingFile();
+        sound->Play(fileName);
     }
 
-    return false;
+    // Share out the voices.
+    if (!IsPaused())
+        voicePool->Update(allSounds.GetSounds(), dt);
+
+    // Then send everything that moved this tick in one go.
+    if (transformBatch->IsThreaded())
+        transformBatch->Kick();
+    else
+        transformBatch->Submit();
 }
 
 void OpenALSoundSystem::PreloadSound(const core::stringc &soundFile)
 {
+    // Nothing to load up front for streams.
+    if (IsStreamed(soundFile))
+        return;
+
     ALuint buffer;
 
     if (!GetOpenALBuffer(soundFile.c_str(), &buffer))
@@ -218,29 +240,21 @@ void OpenALSoundSystem::PreloadSound(const core::stringc &soundFile)
 
 void OpenALSoundSystem::SetListenerPosition(core::vector3df pos)
 {
-    alListener3f(AL_POSITION, pos.X, pos.Y, -pos.Z);
-    check_openal_error();
+    transformBatch->SetListenerPosition(core::vector3df(pos.X, pos.Y, -pos.Z));
+    voicePool->SetListenerPosition(core::vector3df(pos.X, pos.Y, -pos.Z));
 }
 
 void OpenALSoundSystem::SetListenerOrientation(core::vector3df lookVec,
                                                core::vector3df upVec)
 {
-    ALfloat orientation[6];
-    orientation[0] = lookVec.X;
-    orientation[1] = lookVec.Y;
-    orientation[2] = -lookVec.Z;
-    orientation[3] = upVec.X;
-    orientation[4] = upVec.Y;
-    orientation[5] = -upVec.Z;
-
-    alListenerfv(AL_ORIENTATION, orientation);
-    check_openal_error();
+    transformBatch->SetListenerOrientation(
+        core::vector3df(lookVec.X, lookVec.Y, -lookVec.Z),
+        core::vector3df(upVec.X, upVec.Y, -upVec.Z));
 }
 
 void OpenALSoundSystem::SetListenerVelocity(core::vector3df vel)
 {
-    alListener3f(AL_VELOCITY, vel.X, vel.Y, -vel.Z);
-    check_openal_error();
+    transformBatch->SetListenerVelocity(core::vector3df(vel.X, vel.Y, -vel.Z));
 }
 
 ISound2D *OpenALSoundSystem::CreateSound2D()
@@ -267,7 +281,7 @@ void OpenALSoundSystem::SetGlobalVolume2D(f32 volume)
 {
     globalVolume2D = volume;
 
-    for (auto &elem : allSounds2D)
+    for (auto &elem : soundGroups[ESG_2D])
         elem->SetSeparateVolume(volume);
 }
 
@@ -275,7 +289,7 @@ void OpenALSoundSystem::SetGlobalVolume3D(f32 volume)
 {
     globalVolume3D = volume;
 
-    for (auto &elem : allSounds3D)
+    for (auto &elem : soundGroups[ESG_3D])
         elem->SetSeparateVolume(volume);
 }
 
@@ -1,24 +1,65 @@
 
 #include "SoundSystem.h"
 #include "openal_stuff.h"
+#include "OpenALStreamer.h"
 #include <map>
 
+class OpenALSound;
+class OpenALTransformBatch;
+class OpenALVoicePool;
+
 class OpenALSoundSystem : public SoundSystem
 {
     ALCdevice *device;
     ALCcontext *context;
 
     std::map<core::stringc, ALuint> buffers;
+    std::map<ALuint, f32> bufferLengths;
+    u32 bufferBytes;
+
+    OpenALTransformBatch *transformBatch;
+    OpenALVoicePool *voicePool;
+
+    // Waiting for their file to finish loading before they play.
+    IndexedSet<OpenALSound *> pendingSounds;
+
+    OpenALStreamer *streamer;
 
     f32 globalVolume2D;
     f32 globalVolume3D;
 
+    bool CreateBuffer(const core::stringc &fileName, const s16 *samples,
+                      u32 byteCount, u32 channels, u32 sampleRate,
+                      ALuint *buffer);
+
 public:
-    OpenALSoundSystem();
+    // Threaded sends sound and listener positions from an audio thread.
+    OpenALSoundSystem(bool threaded = false);
     ~OpenALSoundSystem();
 
     bool GetOpenALBuffer(const core::stringc &fileName, ALuint *buffer);
 
+    // Seconds
+    f32 GetBufferLength(ALuint buffer);
+
+    OpenALTransformBatch *GetTransformBatch() { return transformBatch; }
+    OpenALVoicePool *GetVoicePool() { return voicePool; }
+
+    // Should the file be streamed rather than loaded into a buffer?
+    bool IsStreamed(const core::stringc &fileName) override;
+    OpenALStreamer *GetStreamer() { return streamer; }
+
+    // Being decoded on a worker thread?
+    bool IsLoading(const core::stringc &fileName);
+
+    // Used by OpenALSound, to be played once its file is loaded.
+    void AddPending(OpenALSound *sound);
+    void RemovePending(OpenALSound *sound);
+
+    u32 GetSoundMemoryUsage() override;
+
+    void Update(f32 dt) override;
+
     void PreloadSound(const core::stringc &soundFile) override;
 
     void SetListenerPosition(core::vector3df pos) override;
@@ -0,0 +1,300 @@
+
+#include "OpenALStreamer.h"
+#include "stb_vorbis.h"
+#include <chrono>
+
+// Samples per channel decoded at once. About a third of a second at 44.1kHz,
+// so the four buffers hold over a second between them.
+static const u32 STREAM_CHUNK_SAMPLES = 16384;
+
+OpenALStreamer::OpenALStreamer()
+{
+    quit = false;
+}
+
+OpenALStreamer::~OpenALStreamer()
+{
+    if (thread.joinable())
+    {
+        quit = true;
+        thread.join();
+    }
+
+    while (streams.size())
+        Remove(streams.back());
+}
+
+OpenALStreamer::Stream *OpenALStreamer::Find(ALuint source)
+{
+    for (auto &stream : streams)
+    {
+        if (stream->source == source)
+            return stream;
+    }
+
+    return nullptr;
+}
+
+bool OpenALStreamer::Fill(Stream *stream, ALuint buffer)
+{
+    if (stream->ended)
+        return false;
+
+    decoded.resize(STREAM_CHUNK_SAMPLES * stream->channels);
+
+    u32 samples = 0;
+
+    while (samples < STREAM_CHUNK_SAMPLES)
+    {
+        int got = stb_vorbis_get_samples_short_interleaved(
+            stream->vorbis, stream->channels,
+            &decoded[samples * stream->channels],
+            (STREAM_CHUNK_SAMPLES - samples) * stream->channels);
+
+        if (got > 0)
+        {
+            samples += got;
+            continue;
+        }
+
+        // End of the file.
+        if (!stream->looped || !stream->lengthSamples ||
+            !stb_vorbis_seek_start(stream->vorbis))
+        {
+            stream->ended = true;
+            break;
+        }
+    }
+
+    if (!samples)
+        return false;
+
+    alBufferData(buffer, stream->format, &decoded[0],
+                 sizeof(short) * samples * stream->channels,
+                 stream->sampleRate);
+    alSourceQueueBuffers(stream->source, 1, &buffer);
+
+    stream->queuedSamples.push_back(samples);
+    return true;
+}
+
+bool OpenALStreamer::Service(Stream *stream)
+{
+    // Runs on the stream thread, which doesn't call alGetError. The error
+    // state is shared with the main thread, which would then see our errors
+    // or lose its own. Queries are set up to fail safe instead.
+    ALint processed = 0;
+    alGetSourcei(stream->source, AL_BUFFERS_PROCESSED, &processed);
+
+    // Refill each buffer the source has finished with.
+    for (ALint i = 0; i < processed; i++)
+    {
+        ALuint buffer = 0;
+        alSourceUnqueueBuffers(stream->source, 1, &buffer);
+
+        if (!buffer)
+            return false;
+
+        if (stream->queuedSamples.size())
+        {
+            stream->playedSamples += stream->queuedSamples.front();
+            stream->queuedSamples.pop_front();
+        }
+
+        Fill(stream, buffer);
+    }
+
+    ALint state = AL_STOPPED;
+    alGetSourcei(stream->source, AL_SOURCE_STATE, &state);
+
+    if (state == AL_STOPPED)
+    {
+        // Played everything?
+        if (stream->queuedSamples.empty())
+            return false;
+
+        // Otherwise it ran out before being refilled, so carry on.
+        alSourcePlay(stream->source);
+    }
+
+    return true;
+}
+
+void OpenALStreamer::Remove(Stream *stream)
+{
+    alSourceStop(stream->source);
+
+    // Detaches all queued buffers, so they can be deleted.
+    alSourcei(stream->source, AL_BUFFER, 0);
+    alDeleteBuffers(4, stream->buffers);
+
+    stb_vorbis_close(stream->vorbis);
+
+    for (u32 i = 0; i < streams.size(); i++)
+    {
+        if (streams[i] == stream)
+        {
+            streams.erase(streams.begin() + i);
+            break;
+        }
+    }
+
+    delete stream;
+}
+
+void OpenALStreamer::Run()
+{
+    while (!quit)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            for (u32 i = 0; i < streams.size(); i++)
+            {
+                if (!Service(streams[i]))
+                {
+                    Remove(streams[i]);
+                    i--;
+                }
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+}
+
+bool OpenALStreamer::Start(ALuint source, const core::stringc &fileName,
+                           bool looped, bool play)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (Stream *old = Find(source))
+        Remove(old);
+
+    int error;
+    stb_vorbis *vorbis =
+        stb_vorbis_open_filename((char *)fileName.c_str(), &error, nullptr);
+
+    if (!vorbis)
+    {
+        WARN << "Could not open Ogg for streaming: " << fileName;
+        return false;
+    }
+
+    stb_vorbis_info info = stb_vorbis_get_info(vorbis);
+
+    if (info.channels != 1 && info.channels != 2)
+    {
+        WARN << "Ogg file has invalid number of channels: (" << info.channels
+             << ") - " << fileName;
+        stb_vorbis_close(vorbis);
+        return false;
+    }
+
+    auto *stream = new Stream();
+    stream->source = source;
+    stream->vorbis = vorbis;
+    stream->format = info.channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+    stream->sampleRate = info.sample_rate;
+    stream->channels = info.channels;
+    stream->lengthSamples = stb_vorbis_stream_length_in_samples(vorbis);
+    stream->playedSamples = 0;
+    stream->looped = looped;
+    stream->ended = false;
+
+    alGenBuffers(4, stream->buffers);
+
+    if (check_openal_error())
+    {
+        stb_vorbis_close(vorbis);
+        delete stream;
+        return false;
+    }
+
+    // Source must be cleared of any static buffer before queueing, and must
+    // not loop or the queue would never be processed.
+    alSourceStop(source);
+    alSourcei(source, AL_BUFFER, 0);
+    alSourcei(source, AL_LOOPING, AL_FALSE);
+    check_openal_error();
+
+    streams.push_back(stream);
+
+    for (auto &buffer : stream->buffers)
+    {
+        if (!Fill(stream, buffer))
+            break;
+    }
+
+    if (check_openal_error())
+        stream->queuedSamples.clear();
+
+    if (stream->queuedSamples.empty())
+    {
+        WARN << "Ogg streaming failed: " << fileName;
+        Remove(stream);
+        return false;
+    }
+
+    if (play)
+    {
+        alSourcePlay(source);
+        check_openal_error();
+    }
+
+    if (!thread.joinable())
+        thread = std::thread(&OpenALStreamer::Run, this);
+
+    return true;
+}
+
+void OpenALStreamer::Stop(ALuint source)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (Stream *stream = Find(source))
+    {
+        Remove(stream);
+        check_openal_error();
+    }
+}
+
+bool OpenALStreamer::IsStreaming(ALuint source)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return Find(source) != nullptr;
+}
+
+void OpenALStreamer::SetIsLooped(ALuint source, bool looped)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Takes effect from the next chunk decoded. If the end was already
+    // reached, it's too late to loop.
+    if (Stream *stream = Find(source))
+        stream->looped = looped;
+}
+
+f32 OpenALStreamer::GetPlayPosition(ALuint source)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Stream *stream = Find(source);
+
+    if (!stream)
+        return 0.f;
+
+    ALint offset = 0;
+    alGetSourcei(source, AL_SAMPLE_OFFSET, &offset);
+
+    if (check_openal_error())
+        offset = 0;
+
+    u64 samples = stream->playedSamples + offset;
+
+    // Wraps around when looped.
+    if (stream->lengthSamples)
+        samples %= stream->lengthSamples;
+
+    return (f32)samples / (f32)stream->sampleRate;
+}
@@ -0,0 +1,87 @@
+
+#ifndef OPENAL_STREAMER_H
+#define OPENAL_STREAMER_H
+
+#include "litha_internal.h"
+#include "openal_stuff.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct stb_vorbis;
+
+// Plays long Ogg files (music, ambience) without decoding them whole.
+// Each stream decodes a chunk at a time into a small ring of OpenAL buffers
+// queued on its source. A background thread refills buffers as the source
+// finishes with them, so nothing is decoded on the calling thread after the
+// first few chunks. Only the calling thread checks for OpenAL errors.
+class OpenALStreamer
+{
+    struct Stream
+    {
+        ALuint source;
+
+        stb_vorbis *vorbis;
+        ALenum format;
+        ALsizei sampleRate;
+        u32 channels;
+        u32 lengthSamples; // per channel
+
+        ALuint buffers[4];
+
+        // Samples (per channel) in each buffer queued on the source, oldest
+        // first. For the play position.
+        std::deque<u32> queuedSamples;
+        u64 playedSamples;
+
+        bool looped;
+
+        // Everything has been decoded and queued.
+        bool ended;
+    };
+
+    std::vector<Stream *> streams;
+    std::mutex mutex;
+
+    std::thread thread;
+    std::atomic<bool> quit;
+
+    // Used by the thread only (or the caller of Start, under the mutex)
+    std::vector<short> decoded;
+
+    Stream *Find(ALuint source);
+
+    // Decode the next chunk into a buffer and queue it.
+    // Returns false if there was nothing left to decode.
+    bool Fill(Stream *stream, ALuint buffer);
+
+    // Returns false once the stream has finished playing.
+    bool Service(Stream *stream);
+
+    void Remove(Stream *stream);
+    void Run();
+
+public:
+    OpenALStreamer();
+    ~OpenALStreamer();
+
+    // Start streaming the file on the source, stopping anything already on
+    // it. Starts playing if play is true.
+    bool Start(ALuint source, const core::stringc &fileName, bool looped,
+               bool play);
+
+    // Stops the source too.
+    void Stop(ALuint source);
+
+    // Still has something to play? (may be paused, or briefly starved)
+    bool IsStreaming(ALuint source);
+
+    void SetIsLooped(ALuint source, bool looped);
+
+    // Seconds into the file.
+    f32 GetPlayPosition(ALuint source);
+};
+
+#endif
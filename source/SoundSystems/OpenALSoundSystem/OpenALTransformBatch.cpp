@@ -0,0 +1,218 @@
+
+#include "OpenALTransformBatch.h"
+
+// Smaller movements than these aren't worth telling OpenAL about.
+static const f32 POSITION_THRESHOLD_SQ = 0.01f * 0.01f;
+static const f32 VELOCITY_THRESHOLD_SQ = 0.05f * 0.05f;
+
+OpenALTransformBatch::OpenALTransformBatch(ALCcontext *context, bool threaded)
+{
+    this->context = context;
+
+    listener.look = core::vector3df(0, 0, -1);
+    listener.up = core::vector3df(0, 1, 0);
+    listener.changed = true;
+
+    kick = false;
+    quit = false;
+
+    if (threaded && context)
+        thread = std::thread(&OpenALTransformBatch::Run, this);
+}
+
+OpenALTransformBatch::~OpenALTransformBatch()
+{
+    if (thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+
+        kicked.notify_one();
+        thread.join();
+    }
+}
+
+u32 OpenALTransformBatch::Add()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    SoundTransform transform;
+    transform.source = 0;
+
+    if (freeSlots.size())
+    {
+        u32 slot = freeSlots.back();
+        freeSlots.pop_back();
+        transforms[slot] = transform;
+        return slot;
+    }
+
+    transforms.push_back(transform);
+    return transforms.size() - 1;
+}
+
+void OpenALTransformBatch::Remove(u32 slot)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    transforms[slot].source = 0;
+    freeSlots.push_back(slot);
+}
+
+void OpenALTransformBatch::SetPosition(u32 slot, const core::vector3df &pos)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    transforms[slot].position = pos;
+}
+
+void OpenALTransformBatch::SetVelocity(u32 slot, const core::vector3df &vel)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    transforms[slot].velocity = vel;
+}
+
+core::vector3df OpenALTransformBatch::GetPosition(u32 slot)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return transforms[slot].position;
+}
+
+void OpenALTransformBatch::SendSource(SoundTransform &transform)
+{
+    alSource3f(transform.source, AL_POSITION, transform.position.X,
+               transform.position.Y, transform.position.Z);
+    alSource3f(transform.source, AL_VELOCITY, transform.velocity.X,
+               transform.velocity.Y, transform.velocity.Z);
+
+    transform.sentPosition = transform.position;
+    transform.sentVelocity = transform.velocity;
+}
+
+void OpenALTransformBatch::Attach(u32 slot, ALuint source)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    transforms[slot].source = source;
+    SendSource(transforms[slot]);
+    check_openal_error();
+}
+
+void OpenALTransformBatch::Detach(u32 slot)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    transforms[slot].source = 0;
+}
+
+void OpenALTransformBatch::SetListenerPosition(const core::vector3df &pos)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (pos.getDistanceFromSQ(listener.position) > POSITION_THRESHOLD_SQ)
+    {
+        listener.position = pos;
+        listener.changed = true;
+    }
+}
+
+void OpenALTransformBatch::SetListenerVelocity(const core::vector3df &vel)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (vel.getDistanceFromSQ(listener.velocity) > VELOCITY_THRESHOLD_SQ)
+    {
+        listener.velocity = vel;
+        listener.changed = true;
+    }
+}
+
+void OpenALTransformBatch::SetListenerOrientation(const core::vector3df &look,
+                                                  const core::vector3df &up)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!look.equals(listener.look) || !up.equals(listener.up))
+    {
+        listener.look = look;
+        listener.up = up;
+        listener.changed = true;
+    }
+}
+
+void OpenALTransformBatch::SubmitLocked()
+{
+    PROFILE_ZONE("OpenALTransformBatch::Submit");
+
+    if (context)
+        alcSuspendContext(context);
+
+    if (listener.changed)
+    {
+        alListener3f(AL_POSITION, listener.position.X, listener.position.Y,
+                     listener.position.Z);
+        alListener3f(AL_VELOCITY, listener.velocity.X, listener.velocity.Y,
+                     listener.velocity.Z);
+
+        ALfloat orientation[6] = {listener.look.X, listener.look.Y,
+                                  listener.look.Z, listener.up.X,
+                                  listener.up.Y,   listener.up.Z};
+        alListenerfv(AL_ORIENTATION, orientation);
+
+        listener.changed = false;
+    }
+
+    for (auto &transform : transforms)
+    {
+        // Virtual sounds are sent when they get a voice.
+        if (!transform.source)
+            continue;
+
+        if (transform.position.getDistanceFromSQ(transform.sentPosition) >
+                POSITION_THRESHOLD_SQ ||
+            transform.velocity.getDistanceFromSQ(transform.sentVelocity) >
+                VELOCITY_THRESHOLD_SQ)
+        {
+            SendSource(transform);
+        }
+    }
+
+    // The error state is shared, so only the main thread checks it.
+    if (!IsThreaded())
+        check_openal_error();
+
+    if (context)
+        alcProcessContext(context);
+}
+
+void OpenALTransformBatch::Submit()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    SubmitLocked();
+}
+
+void OpenALTransformBatch::Kick()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        kick = true;
+    }
+
+    kicked.notify_one();
+}
+
+void OpenALTransformBatch::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+        kicked.wait(lock, [this] { return kick || quit; });
+
+        if (quit)
+            return;
+
+        kick = false;
+        SubmitLocked();
+    }
+}
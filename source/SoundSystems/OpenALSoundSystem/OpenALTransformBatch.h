@@ -0,0 +1,86 @@
+
+#ifndef OPENAL_TRANSFORM_BATCH_H
+#define OPENAL_TRANSFORM_BATCH_H
+
+#include "litha_internal.h"
+#include "openal_stuff.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Positions and velocities of every sound (and the listener), kept in one
+// array and sent to OpenAL together once per update.
+// Setting a position only records it. Submit then sends, in one suspended
+// context, just those of sounds with a voice that have moved noticeably
+// since they were last sent.
+// Optionally Submit runs on its own thread, woken by Kick.
+// (all methods lock, so can be used from both)
+class OpenALTransformBatch
+{
+    struct SoundTransform
+    {
+        ALuint source; // 0 if virtual or unused
+        core::vector3df position;
+        core::vector3df velocity;
+
+        // As last given to OpenAL
+        core::vector3df sentPosition;
+        core::vector3df sentVelocity;
+    };
+
+    std::vector<SoundTransform> transforms;
+    std::vector<u32> freeSlots;
+
+    struct Listener
+    {
+        core::vector3df position;
+        core::vector3df velocity;
+        core::vector3df look;
+        core::vector3df up;
+        bool changed;
+    };
+
+    Listener listener;
+
+    ALCcontext *context;
+    std::mutex mutex;
+
+    std::thread thread;
+    std::condition_variable kicked;
+    bool kick;
+    bool quit;
+
+    void SendSource(SoundTransform &transform);
+    void SubmitLocked();
+    void Run();
+
+public:
+    OpenALTransformBatch(ALCcontext *context, bool threaded);
+    ~OpenALTransformBatch();
+
+    u32 Add();
+    void Remove(u32 slot);
+
+    // OpenAL coordinates
+    void SetPosition(u32 slot, const core::vector3df &pos);
+    void SetVelocity(u32 slot, const core::vector3df &vel);
+    core::vector3df GetPosition(u32 slot);
+
+    // Sends the transform to the voice straight away.
+    void Attach(u32 slot, ALuint source);
+    void Detach(u32 slot);
+
+    void SetListenerPosition(const core::vector3df &pos);
+    void SetListenerVelocity(const core::vector3df &vel);
+    void SetListenerOrientation(const core::vector3df &look,
+                                const core::vector3df &up);
+
+    // Send what changed. Call once per update, or Kick if threaded.
+    void Submit();
+    void Kick();
+
+    bool IsThreaded() const { return thread.joinable(); }
+};
+
+#endif
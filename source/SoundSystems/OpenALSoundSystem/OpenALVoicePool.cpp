@@ -0,0 +1,321 @@
+
+#include "OpenALVoicePool.h"
+#include "OpenALSound.h"
+#include "OpenALStreamer.h"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+
+// Enough for everything audible at once in a level. Fewer if the device
+// can't do that many.
+static const u32 MAX_VOICES = 32;
+
+// Quieter than this and a sound doesn't need a voice at all.
+static const f32 INAUDIBLE_GAIN = 0.001f;
+
+// Sounds that already have a voice are favoured a little, so that two
+// similar sounds don't keep swapping.
+static const f32 KEEP_VOICE_BIAS = 1.25f;
+
+bool OpenALVoicePool::Candidate::operator<(const Candidate &other) const
+{
+    // Most important first.
+    if (priority != other.priority)
+        return priority > other.priority;
+
+    return gain > other.gain;
+}
+
+OpenALVoicePool::OpenALVoicePool(ALCdevice *device, OpenALStreamer *streamer)
+{
+    this->streamer = streamer;
+    events = false;
+
+    u32 count = MAX_VOICES;
+
+    if (device)
+    {
+        ALCint monoSources = 0;
+        alcGetIntegerv(device, ALC_MONO_SOURCES, 1, &monoSources);
+
+        if (monoSources > 0)
+            count = core::min_(count, (u32)monoSources);
+    }
+
+    for (u32 i = 0; i < count; i++)
+    {
+        Voice voice;
+        voice.source = 0;
+        voice.owner = nullptr;
+
+        alGenSources(1, &voice.source);
+
+        if (check_openal_error())
+            break;
+
+        voices.push_back(voice);
+    }
+
+    NOTE << "Created " << voices.size() << " OpenAL voices";
+
+    if (device)
+        EnableEvents();
+}
+
+OpenALVoicePool::~OpenALVoicePool()
+{
+#ifdef AL_SOFT_events
+    if (events)
+    {
+        auto alEventCallbackSOFT =
+            (LPALEVENTCALLBACKSOFT)alGetProcAddress("alEventCallbackSOFT");
+        alEventCallbackSOFT(nullptr, nullptr);
+        check_openal_error();
+    }
+#endif
+
+    for (auto &voice : voices)
+    {
+        if (voice.owner)
+            voice.owner->DetachVoice();
+
+        alDeleteSources(1, &voice.source);
+        check_openal_error();
+    }
+}
+
+#ifdef AL_SOFT_events
+void AL_APIENTRY OpenALVoicePool::OnEvent(ALenum eventType, ALuint object,
+                                          ALuint param, ALsizei length,
+                                          const ALchar *message,
+                                          void *userParam)
+{
+    auto *pool = (OpenALVoicePool *)userParam;
+
+    if (eventType == AL_EVENT_TYPE_SOURCE_STATE_CHANGED_SOFT &&
+        param == AL_STOPPED)
+    {
+        std::lock_guard<std::mutex> lock(pool->eventMutex);
+        pool->stoppedSources.push_back(object);
+    }
+}
+#endif
+
+void OpenALVoicePool::EnableEvents()
+{
+#ifdef AL_SOFT_events
+    if (!alIsExtensionPresent("AL_SOFT_events"))
+        return;
+
+    auto alEventControlSOFT =
+        (LPALEVENTCONTROLSOFT)alGetProcAddress("alEventControlSOFT");
+    auto alEventCallbackSOFT =
+        (LPALEVENTCALLBACKSOFT)alGetProcAddress("alEventCallbackSOFT");
+
+    if (!alEventControlSOFT || !alEventCallbackSOFT)
+        return;
+
+    alEventCallbackSOFT(&OnEvent, this);
+
+    ALenum types[] = {AL_EVENT_TYPE_SOURCE_STATE_CHANGED_SOFT};
+    alEventControlSOFT(1, types, AL_TRUE);
+
+    events = !check_openal_error();
+
+    if (events)
+        NOTE << "Using AL_SOFT_events for sound completion";
+#endif
+}
+
+void OpenALVoicePool::CheckStopped(Voice &voice)
+{
+    if (!voice.owner)
+        return;
+
+    // Starved streams are restarted by the streamer, so have only finished
+    // once it has let go of them.
+    if (voice.owner->IsStreaming() && streamer->IsStreaming(voice.source))
+        return;
+
+    ALint state;
+    alGetSourcei(voice.source, AL_SOURCE_STATE, &state);
+
+    if (!check_openal_error() && state == AL_STOPPED)
+    {
+        voice.owner->OnVoiceStopped();
+        voice.owner->DetachVoice();
+        voice.owner = nullptr;
+    }
+}
+
+OpenALVoicePool::Candidate OpenALVoicePool::GetCandidate(OpenALSound *sound)
+{
+    Candidate candidate;
+    candidate.sound = sound;
+
+    if (sound->IsStreaming())
+    {
+        candidate.priority = INT_MAX;
+        candidate.gain = FLT_MAX;
+        return candidate;
+    }
+
+    candidate.priority = sound->GetPriority();
+    candidate.gain =
+        sound->GetAudibleGain(listenerPosition, INAUDIBLE_GAIN);
+
+    if (sound->HasVoice())
+        candidate.gain *= KEEP_VOICE_BIAS;
+
+    return candidate;
+}
+
+void OpenALVoicePool::Attach(Voice &voice, OpenALSound *sound)
+{
+    voice.owner = sound;
+    sound->AttachVoice(voice.source);
+}
+
+bool OpenALVoicePool::Acquire(OpenALSound *sound)
+{
+    if (sound->HasVoice())
+        return true;
+
+    Candidate candidate = GetCandidate(sound);
+
+    if (candidate.gain < INAUDIBLE_GAIN)
+        return false;
+
+    Voice *weakest = nullptr;
+    Candidate weakestCandidate;
+
+    for (auto &voice : voices)
+    {
+        if (!voice.owner)
+        {
+            Attach(voice, sound);
+            return true;
+        }
+
+        Candidate other = GetCandidate(voice.owner);
+
+        if (!weakest || weakestCandidate < other)
+        {
+            weakest = &voice;
+            weakestCandidate = other;
+        }
+    }
+
+    if (!weakest || !(candidate < weakestCandidate))
+        return false;
+
+    weakest->owner->DetachVoice();
+    Attach(*weakest, sound);
+    return true;
+}
+
+void OpenALVoicePool::Release(OpenALSound *sound)
+{
+    for (auto &voice : voices)
+    {
+        if (voice.owner == sound)
+        {
+            sound->DetachVoice();
+            voice.owner = nullptr;
+            return;
+        }
+    }
+}
+
+void OpenALVoicePool::Update(const std::vector<OpenALSound *> &sounds, f32 dt)
+{
+    PROFILE_ZONE("OpenALVoicePool::Update");
+
+    // Free the voices of anything that has played to the end.
+    if (events)
+    {
+        {
+            std::lock_guard<std::mutex> lock(eventMutex);
+            takenStoppedSources.swap(stoppedSources);
+        }
+
+        // These may be old, from a voice stopped by DetachVoice and since
+        // given to another sound, so CheckStopped asks again.
+        for (ALuint source : takenStoppedSources)
+        {
+            for (auto &voice : voices)
+            {
+                if (voice.source == source)
+                    CheckStopped(voice);
+            }
+        }
+
+        takenStoppedSources.clear();
+
+        // A stream's last stop can come before the streamer lets go of it.
+        for (auto &voice : voices)
+        {
+            if (voice.owner && voice.owner->IsStreaming())
+                CheckStopped(voice);
+        }
+    }
+    else
+    {
+        for (auto &voice : voices)
+            CheckStopped(voice);
+    }
+
+    std::vector<Candidate> candidates;
+
+    for (auto &sound : sounds)
+    {
+        sound->AdvanceVirtual(dt);
+
+        if (sound->IsActive())
+            candidates.push_back(GetCandidate(sound));
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    // Those that miss out first, to free their voices for the rest.
+    for (u32 i = 0; i < candidates.size(); i++)
+    {
+        OpenALSound *sound = candidates[i].sound;
+
+        if ((i >= voices.size() || candidates[i].gain < INAUDIBLE_GAIN) &&
+            sound->HasVoice() && !sound->IsStreaming())
+        {
+            Release(sound);
+        }
+    }
+
+    for (u32 i = 0; i < candidates.size() && i < voices.size(); i++)
+    {
+        OpenALSound *sound = candidates[i].sound;
+
+        if (sound->HasVoice() || candidates[i].gain < INAUDIBLE_GAIN)
+            continue;
+
+        for (auto &voice : voices)
+        {
+            if (!voice.owner)
+            {
+                Attach(voice, sound);
+                break;
+            }
+        }
+    }
+}
+
+u32 OpenALVoicePool::GetVoicesInUse() const
+{
+    u32 count = 0;
+
+    for (auto &voice : voices)
+    {
+        if (voice.owner)
+            count++;
+    }
+
+    return count;
+}
@@ -0,0 +1,91 @@
+
+#ifndef OPENAL_VOICE_POOL_H
+#define OPENAL_VOICE_POOL_H
+
+#include "litha_internal.h"
+#include "openal_stuff.h"
+#include <mutex>
+#include <vector>
+
+class OpenALSound;
+class OpenALStreamer;
+
+// A fixed set of OpenAL sources (voices), created once and shared out
+// between sounds.
+// Each update the playing sounds are ranked by priority then by how loud
+// they would be heard, and only the top ones keep a voice. The rest are
+// virtual (see OpenALSound) until they rank highly enough again.
+// Streams are never made virtual.
+// Voices that stop are noticed here, once per update, and their sounds
+// told. With OpenAL Soft's AL_SOFT_events OpenAL says which sources stopped,
+// otherwise each voice in use is polled.
+class OpenALVoicePool
+{
+    struct Voice
+    {
+        ALuint source;
+        OpenALSound *owner;
+    };
+
+    std::vector<Voice> voices;
+
+    OpenALStreamer *streamer;
+
+    // Sources that OpenAL says have stopped since the last update. Filled on
+    // OpenAL's event thread.
+    bool events;
+    std::mutex eventMutex;
+    std::vector<ALuint> stoppedSources;
+    std::vector<ALuint> takenStoppedSources;
+
+#ifdef AL_SOFT_events
+    static void AL_APIENTRY OnEvent(ALenum eventType, ALuint object,
+                                    ALuint param, ALsizei length,
+                                    const ALchar *message, void *userParam);
+#endif
+
+    void EnableEvents();
+
+    // Frees the voice if it has played to the end.
+    void CheckStopped(Voice &voice);
+
+    core::vector3df listenerPosition;
+
+    struct Candidate
+    {
+        OpenALSound *sound;
+        s32 priority;
+        f32 gain;
+
+        bool operator<(const Candidate &other) const;
+    };
+
+    Candidate GetCandidate(OpenALSound *sound);
+    void Attach(Voice &voice, OpenALSound *sound);
+
+public:
+    OpenALVoicePool(ALCdevice *device, OpenALStreamer *streamer);
+    ~OpenALVoicePool();
+
+    // In OpenAL coordinates.
+    void SetListenerPosition(const core::vector3df &pos)
+    {
+        listenerPosition = pos;
+    }
+
+    // Give a sound a voice if one is free, or take one from a sound that is
+    // less important. Returns false if the sound stays virtual.
+    bool Acquire(OpenALSound *sound);
+
+    // Take its voice back.
+    void Release(OpenALSound *sound);
+
+    // Frees voices that have played to the end, advances virtual sounds, and
+    // hands out voices to the sounds that most need them.
+    void Update(const std::vector<OpenALSound *> &sounds, f32 dt);
+
+    u32 GetVoiceCount() const { return voices.size(); }
+    u32 GetVoicesInUse() const;
+};
+
+#endif
@@ -8,6 +8,7 @@
 #else
 #include <AL/al.h>
 #include <AL/alc.h>
+#include <AL/alext.h> // for AL_SOFT_events, where the headers are new enough
 #endif
 
 // this checks for openal errors
@@ -1,60 +1,37 @@
 
 #include "sound_reg.h"
-#include "OpenALSound2D.h"
-#include "OpenALSound3D.h"
+#include "OpenALSound.h"
 
-std::vector<OpenALSound *> allSounds;
-std::vector<OpenALSound2D *> allSounds2D;
-std::vector<OpenALSound3D *> allSounds3D;
+SoundList allSounds(&SoundRegEntry::allIndex);
 
-void register_sound2d(OpenALSound2D *sound)
+SoundList soundGroups[ESG_COUNT] = {SoundList(&SoundRegEntry::groupIndex),
+                                    SoundList(&SoundRegEntry::groupIndex)};
+
+void SoundList::Add(OpenALSound *sound)
 {
-    allSounds.push_back(sound);
-    allSounds2D.push_back(sound);
+    sound->reg.*index = sounds.size();
+    sounds.push_back(sound);
 }
 
-void unregister_sound2d(OpenALSound2D *sound)
+void SoundList::Remove(OpenALSound *sound)
 {
-    for (u32 i = 0; i < allSounds.size(); i++)
-    {
-        if (allSounds[i] == sound)
-        {
-            allSounds.erase(allSounds.begin() + i);
-            break;
-        }
-    }
-    for (u32 i = 0; i < allSounds2D.size(); i++)
-    {
-        if (allSounds2D[i] == sound)
-        {
-            allSounds2D.erase(allSounds2D.begin() + i);
-            break;
-        }
-    }
+    u32 i = sound->reg.*index;
+    ASSERT(i < sounds.size() && sounds[i] == sound);
+
+    sounds[i] = sounds.back();
+    sounds[i]->reg.*index = i;
+    sounds.pop_back();
 }
 
-void register_sound3d(OpenALSound3D *sound)
+void register_sound(OpenALSound *sound, E_SOUND_GROUP group)
 {
-    allSounds.push_back(sound);
-    allSounds3D.push_back(sound);
+    sound->reg.group = group;
+    allSounds.Add(sound);
+    soundGroups[group].Add(sound);
 }
 
-void unregister_sound3d(OpenALSound3D *sound)
+void unregister_sound(OpenALSound *sound)
 {
-    for (u32 i = 0; i < allSounds.size(); i++)
-    {
-        if (allSounds[i] == sound)
-        {
-            allSounds.erase(allSounds.begin() + i);
-            break;
-        }
-    }
-    for (u32 i = 0; i < allSounds3D.size(); i++)
-    {
-        if (allSounds3D[i] == sound)
-        {
-            allSounds3D.erase(allSounds3D.begin() + i);
-            break;
-        }
-    }
+    allSounds.Remove(sound);
+    soundGroups[sound->reg.group].Remove(sound);
 }
@@ -2,20 +2,61 @@
 #ifndef SOUND_REG_H
 #define SOUND_REG_H
 
+#include "litha_internal.h"
 #include <vector>
 
 class OpenALSound;
-class OpenALSound2D;
-class OpenALSound3D;
 
-extern std::vector<OpenALSound *> allSounds;
-extern std::vector<OpenALSound2D *> allSounds2D;
-extern std::vector<OpenALSound3D *> allSounds3D;
+enum E_SOUND_GROUP
+{
+    ESG_2D,
+    ESG_3D,
+    ESG_COUNT
+};
 
-void register_sound2d(OpenALSound2D *sound);
-void unregister_sound2d(OpenALSound2D *sound);
+// Kept in each sound, its place in the lists below.
+struct SoundRegEntry
+{
+    E_SOUND_GROUP group;
+    u32 allIndex;
+    u32 groupIndex;
+};
 
-void register_sound3d(OpenALSound3D *sound);
-void unregister_sound3d(OpenALSound3D *sound);
+// A list of live sounds. Each sound knows its own index in the list, so can
+// be removed in O(1) by moving the last sound into its place.
+// Order is not kept.
+class SoundList
+{
+    std::vector<OpenALSound *> sounds;
+
+    // Which index in SoundRegEntry this list uses.
+    u32 SoundRegEntry::*index;
+
+public:
+    SoundList(u32 SoundRegEntry::*index) : index(index) {}
+
+    void Add(OpenALSound *sound);
+    void Remove(OpenALSound *sound);
+
+    const std::vector<OpenALSound *> &GetSounds() const { return sounds; }
+
+    u32 size() const { return sounds.size(); }
+
+    std::vector<OpenALSound *>::const_iterator begin() const
+    {
+        return sounds.begin();
+    }
+
+    std::vector<OpenALSound *>::const_iterator end() const
+    {
+        return sounds.end();
+    }
+};
+
+extern SoundList allSounds;
+extern SoundList soundGroups[ESG_COUNT];
+
+void register_sound(OpenALSound *sound, E_SOUND_GROUP group);
+void unregister_sound(OpenALSound *sound);
 
 #endif
@@ -0,0 +1,132 @@
+
+#include "SoftwareSound.h"
+#include "SoftwareSoundSystem.h"
+#include <cmath>
+
+SoftwareSound::SoftwareSound(SoftwareSoundSystem *soundSystem)
+{
+    this->soundSystem = soundSystem;
+
+    volume = 1.f;
+    looped = false;
+    priority = 0;
+
+    samples = nullptr;
+    frameCount = 0;
+    channels = 0;
+    sampleRate = 0;
+
+    active = false;
+    position = 0.0;
+
+    soundSystem->Register(this);
+}
+
+SoftwareSound::~SoftwareSound()
+{
+    soundSystem->Unregister(this);
+}
+
+void SoftwareSound::Play(const core::stringc &soundFile)
+{
+    Stop();
+
+    if (!soundSystem->GetSamples(soundFile, &samples, &frameCount, &channels,
+                                 &sampleRate, &decoded))
+    {
+        WARN << "Could not load (" << soundFile.c_str() << ")";
+        return;
+    }
+
+    active = frameCount > 0;
+}
+
+void SoftwareSound::Stop()
+{
+    bool wasPlaying = active;
+
+    active = false;
+    position = 0.0;
+
+    // Whether it reached the end or was stopped early.
+    if (wasPlaying)
+        soundSystem->NotifyFinished(this);
+}
+
+void SoftwareSound::Finish()
+{
+    Stop();
+}
+
+void SoftwareSound::SetIsLooped(bool loop)
+{
+    looped = loop;
+}
+
+bool SoftwareSound::IsFinished()
+{
+    return !active;
+}
+
+bool SoftwareSound::IsPlaying()
+{
+    return active && !IsPaused();
+}
+
+f32 SoftwareSound::GetPlayPosition()
+{
+    if (!active)
+        return 0.f;
+
+    return position / sampleRate;
+}
+
+void SoftwareSound::SetVolume(f32 volume)
+{
+    this->volume = volume;
+}
+
+void SoftwareSound::SetPriority(s32 priority)
+{
+    this->priority = priority;
+}
+
+void SoftwareSound::Mix(f32 *output, u32 outputFrames, u32 outputRate,
+                        f32 left, f32 right)
+{
+    // Nearest sample resampling, it's measuring the cost that matters here
+    // rather than the quality.
+    f64 step = (f64)sampleRate / (f64)outputRate;
+    u32 last = channels - 1;
+
+    for (u32 i = 0; i < outputFrames && active; i++)
+    {
+        const s16 *frame = &samples[(u32)position * channels];
+
+        output[i * 2] += frame[0] * left;
+        output[i * 2 + 1] += frame[last] * right;
+
+        position += step;
+
+        if (position >= frameCount)
+        {
+            if (looped)
+                position = fmod(position, (f64)frameCount);
+            else
+                Finish();
+        }
+    }
+}
+
+void SoftwareSound::Skip(u32 outputFrames, u32 outputRate)
+{
+    position += (f64)outputFrames * sampleRate / outputRate;
+
+    if (position >= frameCount)
+    {
+        if (looped)
+            position = fmod(position, (f64)frameCount);
+        else
+            Finish();
+    }
+}
@@ -0,0 +1,73 @@
+
+#ifndef SOFTWARE_SOUND_H
+#define SOFTWARE_SOUND_H
+
+#include "ISound.h"
+#include "SoundBank.h" // DecodedSoundPtr
+
+class SoftwareSoundSystem;
+
+// A sound mixed by SoftwareSoundSystem.
+// Nothing happens here when playing, the sound system reads the samples
+// from the current position each update.
+class SoftwareSound : public virtual ISound
+{
+    f32 volume;
+    bool looped;
+    s32 priority;
+
+    // What is playing
+    const s16 *samples;
+    u32 frameCount;
+    u32 channels;
+    u32 sampleRate;
+    DecodedSoundPtr decoded; // keeps the samples, unless from an archive
+
+    // Played and not yet stopped or finished.
+    bool active;
+
+    // Frames into the sound. Fractional, as the output rate may differ.
+    f64 position;
+
+    // Reached the end.
+    void Finish();
+
+protected:
+    SoftwareSoundSystem *soundSystem;
+
+    // Paused sounds just aren't mixed.
+    void OnPause() override {}
+    void OnResume() override {}
+
+public:
+    SoftwareSound(SoftwareSoundSystem *soundSystem);
+    ~SoftwareSound();
+
+    void Play(const core::stringc &soundFile) override;
+
+    void Stop() override;
+    void SetIsLooped(bool loop) override;
+    bool IsFinished() override;
+    bool IsPlaying() override;
+    f32 GetPlayPosition() override;
+    void SetVolume(f32 volume) override;
+    void SetPriority(s32 priority) override;
+
+    // Used by SoftwareSoundSystem
+    bool IsActive() const { return active; }
+    s32 GetPriority() const { return priority; }
+    f32 GetVolume() const { return volume; }
+    virtual bool Is3D() const = 0;
+
+    // Gain of each output channel, from the listener's point of view.
+    virtual void GetChannelGains(f32 gain, f32 &left, f32 &right) = 0;
+
+    // Adds frames to a stereo output buffer, advancing the play position.
+    void Mix(f32 *output, u32 outputFrames, u32 outputRate, f32 left,
+             f32 right);
+
+    // Advances the play position without mixing anything.
+    void Skip(u32 outputFrames, u32 outputRate);
+};
+
+#endif
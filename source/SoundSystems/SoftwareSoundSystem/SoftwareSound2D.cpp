@@ -0,0 +1,20 @@
+
+#include "SoftwareSound2D.h"
+
+SoftwareSound2D::SoftwareSound2D(SoftwareSoundSystem *soundSystem)
+    : SoftwareSound(soundSystem)
+{
+    pan = 0.f;
+}
+
+void SoftwareSound2D::SetPan(f32 panning)
+{
+    pan = core::clamp(panning, -1.f, 1.f);
+}
+
+void SoftwareSound2D::GetChannelGains(f32 gain, f32 &left, f32 &right)
+{
+    // -1 is fully left, 1 fully right.
+    left = gain * core::min_(1.f - pan, 1.f);
+    right = gain * core::min_(1.f + pan, 1.f);
+}
@@ -0,0 +1,21 @@
+
+#ifndef SOFTWARE_SOUND_2D_H
+#define SOFTWARE_SOUND_2D_H
+
+#include "SoftwareSound.h"
+#include "ISound2D.h"
+
+class SoftwareSound2D : public SoftwareSound, public ISound2D
+{
+    f32 pan;
+
+public:
+    SoftwareSound2D(SoftwareSoundSystem *soundSystem);
+
+    void SetPan(f32 panning) override;
+
+    bool Is3D() const override { return false; }
+    void GetChannelGains(f32 gain, f32 &left, f32 &right) override;
+};
+
+#endif
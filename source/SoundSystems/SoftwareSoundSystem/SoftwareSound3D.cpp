@@ -0,0 +1,41 @@
+
+#include "SoftwareSound3D.h"
+#include "SoftwareSoundSystem.h"
+
+SoftwareSound3D::SoftwareSound3D(SoftwareSoundSystem *soundSystem)
+    : SoftwareSound(soundSystem)
+{
+    maxVolumePoint = 1.f;
+}
+
+void SoftwareSound3D::SetPosition(core::vector3df pos)
+{
+    position = pos;
+}
+
+void SoftwareSound3D::SetVelocity(core::vector3df vel)
+{
+}
+
+void SoftwareSound3D::SetMaxVolumePoint(f32 proximity)
+{
+    maxVolumePoint = proximity;
+}
+
+void SoftwareSound3D::GetChannelGains(f32 gain, f32 &left, f32 &right)
+{
+    core::vector3df offset = position - soundSystem->GetListenerPosition();
+
+    // Inverse distance clamped, as OpenAL does by default.
+    f32 distance = core::max_(offset.getLength(), maxVolumePoint);
+    gain *= maxVolumePoint / distance;
+
+    // Simple panning by how far to the right of the listener it is.
+    f32 pan = 0.f;
+
+    if (!offset.equals(core::vector3df(0, 0, 0)))
+        pan = offset.normalize().dotProduct(soundSystem->GetListenerRight());
+
+    left = gain * core::min_(1.f - pan, 1.f);
+    right = gain * core::min_(1.f + pan, 1.f);
+}
@@ -0,0 +1,24 @@
+
+#ifndef SOFTWARE_SOUND_3D_H
+#define SOFTWARE_SOUND_3D_H
+
+#include "SoftwareSound.h"
+#include "ISound3D.h"
+
+class SoftwareSound3D : public SoftwareSound, public ISound3D
+{
+    core::vector3df position;
+    f32 maxVolumePoint;
+
+public:
+    SoftwareSound3D(SoftwareSoundSystem *soundSystem);
+
+    void SetPosition(core::vector3df pos) override;
+    void SetVelocity(core::vector3df vel) override; // no doppler
+    void SetMaxVolumePoint(f32 proximity) override;
+
+    bool Is3D() const override { return true; }
+    void GetChannelGains(f32 gain, f32 &left, f32 &right) override;
+};
+
+#endif
@@ -0,0 +1,293 @@
+
+#include "SoftwareSoundSystem.h"
+#include "SoftwareSound2D.h"
+#include "SoftwareSound3D.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+static void write_u32(FILE *fp, u32 value)
+{
+    u8 bytes[4] = {(u8)value, (u8)(value >> 8), (u8)(value >> 16),
+                   (u8)(value >> 24)};
+    fwrite(bytes, 1, 4, fp);
+}
+
+static void write_u16(FILE *fp, u16 value)
+{
+    u8 bytes[2] = {(u8)value, (u8)(value >> 8)};
+    fwrite(bytes, 1, 2, fp);
+}
+
+// Sizes are filled in when the file is closed.
+static void write_wav_header(FILE *fp, u32 dataBytes)
+{
+    fwrite("RIFF", 1, 4, fp);
+    write_u32(fp, 36 + dataBytes);
+    fwrite("WAVEfmt ", 1, 8, fp);
+    write_u32(fp, 16);
+    write_u16(fp, 1); // PCM
+    write_u16(fp, 2);
+    write_u32(fp, SoftwareSoundSystem::OUTPUT_RATE);
+    write_u32(fp, SoftwareSoundSystem::OUTPUT_RATE * 4);
+    write_u16(fp, 4);
+    write_u16(fp, 16);
+    fwrite("data", 1, 4, fp);
+    write_u32(fp, dataBytes);
+}
+
+SoftwareSoundSystem::SoftwareSoundSystem(const io::path &wavFileName)
+{
+    listenerRight = core::vector3df(1, 0, 0);
+
+    globalVolume = 1.f;
+    globalVolume2D = 1.f;
+    globalVolume3D = 1.f;
+
+    pendingFrames = 0.0;
+
+    wavFile = nullptr;
+    wavBytes = 0;
+
+    if (wavFileName.size())
+    {
+        wavFile = fopen(wavFileName.c_str(), "wb");
+
+        if (wavFile)
+            write_wav_header(wavFile, 0);
+        else
+            WARN << "Could not open " << wavFileName << " to write sound to";
+    }
+
+    memset(&stats, 0, sizeof(stats));
+
+    NOTE << "Mixing sound in software ("
+         << (wavFile ? wavFileName.c_str() : "no output") << ")";
+}
+
+SoftwareSoundSystem::~SoftwareSoundSystem()
+{
+    if (wavFile)
+    {
+        fseek(wavFile, 0, SEEK_SET);
+        write_wav_header(wavFile, wavBytes);
+        fclose(wavFile);
+    }
+}
+
+void SoftwareSoundSystem::Register(SoftwareSound *sound)
+{
+    sounds.Insert(sound);
+}
+
+void SoftwareSoundSystem::Unregister(SoftwareSound *sound)
+{
+    sounds.SwapRemove(sound);
+}
+
+bool SoftwareSoundSystem::GetSamples(const core::stringc &fileName,
+                                     const s16 **samples, u32 *frameCount,
+                                     u32 *channels, u32 *sampleRate,
+                                     DecodedSoundPtr *decoded)
+{
+    auto it = loaded.find(fileName);
+
+    if (it == loaded.end())
+    {
+        Samples entry;
+
+        if (const SoundArchive::Sound *archived = FindArchived(fileName))
+        {
+            entry.samples = archived->samples;
+            entry.frameCount = archived->GetFrameCount();
+            entry.channels = archived->channels;
+            entry.sampleRate = archived->sampleRate;
+        }
+        else
+        {
+            auto start = std::chrono::steady_clock::now();
+            entry.decoded = soundBank.Get(fileName);
+            auto end = std::chrono::steady_clock::now();
+
+            stats.decodeMs +=
+                std::chrono::duration<f64, std::milli>(end - start).count();
+
+            if (!entry.decoded || entry.decoded->samples.empty())
+                return false;
+
+            entry.samples = &entry.decoded->samples[0];
+            entry.frameCount = entry.decoded->GetFrameCount();
+            entry.channels = entry.decoded->channels;
+            entry.sampleRate = entry.decoded->sampleRate;
+        }
+
+        it = loaded.insert(std::make_pair(fileName, entry)).first;
+    }
+
+    const Samples &entry = it->second;
+    *samples = entry.samples;
+    *frameCount = entry.frameCount;
+    *channels = entry.channels;
+    *sampleRate = entry.sampleRate;
+    *decoded = entry.decoded;
+    return true;
+}
+
+void SoftwareSoundSystem::Mix(u32 frames)
+{
+    PROFILE_ZONE("SoftwareSoundSystem::Mix");
+
+    auto start = std::chrono::steady_clock::now();
+
+    mixBuffer.assign(frames * 2, 0.f);
+
+    struct Voice
+    {
+        SoftwareSound *sound;
+        f32 left;
+        f32 right;
+        f32 gain;
+    };
+
+    std::vector<Voice> voices;
+    voices.reserve(sounds.size());
+
+    for (SoftwareSound *sound : sounds)
+    {
+        if (!sound->IsActive() || sound->IsPaused())
+            continue;
+
+        f32 gain = sound->GetVolume() * globalVolume *
+                   (sound->Is3D() ? globalVolume3D : globalVolume2D);
+
+        Voice voice;
+        voice.sound = sound;
+        sound->GetChannelGains(gain, voice.left, voice.right);
+        voice.gain = core::max_(voice.left, voice.right);
+        voices.push_back(voice);
+    }
+
+    // Most important first, then the loudest.
+    std::sort(voices.begin(), voices.end(),
+              [](const Voice &a, const Voice &b)
+              {
+                  if (a.sound->GetPriority() != b.sound->GetPriority())
+                      return a.sound->GetPriority() > b.sound->GetPriority();
+
+                  return a.gain > b.gain;
+              });
+
+    u32 mixed = 0;
+
+    for (auto &voice : voices)
+    {
+        if (mixed < MAX_VOICES && voice.gain > 0.001f)
+        {
+            voice.sound->Mix(&mixBuffer[0], frames, OUTPUT_RATE, voice.left,
+                             voice.right);
+            mixed++;
+        }
+        else
+            voice.sound->Skip(frames, OUTPUT_RATE);
+    }
+
+    outputBuffer.resize(frames * 2);
+
+    for (u32 i = 0; i < frames * 2; i++)
+        outputBuffer[i] = (s16)core::clamp(mixBuffer[i], -32768.f, 32767.f);
+
+    if (wavFile)
+        wavBytes += fwrite(&outputBuffer[0], sizeof(s16), frames * 2,
+                           wavFile) * sizeof(s16);
+
+    auto end = std::chrono::steady_clock::now();
+
+    stats.mixMs += std::chrono::duration<f64, std::milli>(end - start).count();
+    stats.framesMixed += frames;
+    stats.voices = mixed;
+    stats.peakVoices = core::max_(stats.peakVoices, mixed);
+    stats.activeSounds = voices.size();
+    stats.peakActiveSounds =
+        core::max_(stats.peakActiveSounds, (u32)voices.size());
+}
+
+void SoftwareSoundSystem::Update(f32 dt)
+{
+    SoundSystem::Update(dt);
+
+    // Preloaded sounds are fetched from the bank when first played, nothing
+    // to upload.
+    soundBank.TakeNewlyLoaded();
+
+    if (IsPaused())
+        return;
+
+    // Whole frames only, the remainder carries over.
+    pendingFrames += dt * OUTPUT_RATE;
+    u32 frames = (u32)pendingFrames;
+    pendingFrames -= frames;
+
+    if (frames)
+        Mix(frames);
+}
+
+void SoftwareSoundSystem::PreloadSound(const core::stringc &soundFile)
+{
+    const s16 *samples;
+    u32 frameCount, channels, sampleRate;
+    DecodedSoundPtr decoded;
+
+    if (!GetSamples(soundFile, &samples, &frameCount, &channels, &sampleRate,
+                    &decoded))
+        WARN << "Could not load (" << soundFile.c_str() << ")";
+}
+
+void SoftwareSoundSystem::SetListenerPosition(core::vector3df pos)
+{
+    listenerPosition = pos;
+}
+
+void SoftwareSoundSystem::SetListenerOrientation(core::vector3df lookVec,
+                                                 core::vector3df upVec)
+{
+    // Irrlicht is left handed.
+    listenerRight = upVec.crossProduct(lookVec);
+
+    if (!listenerRight.equals(core::vector3df(0, 0, 0)))
+        listenerRight.normalize();
+}
+
+void SoftwareSoundSystem::SetListenerVelocity(core::vector3df vel)
+{
+}
+
+ISound2D *SoftwareSoundSystem::CreateSound2D()
+{
+    return new SoftwareSound2D(this);
+}
+
+ISound3D *SoftwareSoundSystem::CreateSound3D()
+{
+    return new SoftwareSound3D(this);
+}
+
+void SoftwareSoundSystem::SetGlobalVolume(f32 volume)
+{
+    globalVolume = volume;
+}
+
+void SoftwareSoundSystem::SetGlobalVolume2D(f32 volume)
+{
+    globalVolume2D = volume;
+}
+
+void SoftwareSoundSystem::SetGlobalVolume3D(f32 volume)
+{
+    globalVolume3D = volume;
+}
+
+void SoftwareSoundSystem::StopAllSounds()
+{
+    for (SoftwareSound *sound : sounds)
+        sound->Stop();
+}
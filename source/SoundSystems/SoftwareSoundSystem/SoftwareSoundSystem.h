@@ -0,0 +1,113 @@
+
+#ifndef SOFTWARE_SOUND_SYSTEM_H
+#define SOFTWARE_SOUND_SYSTEM_H
+
+#include "SoundSystem.h"
+#include <cstdio>
+#include <map>
+#include <vector>
+
+class SoftwareSound;
+
+// Timings since the sound system was created.
+struct SoftwareSoundStats
+{
+    f64 decodeMs; // decoding on the calling thread, not by preload workers
+    f64 mixMs;
+    u32 framesMixed;
+
+    // Sounds mixed in the last update, and the most in any update.
+    u32 voices;
+    u32 peakVoices;
+
+    // Played and not finished, mixed or not.
+    u32 activeSounds;
+    u32 peakActiveSounds;
+};
+
+// Needs no audio device. Mixes everything in software, once per update, at a
+// fixed rate to 16 bit stereo, then either throws it away or writes it to a
+// WAV file. Used to measure the cost of audio reproducibly, on machines
+// without sound, and for headless runs.
+// Like OpenALSoundSystem, only so many sounds are mixed at once (the most
+// important and loudest) and the rest carry on silently.
+class SoftwareSoundSystem : public SoundSystem
+{
+    IndexedSet<SoftwareSound *> sounds;
+
+    struct Samples
+    {
+        const s16 *samples;
+        u32 frameCount;
+        u32 channels;
+        u32 sampleRate;
+        DecodedSoundPtr decoded;
+    };
+
+    std::map<core::stringc, Samples> loaded;
+
+    core::vector3df listenerPosition;
+    core::vector3df listenerRight;
+
+    f32 globalVolume;
+    f32 globalVolume2D;
+    f32 globalVolume3D;
+
+    // Fractions of a frame carried over between updates.
+    f64 pendingFrames;
+
+    std::vector<f32> mixBuffer;
+    std::vector<s16> outputBuffer;
+
+    FILE *wavFile;
+    u32 wavBytes;
+
+    SoftwareSoundStats stats;
+
+    void Mix(u32 frames);
+
+public:
+    static const u32 OUTPUT_RATE = 44100;
+    static const u32 MAX_VOICES = 32;
+
+    // Writes to wavFileName if given, otherwise the mix goes nowhere.
+    SoftwareSoundSystem(const io::path &wavFileName = "");
+    ~SoftwareSoundSystem();
+
+    // Used by SoftwareSound
+    void Register(SoftwareSound *sound);
+    void Unregister(SoftwareSound *sound);
+
+    bool GetSamples(const core::stringc &fileName, const s16 **samples,
+                    u32 *frameCount, u32 *channels, u32 *sampleRate,
+                    DecodedSoundPtr *decoded);
+
+    const core::vector3df &GetListenerPosition() const
+    {
+        return listenerPosition;
+    }
+
+    const core::vector3df &GetListenerRight() const { return listenerRight; }
+
+    const SoftwareSoundStats &GetStats() const { return stats; }
+
+    void Update(f32 dt) override;
+
+    void PreloadSound(const core::stringc &soundFile) override;
+
+    void SetListenerPosition(core::vector3df pos) override;
+    void SetListenerOrientation(core::vector3df lookVec,
+                                core::vector3df upVec) override;
+    void SetListenerVelocity(core::vector3df vel) override;
+
+    ISound2D *CreateSound2D() override;
+    ISound3D *CreateSound3D() override;
+
+    void SetGlobalVolume(f32 volume) override;
+    void SetGlobalVolume2D(f32 volume) override;
+    void SetGlobalVolume3D(f32 volume) override;
+
+    void StopAllSounds() override;
+};
+
+#endif
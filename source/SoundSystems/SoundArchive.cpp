@@ -0,0 +1,224 @@
+
+#include "SoundArchive.h"
+#include "SoundBank.h" // DecodedSound
+#include <cstdio>
+#include <cstring>
+
+#if defined(_IRR_WINDOWS_API_)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const c8 ARCHIVE_MAGIC[4] = {'L', 'S', 'N', 'D'};
+static const u32 ARCHIVE_VERSION = 1;
+
+SoundArchive::SoundArchive()
+{
+    data = nullptr;
+    size = 0;
+
+#if defined(_IRR_WINDOWS_API_)
+    file = INVALID_HANDLE_VALUE;
+    mapping = nullptr;
+#endif
+}
+
+SoundArchive::~SoundArchive()
+{
+    Close();
+}
+
+void SoundArchive::Close()
+{
+    sounds.clear();
+
+#if defined(_IRR_WINDOWS_API_)
+    if (data)
+        UnmapViewOfFile(data);
+
+    if (mapping)
+        CloseHandle(mapping);
+
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+
+    file = INVALID_HANDLE_VALUE;
+    mapping = nullptr;
+#else
+    if (data)
+        munmap((void *)data, size);
+#endif
+
+    data = nullptr;
+    size = 0;
+}
+
+io::path SoundArchive::GetPathForManifest(const io::path &manifestFile)
+{
+    return os::path::splitext(manifestFile)[0] + ".pak";
+}
+
+bool SoundArchive::Open(const io::path &archiveFile)
+{
+    Close();
+
+#if defined(_IRR_WINDOWS_API_)
+    file = CreateFileA(archiveFile.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                       nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+
+    if (GetFileSizeEx(file, &fileSize))
+    {
+        size = fileSize.QuadPart;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0,
+                                     nullptr);
+    }
+
+    if (mapping)
+        data = (const u8 *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+    int fd = open(archiveFile.c_str(), O_RDONLY);
+
+    if (fd == -1)
+        return false;
+
+    struct stat st;
+
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        size = st.st_size;
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapped != MAP_FAILED)
+            data = (const u8 *)mapped;
+    }
+
+    // The mapping stays valid without it.
+    close(fd);
+#endif
+
+    if (!data)
+    {
+        WARN << "Could not map sound archive " << archiveFile;
+        Close();
+        return false;
+    }
+
+    const auto *header = (const Header *)data;
+
+    if (size < sizeof(Header) ||
+        memcmp(header->magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 ||
+        header->version != ARCHIVE_VERSION ||
+        size < sizeof(Header) + (u64)header->count * sizeof(IndexEntry))
+    {
+        WARN << "Not a valid sound archive " << archiveFile;
+        Close();
+        return false;
+    }
+
+    io::path dir = os::path::dirname(archiveFile);
+    const auto *index = (const IndexEntry *)(data + sizeof(Header));
+
+    for (u32 i = 0; i < header->count; i++)
+    {
+        const IndexEntry &entry = index[i];
+
+        if (!entry.channels || entry.name[sizeof(entry.name) - 1] != 0 ||
+            entry.offset + (u64)entry.sampleCount * sizeof(s16) > size)
+        {
+            WARN << "Bad entry " << i << " in sound archive " << archiveFile;
+            continue;
+        }
+
+        Sound sound;
+        sound.samples = (const s16 *)(data + entry.offset);
+        sound.sampleCount = entry.sampleCount;
+        sound.channels = entry.channels;
+        sound.sampleRate = entry.sampleRate;
+
+        // Named as SoundBank names manifest sounds, which is how they are
+        // looked up.
+        sounds[SoundBank::JoinPath(dir, entry.name)] = sound;
+    }
+
+    NOTE << "Opened sound archive " << archiveFile << " (" << sounds.size()
+         << " sounds)";
+
+    return true;
+}
+
+const SoundArchive::Sound *SoundArchive::Find(
+    const core::stringc &fileName) const
+{
+    auto it = sounds.find(fileName);
+    return it != sounds.end() ? &it->second : nullptr;
+}
+
+bool SoundArchive::Write(const io::path &archiveFile,
+                         const std::vector<core::stringc> &names,
+                         const std::vector<DecodedSound> &decoded)
+{
+    ASSERT(names.size() == decoded.size());
+
+    FILE *fp = fopen(archiveFile.c_str(), "wb");
+
+    if (!fp)
+        return false;
+
+    Header header;
+    memcpy(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    header.version = ARCHIVE_VERSION;
+    header.count = names.size();
+    header.reserved = 0;
+
+    std::vector<IndexEntry> index(names.size());
+    u64 offset = sizeof(Header) + index.size() * sizeof(IndexEntry);
+
+    for (u32 i = 0; i < names.size(); i++)
+    {
+        IndexEntry &entry = index[i];
+        memset(&entry, 0, sizeof(entry));
+
+        if (names[i].size() >= sizeof(entry.name))
+        {
+            WARN << "Sound name too long for archive: " << names[i];
+            fclose(fp);
+            return false;
+        }
+
+        strcpy(entry.name, names[i].c_str());
+        entry.sampleRate = decoded[i].sampleRate;
+        entry.offset = offset;
+        entry.sampleCount = decoded[i].samples.size();
+        entry.channels = decoded[i].channels;
+
+        offset += decoded[i].GetByteCount();
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+
+    if (index.size())
+        ok = ok && fwrite(&index[0], sizeof(IndexEntry), index.size(), fp) ==
+                       index.size();
+
+    for (auto &sound : decoded)
+    {
+        if (sound.samples.size())
+            ok = ok && fwrite(&sound.samples[0], sizeof(s16),
+                              sound.samples.size(),
+                              fp) == sound.samples.size();
+    }
+
+    if (fclose(fp) != 0)
+        ok = false;
+
+    return ok;
+}
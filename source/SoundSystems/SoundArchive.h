@@ -0,0 +1,84 @@
+#ifndef SOUND_ARCHIVE_H
+#define SOUND_ARCHIVE_H
+
+#include "litha_internal.h"
+#include <map>
+#include <vector>
+
+struct DecodedSound;
+
+// Many short sounds, already decoded to 16 bit PCM, packed into one file.
+// Written ahead of time by litha-soundpack from a sound manifest, so that
+// loading them is a copy rather than a Vorbis decode. The file is memory
+// mapped, and its index read once when opened.
+// Layout (little endian): a header, then an index entry for each sound, then
+// the samples of each sound in turn.
+class SoundArchive
+{
+public:
+    struct Sound
+    {
+        const s16 *samples; // interleaved, in the mapped file
+        u32 sampleCount;    // of all channels
+        u32 channels;
+        u32 sampleRate;
+
+        u32 GetFrameCount() const { return sampleCount / channels; }
+        u32 GetByteCount() const { return sampleCount * sizeof(s16); }
+    };
+
+private:
+    struct Header
+    {
+        c8 magic[4];
+        u32 version;
+        u32 count;
+        u32 reserved;
+    };
+
+    struct IndexEntry
+    {
+        c8 name[108]; // relative to the archive, null terminated
+        u32 sampleRate;
+        u64 offset; // bytes, from the start of the file
+        u32 sampleCount;
+        u16 channels;
+        u16 reserved;
+    };
+
+    const u8 *data;
+    u64 size;
+
+#if defined(_IRR_WINDOWS_API_)
+    void *file;
+    void *mapping;
+#endif
+
+    // By full path, as formed from the archive's directory.
+    std::map<core::stringc, Sound> sounds;
+
+    void Close();
+
+public:
+    SoundArchive();
+    ~SoundArchive();
+
+    // The archive packed from a sound manifest, next to it.
+    // e.g. sfx/sounds.manifest gives sfx/sounds.pak
+    static io::path GetPathForManifest(const io::path &manifestFile);
+
+    // Map the archive and read its index.
+    bool Open(const io::path &archiveFile);
+
+    // NULL if not in the archive.
+    const Sound *Find(const core::stringc &fileName) const;
+
+    u32 GetSoundCount() const { return sounds.size(); }
+
+    // Write an archive. Names are relative to the archive file.
+    static bool Write(const io::path &archiveFile,
+                      const std::vector<core::stringc> &names,
+                      const std::vector<DecodedSound> &decoded);
+};
+
+#endif
@@ -0,0 +1,292 @@
+
+#include "SoundBank.h"
+#include "stb_vorbis.h"
+
+SoundBank::SoundBank()
+{
+    quit = false;
+    asyncQueued = 0;
+    asyncDone = 0;
+    memoryUsage = 0;
+    streamMinSeconds = 0.f;
+}
+
+SoundBank::~SoundBank()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+        queue.clear();
+    }
+
+    queueChanged.notify_all();
+
+    for (auto &worker : workers)
+        worker.join();
+}
+
+core::stringc SoundBank::JoinPath(const io::path &dir,
+                                const core::stringc &name)
+{
+    return core::stringc(dir) + "/" + name;
+}
+
+SoundBank::E_DECODE_RESULT SoundBank::Decode(const core::stringc &fileName,
+                                             DecodedSound &sound,
+                                             f32 maxSeconds)
+{
+    PROFILE_ZONE("SoundBank::Decode");
+
+    if (os::path::getext(fileName) != "ogg")
+        return EDR_FAILED;
+
+    int error;
+    stb_vorbis *v =
+        stb_vorbis_open_filename((char *)fileName.c_str(), &error, nullptr);
+
+    if (!v)
+    {
+        WARN << "Ogg loading failed: " << fileName;
+        return EDR_FAILED;
+    }
+
+    stb_vorbis_info info = stb_vorbis_get_info(v);
+
+    if (info.channels != 1 && info.channels != 2)
+    {
+        WARN << "Ogg file has invalid number of channels: (" << info.channels
+             << ") - " << fileName;
+        stb_vorbis_close(v);
+        return EDR_FAILED;
+    }
+
+    sound.channels = info.channels;
+    sound.sampleRate = info.sample_rate;
+
+    u32 frames = stb_vorbis_stream_length_in_samples(v);
+
+    if (maxSeconds > 0.f && frames > maxSeconds * info.sample_rate)
+    {
+        stb_vorbis_close(v);
+        return EDR_TOO_LONG;
+    }
+
+    sound.samples.resize(frames * info.channels);
+
+    u32 len = 0;
+
+    while (len * info.channels < sound.samples.size())
+    {
+        int got = stb_vorbis_get_samples_short_interleaved(
+            v, info.channels, &sound.samples[len * info.channels],
+            sound.samples.size() - len * info.channels);
+
+        if (got <= 0)
+            break;
+
+        len += got;
+    }
+
+    stb_vorbis_close(v);
+
+    if (!len)
+    {
+        WARN << "Ogg loading failed: " << fileName;
+        return EDR_FAILED;
+    }
+
+    sound.samples.resize(len * info.channels);
+    return EDR_DECODED;
+}
+
+void SoundBank::DecodeEntry(const core::stringc &fileName,
+                            std::unique_lock<std::mutex> &lock)
+{
+    entries[fileName].state = ESS_DECODING;
+    f32 maxSeconds = streamMinSeconds;
+
+    lock.unlock();
+
+    auto *sound = new DecodedSound();
+    E_DECODE_RESULT result = Decode(fileName, *sound, maxSeconds);
+
+    lock.lock();
+
+    Entry &entry = entries[fileName];
+
+    if (result == EDR_DECODED)
+    {
+        entry.state = ESS_LOADED;
+        entry.sound = DecodedSoundPtr(sound);
+        memoryUsage += sound->GetByteCount();
+    }
+    else
+    {
+        entry.state = result == EDR_TOO_LONG ? ESS_STREAMED : ESS_FAILED;
+        delete sound;
+    }
+
+    decoded.notify_all();
+}
+
+void SoundBank::Work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+        queueChanged.wait(lock, [this] { return quit || queue.size(); });
+
+        if (quit)
+            return;
+
+        core::stringc fileName = queue.front();
+        queue.pop_front();
+
+        DecodeEntry(fileName, lock);
+
+        if (entries[fileName].state == ESS_LOADED)
+            newlyLoaded.push_back(fileName);
+
+        asyncDone++;
+    }
+}
+
+void SoundBank::LoadAsync(const core::stringc &fileName)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (entries.count(fileName))
+            return;
+
+        entries[fileName].state = ESS_QUEUED;
+        queue.push_back(fileName);
+
+        if (asyncDone == asyncQueued)
+        {
+            asyncQueued = 0;
+            asyncDone = 0;
+        }
+
+        asyncQueued++;
+
+        // Started the first time they are needed.
+        if (workers.empty())
+        {
+            u32 threadCount =
+                core::max_<u32>(std::thread::hardware_concurrency(), 2) - 1;
+
+            for (u32 i = 0; i < threadCount; i++)
+                workers.emplace_back(&SoundBank::Work, this);
+        }
+    }
+
+    queueChanged.notify_one();
+}
+
+void SoundBank::SetStreamMinSeconds(f32 seconds)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    streamMinSeconds = seconds;
+}
+
+bool SoundBank::IsStreamed(const core::stringc &fileName)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    return Resolve(fileName, lock).state == ESS_STREAMED;
+}
+
+bool SoundBank::IsLoading(const core::stringc &fileName)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = entries.find(fileName);
+
+    return it != entries.end() && (it->second.state == ESS_QUEUED ||
+                                   it->second.state == ESS_DECODING);
+}
+
+SoundBank::Entry &SoundBank::Resolve(const core::stringc &fileName,
+                                     std::unique_lock<std::mutex> &lock)
+{
+    auto it = entries.find(fileName);
+
+    if (it == entries.end())
+    {
+        DecodeEntry(fileName, lock);
+    }
+    else if (it->second.state == ESS_QUEUED)
+    {
+        // Quicker to decode it here than wait for a worker to get to it.
+        for (u32 i = 0; i < queue.size(); i++)
+        {
+            if (queue[i] == fileName)
+            {
+                queue.erase(queue.begin() + i);
+                break;
+            }
+        }
+
+        DecodeEntry(fileName, lock);
+        asyncDone++;
+    }
+    else if (it->second.state == ESS_DECODING)
+    {
+        decoded.wait(lock, [&] {
+            return entries[fileName].state != ESS_DECODING;
+        });
+    }
+
+    return entries[fileName];
+}
+
+DecodedSoundPtr SoundBank::Get(const core::stringc &fileName)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // Released is still known about, but must be decoded again.
+    if (Resolve(fileName, lock).state == ESS_RELEASED)
+        DecodeEntry(fileName, lock);
+
+    return entries[fileName].sound;
+}
+
+void SoundBank::Release(const core::stringc &fileName)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = entries.find(fileName);
+
+    if (it == entries.end() || it->second.state != ESS_LOADED)
+        return;
+
+    memoryUsage -= it->second.sound->GetByteCount();
+    it->second.state = ESS_RELEASED;
+    it->second.sound.reset();
+}
+
+std::vector<core::stringc> SoundBank::TakeNewlyLoaded()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<core::stringc> result;
+    result.swap(newlyLoaded);
+    return result;
+}
+
+f32 SoundBank::GetProgress()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (asyncDone == asyncQueued)
+        return 1.f;
+
+    return (f32)asyncDone / (f32)asyncQueued;
+}
+
+u32 SoundBank::GetMemoryUsage()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return memoryUsage;
+}
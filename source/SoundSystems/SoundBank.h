@@ -0,0 +1,137 @@
+
+#ifndef SOUND_BANK_H
+#define SOUND_BANK_H
+
+#include "litha_internal.h"
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A whole sound file decoded to 16 bit PCM.
+struct DecodedSound
+{
+    std::vector<s16> samples; // interleaved
+    u32 channels;
+    u32 sampleRate;
+
+    u32 GetFrameCount() const { return samples.size() / channels; }
+    u32 GetByteCount() const { return samples.size() * sizeof(s16); }
+};
+
+typedef std::shared_ptr<const DecodedSound> DecodedSoundPtr;
+
+// Decoded sounds, shared by file name.
+// Files can be queued to be decoded on worker threads (LoadAsync) ahead of
+// being played, so that playing them for the first time doesn't stall.
+// All methods are thread safe.
+class SoundBank
+{
+    enum E_SOUND_STATE
+    {
+        ESS_QUEUED = 0,
+        ESS_DECODING,
+        ESS_LOADED,
+        ESS_FAILED,
+        ESS_STREAMED, // too long, not decoded
+        ESS_RELEASED  // was loaded, kept so it is known not to be streamed
+    };
+
+    struct Entry
+    {
+        E_SOUND_STATE state;
+        DecodedSoundPtr sound;
+    };
+
+    std::map<core::stringc, Entry> entries;
+    std::deque<core::stringc> queue;
+
+    // Loaded by workers since the last TakeNewlyLoaded.
+    std::vector<core::stringc> newlyLoaded;
+
+    std::mutex mutex;
+    std::condition_variable queueChanged;
+    std::condition_variable decoded;
+
+    std::vector<std::thread> workers;
+    bool quit;
+
+    // Since the queue was last empty, for progress.
+    u32 asyncQueued;
+    u32 asyncDone;
+
+    u32 memoryUsage;
+
+    f32 streamMinSeconds;
+
+    // Decode a queued file, with the lock held on entry and exit.
+    void DecodeEntry(const core::stringc &fileName,
+                     std::unique_lock<std::mutex> &lock);
+
+    // Decode the file now if it hasn't been, or wait for the worker that is.
+    Entry &Resolve(const core::stringc &fileName,
+                   std::unique_lock<std::mutex> &lock);
+    void Work();
+
+public:
+    enum E_DECODE_RESULT
+    {
+        EDR_FAILED = 0,
+        EDR_DECODED,
+        EDR_TOO_LONG
+    };
+
+    SoundBank();
+    ~SoundBank();
+
+    // The file name a sound in dir is known by.
+    // Joined with "/" as paths::get_sfx does, not the OS separator, so that
+    // it matches the name the sound is later played with.
+    static core::stringc JoinPath(const io::path &dir,
+                                  const core::stringc &name);
+
+    // Decode a file. Only Ogg Vorbis is supported.
+    // If maxSeconds is given, longer files are left undecoded. (the length
+    // is known as soon as the file is open)
+    static E_DECODE_RESULT Decode(const core::stringc &fileName,
+                                  DecodedSound &sound, f32 maxSeconds = 0.f);
+
+    // Files longer than this are not decoded, but noted as to be streamed.
+    // Zero (the default) decodes everything. Set before loading anything.
+    void SetStreamMinSeconds(f32 seconds);
+
+    // Whether the file is too long to decode. Opens it now if it has not
+    // been yet, decoding it if it is short so that Get needn't open it again.
+    bool IsStreamed(const core::stringc &fileName);
+
+    // Queue a file to be decoded on a worker thread.
+    // Does nothing if it has already been decoded or queued.
+    void LoadAsync(const core::stringc &fileName);
+
+    // Queued or being decoded?
+    bool IsLoading(const core::stringc &fileName);
+
+    // Returns the decoded file, decoding it now if needed (or waiting for a
+    // worker that is part way through). NULL if it could not be decoded, or
+    // is to be streamed.
+    DecodedSoundPtr Get(const core::stringc &fileName);
+
+    // Forget a decoded file. The memory is freed once anything still using
+    // it is done.
+    void Release(const core::stringc &fileName);
+
+    // Files loaded by worker threads since this was last called.
+    std::vector<core::stringc> TakeNewlyLoaded();
+
+    // Fraction of the files queued with LoadAsync that have been decoded.
+    // 1.0 when none are waiting.
+    f32 GetProgress();
+
+    // Bytes of decoded sound held.
+    u32 GetMemoryUsage();
+};
+
+#endif
@@ -2,7 +2,122 @@
 #include "SoundSystem.h"
 #include "SoundQueue.h"
 
+SoundSystem::~SoundSystem()
+{
+    for (auto &elem : soundArchives)
+        delete elem.second;
+}
+
+std::vector<core::stringc> SoundSystem::ReadManifest(
+    const io::path &manifestFile)
+{
+    std::vector<core::stringc> names;
+
+    for (auto &line : file::get_lines(manifestFile))
+    {
+        core::stringc trimmed = str::trim(line);
+
+        if (trimmed.size() && trimmed[0] != '#')
+            names.push_back(trimmed);
+    }
+
+    return names;
+}
+
+const SoundArchive::Sound *SoundSystem::FindArchived(
+    const core::stringc &fileName)
+{
+    for (auto &elem : soundArchives)
+    {
+        if (const SoundArchive::Sound *sound = elem.second->Find(fileName))
+            return sound;
+    }
+
+    return nullptr;
+}
+
 ISoundQueue *SoundSystem::CreateSoundQueue()
 {
     return new SoundQueue(this);
 }
+
+void SoundSystem::WatchSound(ISound *sound, SoundQueue *queue)
+{
+    queuedSounds[sound] = queue;
+}
+
+void SoundSystem::UnwatchSound(ISound *sound)
+{
+    queuedSounds.erase(sound);
+}
+
+void SoundSystem::NotifyFinished(ISound *sound)
+{
+    auto it = queuedSounds.find(sound);
+
+    if (it != queuedSounds.end())
+        it->second->OnSoundFinished(sound);
+}
+
+u32 SoundSystem::PreloadSoundBank(const io::path &manifestFile)
+{
+    std::vector<core::stringc> names = ReadManifest(manifestFile);
+
+    if (!names.size())
+    {
+        WARN << "Could not read sound manifest " << manifestFile;
+        return 0;
+    }
+
+    // Packed by litha-soundpack? Those sounds needn't be decoded.
+    // Only opened the first time, the same manifest may be preloaded again.
+    io::path archiveFile = SoundArchive::GetPathForManifest(manifestFile);
+
+    if (!soundArchives.count(archiveFile) && os::path::exists(archiveFile))
+    {
+        auto *archive = new SoundArchive();
+
+        if (archive->Open(archiveFile))
+            soundArchives[archiveFile] = archive;
+        else
+            delete archive;
+    }
+
+    // Sound files are relative to the manifest.
+    io::path dir = os::path::dirname(manifestFile);
+    u32 count = 0;
+    u32 archived = 0;
+
+    for (auto &name : names)
+    {
+        core::stringc fileName = SoundBank::JoinPath(dir, name);
+
+        // Just a copy, so done now.
+        if (FindArchived(fileName))
+        {
+            PreloadSound(fileName);
+            archived++;
+            continue;
+        }
+
+        // Those long enough to be streamed are only opened, by the worker,
+        // to find that out.
+        soundBank.LoadAsync(fileName);
+        count++;
+    }
+
+    NOTE << "Preloading " << count << " sounds from " << manifestFile << " ("
+         << archived << " already decoded in an archive)";
+
+    return count + archived;
+}
+
+f32 SoundSystem::GetPreloadProgress()
+{
+    return soundBank.GetProgress();
+}
+
+u32 SoundSystem::GetSoundMemoryUsage()
+{
+    return soundBank.GetMemoryUsage();
+}
@@ -1,10 +1,59 @@
 
+#ifndef SOUND_SYSTEM_H
+#define SOUND_SYSTEM_H
+
 #include "ISoundSystem.h"
+#include "IUpdatable.h"
+#include "SoundArchive.h"
+#include "SoundBank.h"
+#include <unordered_map>
+
+class SoundQueue;
 
-class SoundSystem : public ISoundSystem
+// Updated by the logic task.
+class SoundSystem : public ISoundSystem, public IUpdatable
 {
+protected:
+    // Decoded sound files
+    SoundBank soundBank;
+
+    // Pre-decoded sounds, opened by PreloadSoundBank.
+    std::map<io::path, SoundArchive *> soundArchives;
+
+    // The queue each queued sound belongs to, to tell it when the sound ends.
+    std::unordered_map<ISound *, SoundQueue *> queuedSounds;
+
 public:
+    ~SoundSystem();
+
+    // Sound file names in a manifest, relative to it.
+    // Each line is a file name. Blank lines and lines starting with # are
+    // skipped.
+    static std::vector<core::stringc>
+    ReadManifest(const io::path &manifestFile);
+
+    // A sound from an archive, or NULL if it must be decoded from its file.
+    const SoundArchive::Sound *FindArchived(const core::stringc &fileName);
+
     // Sound queue makes use of ISoundSystem and does not need to know about the
     // lower level sound API.
     ISoundQueue *CreateSoundQueue() override;
+
+    // Used by SoundQueue, which then only does anything when one of its
+    // sounds finishes rather than checking them all every update.
+    void WatchSound(ISound *sound, SoundQueue *queue);
+    void UnwatchSound(ISound *sound);
+
+    // Called by implementations when a playing sound reaches its end, or is
+    // stopped early.
+    void NotifyFinished(ISound *sound);
+
+    u32 PreloadSoundBank(const io::path &manifestFile) override;
+    f32 GetPreloadProgress() override;
+    u32 GetSoundMemoryUsage() override;
+
+    // Files that are not decoded whole. See SoundBank::SetStreamMinSeconds.
+    virtual bool IsStreamed(const core::stringc &fileName) { return false; }
 };
+
+#endif
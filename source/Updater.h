@@ -5,23 +5,85 @@
 #include "IUpdater.h"
 #include "IUpdatable.h"
 #include <vector>
+#include <unordered_map>
+#include <mutex>
 
 struct UpdatableInfo
 {
+    // NULL once removed, until the slot is compacted away.
     IUpdatable *ptr;
     bool keptRef;
 };
 
+// Updatables are stored in a slot array in the order they were added, with a
+// pointer->slot map for O(1) add and remove.
+// Removing just clears the slot. Cleared slots are compacted out (keeping the
+// order) once no sweep over the slots is in progress, so updatables can be
+// added or removed freely from within an Update.
 class Updater : public IUpdater
 {
     std::vector<UpdatableInfo> updatables;
+    std::unordered_map<IUpdatable *, u32> slotIndices;
+    u32 removedCount;
+    // How many sweeps over the updatables are currently in progress.
+    // (Update can recurse into this updater, e.g. RemoveAllUpdatables)
+    u32 sweepDepth;
+
     f32 virtualTime;
     f32 lastDeltaTime;
     bool updatablesArePaused;
 
+    // Updaters are created and destroyed with every IUpdatable, so recycle
+    // their memory rather than going to the heap each time.
+    // Locked, since nothing stops an IUpdatable being created or dropped
+    // off the main thread.
+    struct FreeList
+    {
+        std::mutex mutex;
+        std::vector<void *> blocks;
+
+        ~FreeList()
+        {
+            for (auto &elem : blocks)
+                ::operator delete(elem);
+        }
+    };
+
+    static FreeList &GetFreeList()
+    {
+        static FreeList freeList;
+        return freeList;
+    }
+
+    void Compact()
+    {
+        if (sweepDepth || !removedCount)
+            return;
+
+        u32 dest = 0;
+
+        for (u32 i = 0; i < updatables.size(); i++)
+        {
+            if (updatables[i].ptr)
+            {
+                if (dest != i)
+                {
+                    updatables[dest] = updatables[i];
+                    slotIndices[updatables[dest].ptr] = dest;
+                }
+                dest++;
+            }
+        }
+
+        updatables.resize(dest);
+        removedCount = 0;
+    }
+
 public:
     Updater()
     {
+        removedCount = 0;
+        sweepDepth = 0;
         updatablesArePaused = false;
         virtualTime = 0.f;
         lastDeltaTime = 0.f;
@@ -29,10 +91,47 @@ public:
 
     ~Updater() { RemoveAllUpdatables(); }
 
+    static void *operator new(size_t size)
+    {
+        if (size != sizeof(Updater))
+            return ::operator new(size);
+
+        FreeList &freeList = GetFreeList();
+        std::lock_guard<std::mutex> lock(freeList.mutex);
+
+        if (freeList.blocks.empty())
+            return ::operator new(size);
+
+        void *ptr = freeList.blocks.back();
+        freeList.blocks.pop_back();
+        return ptr;
+    }
+
+    static void operator delete(void *ptr, size_t size)
+    {
+        if (size != sizeof(Updater))
+        {
+            ::operator delete(ptr);
+            return;
+        }
+
+        FreeList &freeList = GetFreeList();
+        std::lock_guard<std::mutex> lock(freeList.mutex);
+        freeList.blocks.push_back(ptr);
+    }
+
     void InitAllUpdateTimes() override
     {
-        for (auto &elem : updatables)
-            elem.ptr->InitUpdateTime();
+        sweepDepth++;
+
+        for (u32 i = 0; i < updatables.size(); i++)
+        {
+            if (updatables[i].ptr)
+                updatables[i].ptr->InitUpdateTime();
+        }
+
+        sweepDepth--;
+        Compact();
     }
 
     void UpdateAllUpdatables(f32 virtualTime, f32 dt) override
@@ -44,9 +143,18 @@ public:
         lastDeltaTime = dt;
 
         // NOTE: cannot use range-based loop here since elements
-        // can be added or removed during update
+        // can be added or removed during update. Removed slots are just
+        // cleared until the sweep is done, so indices stay valid.
+        sweepDepth++;
+
         for (u32 i = 0; i < updatables.size(); i++)
-            updatables[i].ptr->Update(dt);
+        {
+            if (updatables[i].ptr)
+                updatables[i].ptr->Update(dt);
+        }
+
+        sweepDepth--;
+        Compact();
     }
 
     f32 GetVirtualTime() const override { return virtualTime; }
@@ -59,16 +167,14 @@ public:
             return;
 
         // check not already present
-        for (auto &elem : updatables)
-        {
-            if (elem.ptr == updatable)
-                return;
-        }
+        if (slotIndices.count(updatable))
+            return;
 
         if (keepRef)
             updatable->grab();
 
         UpdatableInfo info = {updatable, keepRef};
+        slotIndices[updatable] = updatables.size();
         updatables.push_back(info);
 
         // maybe pause
@@ -78,33 +184,57 @@ public:
 
     void RemoveUpdatable(IUpdatable *updatable) override
     {
-        for (u32 i = 0; i < updatables.size(); i++)
-        {
-            if (updatables[i].ptr == updatable)
-            {
-                bool keptRef = updatables[i].keptRef;
+        auto it = slotIndices.find(updatable);
 
-                updatables.erase(updatables.begin() + i);
+        if (it == slotIndices.end())
+            return;
 
-                // did we grab it?
-                if (keptRef)
-                    updatable->drop();
+        UpdatableInfo &info = updatables[it->second];
+        bool keptRef = info.keptRef;
 
-                break;
-            }
-        }
+        info.ptr = nullptr;
+        slotIndices.erase(it);
+        removedCount++;
+
+        // did we grab it?
+        if (keptRef)
+            updatable->drop();
+
+        // Outside of a sweep, only compact once enough slots are dead to
+        // keep removal amortised O(1).
+        if (removedCount * 2 > updatables.size())
+            Compact();
     }
 
     void RemoveAllUpdatables() override
     {
-        while (updatables.size())
-            RemoveUpdatable(updatables.front().ptr);
+        // Dropping an updatable may remove (or add) others, the slots don't
+        // move during the sweep so this is safe.
+        sweepDepth++;
+
+        for (u32 i = 0; i < updatables.size(); i++)
+        {
+            if (updatables[i].ptr)
+                RemoveUpdatable(updatables[i].ptr);
+        }
+
+        sweepDepth--;
+        Compact();
     }
 
     void RemoveAllUpdatablesRecursive() override
     {
-        for (size_t i = 0; i < updatables.size(); i++)
-            updatables[i].ptr->GetUpdater().RemoveAllUpdatablesRecursive();
+        sweepDepth++;
+
+        for (u32 i = 0; i < updatables.size(); i++)
+        {
+            if (updatables[i].ptr)
+                updatables[i]
+                    .ptr->GetUpdater()
+                    .RemoveAllUpdatablesRecursive();
+        }
+
+        sweepDepth--;
 
         RemoveAllUpdatables();
     }
@@ -113,16 +243,32 @@ public:
     {
         updatablesArePaused = true;
 
-        for (auto &elem : updatables)
-            elem.ptr->Pause();
+        sweepDepth++;
+
+        for (u32 i = 0; i < updatables.size(); i++)
+        {
+            if (updatables[i].ptr)
+                updatables[i].ptr->Pause();
+        }
+
+        sweepDepth--;
+        Compact();
     }
 
     void ResumeAllUpdatables() override
     {
         updatablesArePaused = false;
 
-        for (auto &elem : updatables)
-            elem.ptr->Resume();
+        sweepDepth++;
+
+        for (u32 i = 0; i < updatables.size(); i++)
+        {
+            if (updatables[i].ptr)
+                updatables[i].ptr->Resume();
+        }
+
+        sweepDepth--;
+        Compact();
     }
 };
 
@@ -6,6 +6,8 @@
 #include "Physics.h"
 #include "InputProfile.h"
 #include "Mesh.h"
+#include "MeshBatcher.h"
+#include "AnimationSystem.h"
 #include "Character.h"
 #include "ThirdPersonCameraController.h"
 #include "ProxyTransformable.h"
@@ -37,6 +39,11 @@ World::World()
 
     physics = new Physics(this);
 
+    scene::ISceneManager *smgr = engine->GetIrrlichtDevice()->getSceneManager();
+    meshBatcher = new MeshBatcher(smgr->getRootSceneNode(), smgr);
+    animationSystem =
+        new AnimationSystem(smgr, engine->GetIrrlichtDevice()->getTimer());
+
     camera = new Camera(
         engine->GetIrrlichtDevice()->getSceneManager()->getActiveCamera());
     AddTransformable(camera);
@@ -68,8 +75,17 @@ World::~World()
     if (skyBoxShader)
         skyBoxShader->drop();
 
+    // Everything goes now.
+    while (kept.size())
+        SetKept(kept[kept.size() - 1], false);
+
     RemoveAllTransformables();
 
+    // After all meshes are gone.
+    meshBatcher->remove();
+    meshBatcher->drop();
+    animationSystem->drop();
+
     physics->drop();
 }
 
@@ -144,7 +160,10 @@ void World::AddTransformable(ITransformable *transformable)
     // Specific types
 
     if (auto *graphic = dynamic_cast<IGraphic *>(transformable))
+    {
         graphics.Insert(graphic);
+        motionTracker.Add(graphic);
+    }
 
     if (auto *character = dynamic_cast<ICharacter *>(transformable))
         characters.Insert(character);
@@ -158,7 +177,8 @@ void World::AddTransformable(ITransformable *transformable)
 
 void World::RemoveTransformable(ITransformable *transformable)
 {
-    if (!transformables.Contains(transformable))
+    if (!transformables.Contains(transformable) &&
+        !kept.Contains(transformable))
     {
         WARN << "Specified transformable was not found.";
         return;
@@ -174,25 +194,32 @@ void World::RemoveTransformable(ITransformable *transformable)
         return;
     }
 
+    // Put back with the others first so it and its children go as usual.
+    if (kept.Contains(transformable))
+        SetKept(transformable, false);
+
     // Ok, transformable doesn't have a parent, so we can remove it right away.
     // Pointer is valid, so now remove specific types.
 
     if (auto *graphic = dynamic_cast<IGraphic *>(transformable))
-        graphics.Remove(graphic);
+    {
+        graphics.SwapRemove(graphic);
+        motionTracker.Remove(graphic);
+    }
 
     if (auto *character = dynamic_cast<ICharacter *>(transformable))
-        characters.Remove(character);
+        characters.SwapRemove(character);
 
     if (auto *sensor = dynamic_cast<ISensor *>(transformable))
-        sensors.Remove(sensor);
+        sensors.SwapRemove(sensor);
 
     if (auto *soundSource = dynamic_cast<ISoundSource *>(transformable))
-        soundSources.Remove(soundSource);
+        soundSources.SwapRemove(soundSource);
 
     // Remove from main transformables list
     // Must erase *then* drop as transformable's destructor might
     // want to call this method.
-    transformables.Remove(transformable);
+    transformables.SwapRemove(transformable);
     transformable->drop();
 }
 
@@ -207,6 +234,7 @@ void World::RemoveAllTransformables()
     // This allows for the case where a transformable might remove another
     // when it destructs
 
+    // (Kept ones aren't in transformables, so are left alone)
     while (transformables.size())
         RemoveTransformable(transformables.GetAnyForRemoval());
 
@@ -216,15 +244,106 @@ void World::RemoveAllTransformables()
         AddTransformable(camera);
 }
 
+void World::SetKept(ITransformable *transformable, bool kept)
+{
+    if (kept == this->kept.Contains(transformable))
+        return;
+
+    if (kept)
+    {
+        if (!transformables.Contains(transformable))
+        {
+            WARN << "Specified transformable was not found.";
+            return;
+        }
+
+        ASSERT(!transformable->GetParent());
+        this->kept.Insert(transformable);
+    }
+    else
+        this->kept.SwapRemove(transformable);
+
+    SetAside(transformable, kept);
+}
+
+void World::SetAside(ITransformable *transformable, bool aside)
+{
+    // Our reference is kept, only the lists change.
+    if (aside)
+        transformables.SwapRemove(transformable);
+    else
+        transformables.Insert(transformable);
+
+    if (auto *graphic = dynamic_cast<IGraphic *>(transformable))
+    {
+        if (aside)
+        {
+            graphics.SwapRemove(graphic);
+            motionTracker.Remove(graphic);
+        }
+        else
+            graphics.Insert(graphic);
+    }
+
+    if (auto *character = dynamic_cast<ICharacter *>(transformable))
+    {
+        if (aside)
+            characters.SwapRemove(character);
+        else
+            characters.Insert(character);
+    }
+
+    if (auto *sensor = dynamic_cast<ISensor *>(transformable))
+    {
+        if (aside)
+            sensors.SwapRemove(sensor);
+        else
+            sensors.Insert(sensor);
+    }
+
+    if (auto *soundSource = dynamic_cast<ISoundSource *>(transformable))
+    {
+        if (aside)
+            soundSources.SwapRemove(soundSource);
+        else
+            soundSources.Insert(soundSource);
+
+        // OnResume won't see it while aside, so hand back the pause it has
+        // from us. (and give it one if put back while paused)
+        if (IsPaused())
+        {
+            if (aside)
+                soundSource->Resume();
+            else
+                soundSource->Pause();
+        }
+    }
+
+    for (auto &child : transformable->GetChildren())
+        SetAside(child, aside);
+}
+
+void World::OnTransformApplied(ITransformable *transformable)
+{
+    if (transformables.Contains(transformable))
+        motionTracker.Add(transformable);
+}
+
 IMesh *World::AddMesh(const c8 *meshName)
 {
-    IMesh *mesh =
-        new Mesh(engine->GetIrrlichtDevice()->getSceneManager(), meshName);
+    IMesh *mesh = new Mesh(engine->GetIrrlichtDevice()->getSceneManager(),
+                           meshBatcher, animationSystem, meshName);
     AddTransformable(mesh);
     mesh->drop();
     return mesh;
 }
 
+void World::SetAnimationDetail(f32 reducedRateDistance,
+                               u32 reducedRateInterval)
+{
+    animationSystem->SetReducedRate(reducedRateDistance, reducedRateInterval);
+}
+
 INodeHandler *World::AddIrrNodeHandler(scene::ISceneNode *irrNode,
                                        bool removeOnDestruct)
 {
@@ -446,6 +565,8 @@ void World::Update(f32 dt)
     if (IsPaused())
         return;
 
+    PROFILE_ZONE("World::Update");
+
     // Send input events to subscribers.
 
     if (inputProfile)
@@ -467,6 +588,8 @@ void World::Update(f32 dt)
         // Update)
         elem->CalculateVelocities(dt);
 
+        motionTracker.CheckBeforeUpdate(elem);
+
         elem->CacheInterpolatableState();
     }
 
@@ -550,4 +673,8 @@ void World::Update(f32 dt)
         RemoveTransformable(removalQueue.front());
         removalQueue.pop_front();
     }
+
+    // Find what moved, only those need interpolating by the render task.
+    for (auto &elem : transformables)
+        motionTracker.CheckAfterUpdate(elem);
 }
@@ -1,5 +1,6 @@
 
 #include "IWorld.h"
+#include "MotionTracker.h"
 #include <deque>
 
 class IEngine;
@@ -9,6 +10,8 @@ class LogicTask;
 class RenderTask;
 class IGraphic;
 class ISensor;
+class MeshBatcher;
+class AnimationSystem;
 
 class World : public IWorld
 {
@@ -23,17 +26,31 @@ class World : public IWorld
     ICamera *camera;
 
     // Transformables
-    Set<ITransformable *> transformables;
+    IndexedSet<ITransformable *> transformables;
     // All those in these sub lists are also present in the main transformables
     // list.
-    Set<IGraphic *> graphics;
-    Set<ICharacter *> characters;
-    Set<ISensor *> sensors;
-    Set<ISoundSource *> soundSources;
+    IndexedSet<IGraphic *> graphics;
+    IndexedSet<ICharacter *> characters;
+    IndexedSet<ISensor *> sensors;
+    IndexedSet<ISoundSource *> soundSources;
+
+    // See SetKept. Only the root of each, they and their children are not in
+    // any of the lists above while kept.
+    IndexedSet<ITransformable *> kept;
+    void SetAside(ITransformable *transformable, bool aside);
+
+    // Graphics that need interpolating
+    MotionTracker motionTracker;
 
     // Waiting for removal
     std::deque<ITransformable *> removalQueue;
 
+    // Draws instanced meshes
+    MeshBatcher *meshBatcher;
+
+    // Updates the joints of animated meshes
+    AnimationSystem *animationSystem;
+
     // Some world effects
     scene::ISceneNode *skyBoxNode;
     IShader *skyBoxShader;
@@ -47,7 +64,8 @@ public:
     ~World();
 
     // Used by render task.
-    const Set<IGraphic *> &GetAllGraphics() { return graphics; }
+    const IndexedSet<IGraphic *> &GetAllGraphics() { return graphics; }
+    MotionTracker &GetMotionTracker() { return motionTracker; }
 
     IPhysics *GetPhysics() override;
     ICamera *GetCamera() override;
@@ -65,8 +83,12 @@ public:
     void RemoveTransformable(ITransformable *transformable) override;
     void QueueForRemoval(ITransformable *transformable) override;
     void RemoveAllTransformables() override;
+    void SetKept(ITransformable *transformable, bool kept) override;
+    void OnTransformApplied(ITransformable *transformable) override;
 
     IMesh *AddMesh(const c8 *meshName) override;
+    void SetAnimationDetail(f32 reducedRateDistance,
+                            u32 reducedRateInterval) override;
 
     INodeHandler *AddIrrNodeHandler(scene::ISceneNode *irrNode,
                                     bool removeOnDestruct) override;
@@ -797,7 +797,7 @@ Variant &Variant::operator<<(const char *value)
 }
 
 // Mostly just useful for debugging.
-Variant::E_VARIANT_TYPE Variant::GetType()
+Variant::E_VARIANT_TYPE Variant::GetType() const
 {
     return variantType;
 }
@@ -2,6 +2,14 @@
 #include "utils/Variant.h" // hax
 #include "utils/log.h"
 #include <cstdarg>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
+#include <cstring>
 
 namespace utils
 {
@@ -13,88 +21,577 @@ namespace log
 io::path logFilePath = "Litha Init.log";
 io::path logFilePath2 = "";
 
+// Binary log for structured records, if any.
+io::path logBinPath = "";
+std::atomic<bool> structuredLogging(false);
+
+std::atomic<int> runtimeLevel(ELL_NOTE);
+
+// Binary log file header.
+const char BINARY_LOG_MAGIC[8] = {'L', 'I', 'T', 'H', 'A', 'L', 'O', 'G'};
+const u32 BINARY_LOG_VERSION = 1;
+
+// Set once the backend has been shut down at exit, after which anything
+// still being logged is written synchronously.
+std::atomic<bool> backendShutDown(false);
+
+// Asynchronous logging backend.
+// Log lines are pushed by any thread into a bounded lock-free ring buffer
+// (Vyukov's bounded queue, used here with multiple producers and a single
+// consumer). A background thread drains it in batches to stdout and the log
+// files, which are kept open rather than opened and closed per write.
+// Consuming is serialised by writerMutex, so flush() can also drain the queue
+// synchronously from the calling thread.
+class Backend
+{
+    struct Slot
+    {
+        std::atomic<u32> sequence;
+        std::string line;
+        // line is a binary record rather than text
+        bool binary;
+    };
+
+    static const u32 SLOT_COUNT = 4096; // must be a power of two
+
+    Slot slots[SLOT_COUNT];
+    std::atomic<u32> enqueuePos;
+    u32 dequeuePos;
+
+    // Owned by whoever holds writerMutex.
+    std::mutex writerMutex;
+    FILE *files[3];
+    io::path openPaths[3];
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<bool> running;
+    std::thread writer;
+
+    bool Pop(std::string &line, bool &binary)
+    {
+        Slot &slot = slots[dequeuePos & (SLOT_COUNT - 1)];
+
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+            return false;
+
+        line.swap(slot.line);
+        binary = slot.binary;
+        slot.sequence.store(dequeuePos + SLOT_COUNT, std::memory_order_release);
+        dequeuePos++;
+        return true;
+    }
+
+    FILE *GetFile(u32 i, const io::path &path)
+    {
+        if (path != openPaths[i])
+        {
+            if (files[i])
+                fclose(files[i]);
+
+            files[i] = path.size() ? fopen(path.c_str(), "ab") : nullptr;
+            openPaths[i] = path;
+
+            // Perhaps we oughtn't to silently fail... Bleh.
+        }
+
+        return files[i];
+    }
+
+    // Must hold writerMutex.
+    // Returns true if anything was written.
+    bool WriteBatch()
+    {
+        std::string line;
+        bool binary;
+        bool wrote = false;
+
+        FILE *fp = GetFile(0, logFilePath);
+        FILE *fp2 = GetFile(1, logFilePath2);
+        FILE *fpBin = GetFile(2, logBinPath);
+
+        while (Pop(line, binary))
+        {
+            wrote = true;
+
+            if (binary)
+            {
+                if (fpBin)
+                    fwrite(line.data(), 1, line.size(), fpBin);
+
+                continue;
+            }
+
+            fputs(line.c_str(), stdout);
+
+            if (fp)
+                fputs(line.c_str(), fp);
+
+            if (fp2)
+                fputs(line.c_str(), fp2);
+        }
+
+        if (wrote)
+        {
+            fflush(stdout);
+
+            if (fp)
+                fflush(fp);
+
+            if (fp2)
+                fflush(fp2);
+
+            if (fpBin)
+                fflush(fpBin);
+        }
+
+        return wrote;
+    }
+
+    void WriterLoop()
+    {
+        while (running.load())
+        {
+            bool wrote;
+
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                wrote = WriteBatch();
+            }
+
+            if (!wrote)
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wake.wait_for(lock, std::chrono::milliseconds(50));
+            }
+        }
+    }
+
+public:
+    Backend()
+    {
+        for (u32 i = 0; i < SLOT_COUNT; i++)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+
+        enqueuePos.store(0);
+        dequeuePos = 0;
+
+        files[0] = files[1] = files[2] = nullptr;
+
+        running.store(true);
+        writer = std::thread(&Backend::WriterLoop, this);
+    }
+
+    ~Backend()
+    {
+        running.store(false);
+        wake.notify_one();
+        writer.join();
+
+        Flush();
+
+        std::lock_guard<std::mutex> lock(writerMutex);
+
+        for (auto &elem : files)
+        {
+            if (elem)
+                fclose(elem);
+        }
+    }
+
+    void Push(std::string &&line, bool binary)
+    {
+        u32 pos = enqueuePos.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            Slot &slot = slots[pos & (SLOT_COUNT - 1)];
+            u32 sequence = slot.sequence.load(std::memory_order_acquire);
+            s32 diff = (s32)(sequence - pos);
+
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                                     std::memory_order_relaxed))
+                {
+                    slot.line = std::move(line);
+                    slot.binary = binary;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                // Full. Wait for the writer rather than losing the line.
+                wake.notify_one();
+                std::this_thread::yield();
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+            else
+                pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+
+        wake.notify_one();
+    }
+
+    // Write everything queued so far before returning.
+    void Flush()
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        WriteBatch();
+    }
+
+    // Drains the queue and closes the log files, then calls func while
+    // nothing else can be writing. Used to replace or read back the files.
+    void Sync(const std::function<void()> &func)
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        WriteBatch();
+
+        for (u32 i = 0; i < 3; i++)
+        {
+            if (files[i])
+                fclose(files[i]);
+
+            files[i] = nullptr;
+            openPaths[i] = "";
+        }
+
+        func();
+    }
+};
+
+Backend &get_backend()
+{
+    static Backend backend;
+    return backend;
+}
+
+// Flushes the backend at exit, after which we fall back to synchronous writes.
+struct BackendShutdown
+{
+    BackendShutdown() { get_backend(); }
+    ~BackendShutdown()
+    {
+        get_backend().Sync([]() { backendShutDown.store(true); });
+    }
+} shutdownAtExit;
+
+// Write directly, as was done before the asynchronous backend.
+void out_sync(const core::stringc &str)
+{
+    printf("%s", str.c_str());
+
+    const io::path *paths[] = {&logFilePath, &logFilePath2};
+
+    for (auto &elem : paths)
+    {
+        if (elem->size())
+        {
+            if (FILE *fp = fopen(elem->c_str(), "ab"))
+            {
+                fputs(str.c_str(), fp);
+                fflush(fp);
+                fclose(fp);
+            }
+        }
+    }
+}
+
+// Output to stdout and to the log file if one is set.
+void out(const core::stringc &str)
+{
+    if (backendShutDown.load())
+        out_sync(str);
+    else
+        get_backend().Push(std::string(str.c_str(), str.size()), false);
+}
+
+// Output a binary record to the binary log.
+void out_record(std::string &&record)
+{
+    if (!backendShutDown.load())
+    {
+        get_backend().Push(std::move(record), true);
+    }
+    else if (logBinPath.size())
+    {
+        if (FILE *fp = fopen(logBinPath.c_str(), "ab"))
+        {
+            fwrite(record.data(), 1, record.size(), fp);
+            fclose(fp);
+        }
+    }
+}
+
+void flush()
+{
+    if (!backendShutDown.load())
+        get_backend().Flush();
+}
+
+// Runs func with the backend drained and its files closed.
+void sync(const std::function<void()> &func)
+{
+    if (backendShutDown.load())
+        func();
+    else
+        get_backend().Sync(func);
+}
+
 void setfile(const io::path &logFile)
 {
-    logFilePath = logFile;
+    sync([&]() {
+        logFilePath = logFile;
 
-    // Attempt to clear current contents.
-    if (logFilePath.size())
-        os::path::ensure_delete(logFilePath);
+        // Attempt to clear current contents.
+        if (logFilePath.size())
+            os::path::ensure_delete(logFilePath);
+    });
 }
 
 void setfile2(const io::path &logFile)
 {
-    logFilePath2 = logFile;
+    sync([&]() {
+        logFilePath2 = logFile;
 
-    // Attempt to clear current contents.
-    if (logFilePath2.size())
-        os::path::ensure_delete(logFilePath2);
+        // Attempt to clear current contents.
+        if (logFilePath2.size())
+            os::path::ensure_delete(logFilePath2);
+    });
 }
 
 void backup(const io::path &ext)
 {
-    if (logFilePath.size())
-        utils::file::put(logFilePath + ext, utils::file::get(logFilePath));
+    sync([&]() {
+        if (logFilePath.size())
+            utils::file::put(logFilePath + ext,
+                             utils::file::get(logFilePath));
 
-    if (logFilePath2.size())
-        utils::file::put(logFilePath2 + ext, utils::file::get(logFilePath2));
+        if (logFilePath2.size())
+            utils::file::put(logFilePath2 + ext,
+                             utils::file::get(logFilePath2));
+    });
 }
 
-// Output to stdout and to the log file if one is set.
-void out(const core::stringc &str)
+void setlevel(E_LOG_LEVEL level)
 {
-    // Print to stdout
-    printf("%s", str.c_str());
+    runtimeLevel.store(level);
+}
 
-    // Write to log file, flush, then close.
-    if (logFilePath.size())
-    {
-        FILE *fp = fopen(logFilePath.c_str(), "ab");
+E_LOG_LEVEL getlevel()
+{
+    return (E_LOG_LEVEL)runtimeLevel.load(std::memory_order_relaxed);
+}
+
+void setbinaryfile(const io::path &binFile)
+{
+    sync([&]() {
+        logBinPath = binFile;
 
-        if (fp)
+        if (logBinPath.size())
         {
-            fputs(str.c_str(), fp);
-            fflush(fp);
-            fclose(fp);
+            // Start afresh with just the header.
+            if (FILE *fp = fopen(logBinPath.c_str(), "wb"))
+            {
+                fwrite(BINARY_LOG_MAGIC, 1, sizeof(BINARY_LOG_MAGIC), fp);
+                fwrite(&BINARY_LOG_VERSION, sizeof(BINARY_LOG_VERSION), 1, fp);
+                fclose(fp);
+            }
         }
 
-        // Perhaps we oughtn't to silently fail... Bleh.
+        structuredLogging.store(logBinPath.size() != 0);
+    });
+}
+
+// ************* Binary records *************
+// All values are in native byte order.
+// A record is:
+//  u32 size of the rest of the record
+//  u8 log level, string file name, u32 line, string function name
+//  then each inserted value as a field until the end of the record:
+//  u8 Variant::E_VARIANT_TYPE then the value.
+// Strings are a u32 length then the characters. Vectors are a u32 count then
+// that many fields.
+
+template <class Type>
+void put(std::string &buf, const Type &value)
+{
+    buf.append((const char *)&value, sizeof(Type));
+}
+
+void put_string(std::string &buf, const core::stringc &str)
+{
+    put<u32>(buf, str.size());
+    buf.append(str.c_str(), str.size());
+}
+
+void put_field(std::string &buf, const Variant &value)
+{
+    put<u8>(buf, value.GetType());
+
+    switch (value.GetType())
+    {
+    case Variant::EVT_BOOL:
+        put<u8>(buf, value.To<bool>());
+        break;
+    case Variant::EVT_U32:
+        put<u32>(buf, value.To<u32>());
+        break;
+    case Variant::EVT_S32:
+        put<s32>(buf, value.To<s32>());
+        break;
+    case Variant::EVT_F32:
+        put<f32>(buf, value.To<f32>());
+        break;
+    case Variant::EVT_F64:
+        put<f64>(buf, value.To<f64>());
+        break;
+    case Variant::EVT_STRING:
+        put_string(buf, value.To<core::stringc>());
+        break;
+    case Variant::EVT_VECTOR:
+    {
+        std::vector<Variant> elements = value.To<std::vector<Variant>>();
+        put<u32>(buf, elements.size());
+
+        for (auto &elem : elements)
+            put_field(buf, elem);
+        break;
+    }
+    }
+}
+
+// Reads values back out of a binary log.
+struct RecordReader
+{
+    const std::string &data;
+    size_t pos;
+    size_t end;
+
+    RecordReader(const std::string &data, size_t pos, size_t end)
+        : data(data)
+        , pos(pos)
+        , end(end)
+    {
+    }
+
+    template <class Type>
+    bool get(Type &value)
+    {
+        if (end - pos < sizeof(Type))
+            return false;
+
+        memcpy(&value, data.data() + pos, sizeof(Type));
+        pos += sizeof(Type);
+        return true;
+    }
+
+    bool get_string(core::stringc &str)
+    {
+        u32 len;
+
+        if (!get(len) || end - pos < len)
+            return false;
+
+        str = std::string(data, pos, len).c_str();
+        pos += len;
+        return true;
     }
 
-    // Extra log location.
-    if (logFilePath2.size())
+    // Decodes a field to the text it would have been logged as.
+    bool get_field(core::stringc &text)
     {
-        FILE *fp = fopen(logFilePath2.c_str(), "ab");
+        u8 type;
+
+        if (!get(type))
+            return false;
 
-        if (fp)
+        switch (type)
         {
-            fputs(str.c_str(), fp);
-            fflush(fp);
-            fclose(fp);
+        case Variant::EVT_BOOL:
+        {
+            u8 value;
+            if (!get(value))
+                return false;
+            text += Variant((bool)value).To<core::stringc>();
+            return true;
+        }
+        case Variant::EVT_U32:
+        {
+            u32 value;
+            if (!get(value))
+                return false;
+            text += Variant(value).To<core::stringc>();
+            return true;
+        }
+        case Variant::EVT_S32:
+        {
+            s32 value;
+            if (!get(value))
+                return false;
+            text += Variant(value).To<core::stringc>();
+            return true;
+        }
+        case Variant::EVT_F32:
+        {
+            f32 value;
+            if (!get(value))
+                return false;
+            text += Variant(value).To<core::stringc>();
+            return true;
         }
+        case Variant::EVT_F64:
+        {
+            f64 value;
+            if (!get(value))
+                return false;
+            text += Variant(value).To<core::stringc>();
+            return true;
+        }
+        case Variant::EVT_STRING:
+        {
+            core::stringc value;
+            if (!get_string(value))
+                return false;
+            text += value;
+            return true;
+        }
+        case Variant::EVT_VECTOR:
+        {
+            u32 count;
+            if (!get(count))
+                return false;
 
-        // Perhaps we oughtn't to silently fail... Bleh.
-    }
-}
+            text += "[";
 
-Logger::Logger(E_LOG_LEVEL logLevel, const core::stringc &fileName, u32 line,
-               const core::stringc &funcName)
-{
-    this->logLevel = logLevel;
+            for (u32 i = 0; i < count; i++)
+            {
+                if (i)
+                    text += ", ";
 
-    // No variants inserted yet.
-    inserted = false;
+                if (!get_field(text))
+                    return false;
+            }
 
-    // Build the string to output to the log.
+            text += "]";
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+};
 
+// The start of a text log line.
+core::stringc format_prefix(E_LOG_LEVEL logLevel, const core::stringc &fileName,
+                            u32 line, const core::stringc &funcName)
+{
     core::stringc outStr;
 
     switch (logLevel)
     {
     case ELL_NOTE:
-        // Don't want the colon: as will not have line numbers etc with
-        // ELL_NOTE.
-        inserted = true;
         break;
     case ELL_WARN:
         outStr += "*** WARNING at ";
@@ -117,28 +614,146 @@ Logger::Logger(E_LOG_LEVEL logLevel, const core::stringc &fileName, u32 line,
         outStr += funcName;
     }
 
-    // Send to console and log file.
-    out(outStr);
+    return outStr;
+}
+
+bool decode(const io::path &binFile, core::stringc &text)
+{
+    std::string data;
+
+    if (FILE *fp = fopen(binFile.c_str(), "rb"))
+    {
+        char buf[4096];
+        size_t read;
+
+        while ((read = fread(buf, 1, sizeof(buf), fp)) > 0)
+            data.append(buf, read);
+
+        fclose(fp);
+    }
+    else
+        return false;
+
+    RecordReader header(data, 0, data.size());
+    char magic[sizeof(BINARY_LOG_MAGIC)];
+    u32 version;
+
+    if (!header.get(magic) ||
+        memcmp(magic, BINARY_LOG_MAGIC, sizeof(BINARY_LOG_MAGIC)) ||
+        !header.get(version) || version != BINARY_LOG_VERSION)
+        return false;
+
+    size_t pos = header.pos;
+
+    while (pos < data.size())
+    {
+        RecordReader sizeReader(data, pos, data.size());
+        u32 size;
+
+        if (!sizeReader.get(size) || data.size() - sizeReader.pos < size)
+            break;
+
+        RecordReader reader(data, sizeReader.pos, sizeReader.pos + size);
+        pos = reader.end;
+
+        u8 level;
+        core::stringc fileName, funcName;
+        u32 line;
+
+        if (!reader.get(level) || level > ELL_ASSERT ||
+            !reader.get_string(fileName) || !reader.get(line) ||
+            !reader.get_string(funcName))
+            break;
+
+        text += format_prefix((E_LOG_LEVEL)level, fileName, line, funcName);
+
+        bool first = true;
+
+        while (reader.pos < reader.end)
+        {
+            if (first && level != ELL_NOTE)
+                text += ": ";
+
+            first = false;
+
+            if (!reader.get_field(text))
+                break;
+        }
+
+        text += os::newline();
+    }
+
+    return true;
+}
+
+Logger::Logger(E_LOG_LEVEL logLevel, const core::stringc &fileName, u32 line,
+               const core::stringc &funcName)
+{
+    this->logLevel = logLevel;
+
+    // No variants inserted yet.
+    // Don't want the colon: for ELL_NOTE as will not have line numbers etc.
+    inserted = logLevel == ELL_NOTE;
+
+    structured = structuredLogging.load(std::memory_order_relaxed);
+
+    if (structured)
+    {
+        // Leave room for the size.
+        put<u32>(record, 0);
+        put<u8>(record, logLevel);
+        put_string(record, fileName);
+        put<u32>(record, line);
+        put_string(record, funcName);
+    }
+
+    // FAIL and ASSERT always go to the text log too.
+    if (!structured || logLevel >= ELL_FAIL)
+        outStr = format_prefix(logLevel, fileName, line, funcName);
 }
 
 Logger::~Logger()
 {
-    out(os::newline());
+    if (structured)
+    {
+        u32 size = record.size() - sizeof(u32);
+        memcpy(&record[0], &size, sizeof(u32));
+        out_record(std::move(record));
+    }
+
+    // The whole line is sent to the console and log files at once.
+    if (!structured || logLevel >= ELL_FAIL)
+    {
+        outStr += os::newline();
+        out(outStr);
+    }
 
     // Maybe abort the app completely?
     if (logLevel == ELL_FAIL || logLevel == ELL_ASSERT)
+    {
+        // Make sure the reason actually reaches the log.
+        flush();
         abort();
+    }
 }
 
 Logger &Logger::operator<<(const Variant &output)
 {
+    if (structured)
+    {
+        put_field(record, output);
+
+        if (logLevel < ELL_FAIL)
+            return *this;
+    }
+
     if (!inserted)
     {
-        out(": ");
+        outStr += ": ";
         inserted = true;
     }
 
-    out(output.To<core::stringc>());
+    outStr += output.To<core::stringc>();
     return *this;
 }
 
@@ -0,0 +1,283 @@
+
+#include "utils/profile.h"
+
+#if LITHA_PROFILER
+
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+namespace utils
+{
+namespace profile
+{
+struct ZoneRecord
+{
+    const char *name;
+    unsigned long long startTime;
+    unsigned long long endTime;
+};
+
+// Zones recorded by one thread.
+// Only the owning thread writes to it, the mutex is just held briefly for
+// each record so frame() and save_trace() can read from any thread.
+struct ThreadBuffer
+{
+    static const u32 CAPACITY = 1 << 16;
+
+    std::mutex mutex;
+    std::vector<ZoneRecord> ring;
+    // Total records ever written, the ring holds the last CAPACITY of them.
+    unsigned long long written;
+    // Records before this have been summed into a frame.
+    unsigned long long summed;
+    u32 threadId;
+    core::stringc threadName;
+
+    ThreadBuffer(u32 threadId)
+    {
+        ring.resize(CAPACITY);
+        written = 0;
+        summed = 0;
+        this->threadId = threadId;
+        threadName = "Thread ";
+        threadName += threadId;
+    }
+
+    void Add(const ZoneRecord &record)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ring[written % CAPACITY] = record;
+        written++;
+    }
+
+    // First record still held in the ring.
+    unsigned long long Oldest(unsigned long long from) const
+    {
+        return max(from, written > CAPACITY ? written - CAPACITY : 0ull);
+    }
+};
+
+// Buffers are never freed, so zones from finished threads can still be saved.
+std::mutex buffersMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+thread_local ThreadBuffer *threadBuffer = nullptr;
+
+std::chrono::steady_clock::time_point startTime =
+    std::chrono::steady_clock::now();
+
+// Last complete frame
+unsigned long long frameStartTime = 0;
+f32 lastFrameMs = 0.f;
+std::vector<ZoneTotal> lastFrameZones;
+
+unsigned long long now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - startTime)
+        .count();
+}
+
+ThreadBuffer *get_thread_buffer()
+{
+    if (!threadBuffer)
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffers.emplace_back(new ThreadBuffer(buffers.size()));
+        threadBuffer = buffers.back().get();
+    }
+
+    return threadBuffer;
+}
+
+ScopedZone::ScopedZone(const char *name)
+{
+    this->name = name;
+    startTime = now();
+}
+
+ScopedZone::~ScopedZone()
+{
+    ZoneRecord record = {name, startTime, now()};
+    get_thread_buffer()->Add(record);
+}
+
+void set_thread_name(const char *name)
+{
+    ThreadBuffer *buffer = get_thread_buffer();
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    buffer->threadName = name;
+}
+
+void frame()
+{
+    unsigned long long frameEndTime = now();
+
+    std::vector<ZoneTotal> zones;
+
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+
+        for (auto &buffer : buffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+
+            for (unsigned long long i = buffer->Oldest(buffer->summed);
+                 i < buffer->written; i++)
+            {
+                const ZoneRecord &record =
+                    buffer->ring[i % ThreadBuffer::CAPACITY];
+
+                f32 ms = (record.endTime - record.startTime) / 1000000.0;
+
+                auto it = std::find_if(zones.begin(), zones.end(),
+                                       [&](const ZoneTotal &total) {
+                                           return !strcmp(total.name,
+                                                          record.name);
+                                       });
+
+                if (it != zones.end())
+                {
+                    it->ms += ms;
+                    it->calls++;
+                }
+                else
+                {
+                    ZoneTotal total = {record.name, ms, 1};
+                    zones.push_back(total);
+                }
+            }
+
+            buffer->summed = buffer->written;
+        }
+    }
+
+    std::sort(zones.begin(), zones.end(),
+              [](const ZoneTotal &a, const ZoneTotal &b) { return a.ms > b.ms; });
+
+    lastFrameMs = (frameEndTime - frameStartTime) / 1000000.0;
+    lastFrameZones = zones;
+
+    // The frame itself is recorded as a zone, so it shows up in traces.
+    if (frameStartTime)
+    {
+        ZoneRecord record = {"Frame", frameStartTime, frameEndTime};
+        get_thread_buffer()->Add(record);
+
+        // Don't count it in the next frame's totals.
+        get_thread_buffer()->summed++;
+    }
+
+    frameStartTime = frameEndTime;
+}
+
+f32 get_last_frame_ms()
+{
+    return lastFrameMs;
+}
+
+const std::vector<ZoneTotal> &get_last_frame_zones()
+{
+    return lastFrameZones;
+}
+
+core::stringc get_last_frame_summary()
+{
+    core::stringc summary = "Frame: ";
+    summary += str::to(lastFrameMs);
+    summary += "ms";
+
+    for (auto &elem : lastFrameZones)
+    {
+        summary += "\n";
+        summary += elem.name;
+        summary += ": ";
+        summary += str::to(elem.ms);
+        summary += "ms";
+
+        if (elem.calls > 1)
+        {
+            summary += " (x";
+            summary += elem.calls;
+            summary += ")";
+        }
+    }
+
+    return summary;
+}
+
+// Zone names are normally literals, but escape anything JSON won't accept.
+void write_json_string(FILE *fp, const char *str)
+{
+    fputc('"', fp);
+
+    for (; *str; str++)
+    {
+        if (*str == '"' || *str == '\\')
+            fputc('\\', fp);
+
+        if ((unsigned char)*str >= 0x20)
+            fputc(*str, fp);
+    }
+
+    fputc('"', fp);
+}
+
+bool save_trace(const io::path &traceFile)
+{
+    FILE *fp = fopen(traceFile.c_str(), "wb");
+
+    if (!fp)
+    {
+        WARN << "Could not write profiler trace to " << traceFile;
+        return false;
+    }
+
+    fputs("{\"traceEvents\":[", fp);
+
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(buffersMutex);
+
+    for (auto &buffer : buffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+
+        fprintf(fp,
+                "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                "\"tid\":%u,\"args\":{\"name\":",
+                first ? "" : ",", buffer->threadId);
+        write_json_string(fp, buffer->threadName.c_str());
+        fputs("}}", fp);
+        first = false;
+
+        for (unsigned long long i = buffer->Oldest(0); i < buffer->written;
+             i++)
+        {
+            const ZoneRecord &record = buffer->ring[i % ThreadBuffer::CAPACITY];
+
+            // Complete events, times in microseconds.
+            fputs(",\n{\"name\":", fp);
+            write_json_string(fp, record.name);
+            fprintf(fp,
+                    ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,"
+                    "\"dur\":%.3f}",
+                    buffer->threadId, record.startTime / 1000.0,
+                    (record.endTime - record.startTime) / 1000.0);
+        }
+    }
+
+    fputs("\n]}\n", fp);
+    fclose(fp);
+
+    NOTE << "Saved profiler trace to " << traceFile;
+    return true;
+}
+
+} // namespace profile
+} // namespace utils
+
+#endif